@@ -0,0 +1,671 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : bench.cpp
+ * PURPOSE     : Raytracing project.
+ *               Micro-benchmarks implementation module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#include <vector>
+
+#ifdef __linux__
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif /* __linux__ */
+
+#include "bench.h"
+#include "../rt/rt.h"
+#include "../rt/frame/order.h"
+
+/* Hardware cache misses counters.
+ * Available on Linux only (perf events), elsewhere counters stay invalid.
+ * Generic perf events expose first level data and last level caches. */
+class cache_counters
+{
+private:
+  INT Fd[2] = {-1, -1}; // L1 data and last level read misses events
+
+public:
+  /* Counters constructor */
+  cache_counters( VOID )
+  {
+#ifdef __linux__
+    static const UINT64 Configs[2] =
+    {
+      PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+      PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+    };
+
+    for (INT i = 0; i < 2; i++)
+    {
+      perf_event_attr A = {};
+
+      A.type = PERF_TYPE_HW_CACHE;
+      A.size = sizeof(A);
+      A.config = Configs[i];
+      A.disabled = 1;
+      A.exclude_kernel = 1;
+      A.exclude_hv = 1;
+      Fd[i] = (INT)syscall(__NR_perf_event_open, &A, 0, -1, -1, 0);
+    }
+#endif /* __linux__ */
+  } /* End of 'cache_counters' function */
+
+  /* Counters destructor */
+  ~cache_counters( VOID )
+  {
+#ifdef __linux__
+    for (INT fd : Fd)
+      if (fd >= 0)
+        close(fd);
+#endif /* __linux__ */
+  } /* End of '~cache_counters' function */
+
+  /* Check if counters are available function.
+   * ARGUMENTS: None.
+   * RETURNS: (BOOL) TRUE if both counters are opened.
+   */
+  BOOL IsValid( VOID ) const
+  {
+    return Fd[0] >= 0 && Fd[1] >= 0;
+  } /* End of 'IsValid' function */
+
+  /* Measure kernel cache misses function.
+   * ARGUMENTS:
+   *   - kernel:
+   *       Func Kernel;
+   *   - L1 data and last level read misses to be stored:
+   *       UINT64 *L1, *LL;
+   * RETURNS: None.
+   */
+  template<class Func>
+    VOID Measure( Func Kernel, UINT64 *L1, UINT64 *LL )
+    {
+      *L1 = *LL = 0;
+      if (!IsValid())
+      {
+        Kernel();
+        return;
+      }
+#ifdef __linux__
+      for (INT fd : Fd)
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0), ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      Kernel();
+      for (INT fd : Fd)
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(Fd[0], L1, sizeof(UINT64)) != sizeof(UINT64) || read(Fd[1], LL, sizeof(UINT64)) != sizeof(UINT64))
+        *L1 = *LL = 0;
+#endif /* __linux__ */
+    } /* End of 'Measure' function */
+}; /* End of 'cache_counters' class */
+
+/* Kernels over arrays of four lanes vectors, instantiated by kernels set */
+template<class Lanes, class Type>
+  struct lanes_kernels
+  {
+    /* Scale and add: R = A * s + B */
+    static DBL Axpy( const Type *A, const Type *B, Type *R, INT N )
+    {
+      for (INT i = 0; i < N; i++)
+      {
+        Lanes::MulN(A + 4 * i, (Type)0.5, R + 4 * i);
+        Lanes::Add(R + 4 * i, B + 4 * i, R + 4 * i);
+      }
+      return R[0];
+    } /* End of 'Axpy' function */
+
+    /* Dot products sum */
+    static DBL Dot( const Type *A, const Type *B, Type *R, INT N )
+    {
+      Type s = 0;
+
+      for (INT i = 0; i < N; i++)
+        s += Lanes::Dot3(A + 4 * i, B + 4 * i);
+      return s;
+    } /* End of 'Dot' function */
+
+    /* Cross products */
+    static DBL Cross( const Type *A, const Type *B, Type *R, INT N )
+    {
+      for (INT i = 0; i < N; i++)
+        Lanes::Cross(A + 4 * i, B + 4 * i, R + 4 * i);
+      return R[0];
+    } /* End of 'Cross' function */
+
+    /* Normalization */
+    static DBL Normalize( const Type *A, const Type *B, Type *R, INT N )
+    {
+      for (INT i = 0; i < N; i++)
+        Lanes::MulN(A + 4 * i, 1 / sqrt(Lanes::Dot3(A + 4 * i, A + 4 * i)), R + 4 * i);
+      return R[0];
+    } /* End of 'Normalize' function */
+  }; /* End of 'lanes_kernels' structure */
+
+/* Write one comparison line function.
+ * ARGUMENTS:
+ *   - kernel name:
+ *       const CHAR *Name;
+ *   - number of operations per run:
+ *       INT Ops;
+ *   - reference and tested run times in nanoseconds:
+ *       DBL Ref, Test;
+ * RETURNS: None.
+ */
+VOID ivrt::bench::Report( const CHAR *Name, INT Ops, DBL Ref, DBL Test )
+{
+  fprintf(Log, "%-24s %10.3f %10.3f %6.2fx\n", Name, Ref / Ops, Test / Ops, Ref / Test);
+} /* End of 'ivrt::bench::Report' function */
+
+/* Compare scalar and SIMD vec3 kernels function.
+ * ARGUMENTS: None.
+ * RETURNS: None.
+ */
+VOID ivrt::bench::Vectors( VOID )
+{
+  const INT N = 4096;
+  std::vector<DBL> ad(4 * N), bd(4 * N), rd(4 * N);
+  std::vector<FLT> af(4 * N), bf(4 * N), rf(4 * N);
+  std::vector<FLT> sx(N), sy(N), sz(N);
+  std::vector<mth::vec3<FLT>> av(N);
+
+  for (INT i = 0; i < N; i++)
+    for (INT j = 0; j < 4; j++)
+    {
+      ad[4 * i + j] = af[4 * i + j] = j == 3 ? 0 : 1 + mth::Rnd1F();
+      bd[4 * i + j] = bf[4 * i + j] = j == 3 ? 0 : mth::Rnd0F();
+    }
+  for (INT i = 0; i < N; i++)
+  {
+    av[i] = mth::vec3<FLT>(af[4 * i], af[4 * i + 1], af[4 * i + 2]);
+    sx[i] = af[4 * i], sy[i] = af[4 * i + 1], sz[i] = af[4 * i + 2];
+  }
+
+  fprintf(Log, "# vec3 kernels, ns per vector: scalar template vs SSE/AVX lanes\n");
+#define BENCH_LANES(Name, Kernel, Type, a, b, r)                                                            \
+  Report(Name, N,                                                                                           \
+    Measure([&]() { return lanes_kernels<mth::lanes4_scalar<Type>, Type>::Kernel(a.data(), b.data(), r.data(), N); }), \
+    Measure([&]() { return lanes_kernels<mth::lanes4<Type>, Type>::Kernel(a.data(), b.data(), r.data(), N); }))
+
+  BENCH_LANES("vec3<double> axpy", Axpy, DBL, ad, bd, rd);
+  BENCH_LANES("vec3<double> dot", Dot, DBL, ad, bd, rd);
+  BENCH_LANES("vec3<double> cross", Cross, DBL, ad, bd, rd);
+  BENCH_LANES("vec3<double> normalize", Normalize, DBL, ad, bd, rd);
+  BENCH_LANES("vec3<float> axpy", Axpy, FLT, af, bf, rf);
+  BENCH_LANES("vec3<float> dot", Dot, FLT, af, bf, rf);
+  BENCH_LANES("vec3<float> cross", Cross, FLT, af, bf, rf);
+  BENCH_LANES("vec3<float> normalize", Normalize, FLT, af, bf, rf);
+#undef BENCH_LANES
+
+  fprintf(Log, "# normalize and dot with light, ns per vector: vec3<float> array vs vec3x8 batches\n");
+  mth::vec3<FLT> L = mth::vec3<FLT>(1, 2, 3).Normalizing();
+  mth::vec3x8 L8(L);
+
+  Report("vec3x8 normalize dot", N,
+    Measure([&]()
+    {
+      FLT s = 0;
+
+      for (INT i = 0; i < N; i++)
+        s += av[i].Normalizing() & L;
+      return s;
+    }),
+    Measure([&]()
+    {
+      FLT s = 0, d[8];
+
+      for (INT i = 0; i < N; i += 8)
+      {
+        mth::vec3x8 V(mth::flt8::Load(&sx[i]), mth::flt8::Load(&sy[i]), mth::flt8::Load(&sz[i]));
+
+        (V.Normalizing() & L8).Store(d);
+        for (INT j = 0; j < 8; j++)
+          s += d[j];
+      }
+      return s;
+    }));
+} /* End of 'ivrt::bench::Vectors' function */
+
+/* Compare single and eight triangles packet intersection function.
+ * ARGUMENTS: None.
+ * RETURNS: None.
+ */
+VOID ivrt::bench::Triangles( VOID )
+{
+  const INT N = 1024, NR = 64;
+  std::vector<triangle> tris;
+  std::vector<const triangle *> ptrs;
+  std::vector<triangle8> packs;
+  std::vector<tri_ray> rays;
+
+  /* Small triangles soup in front of rays origin */
+  for (INT i = 0; i < N; i++)
+  {
+    vec3 c(mth::Rnd0F() * 4, mth::Rnd0F() * 4, 5 + mth::Rnd1F() * 5);
+
+    tris.push_back(triangle(c, c + vec3(mth::Rnd1F(), 0, 0), c + vec3(0, mth::Rnd1F(), 0)));
+  }
+  for (INT i = 0; i < N; i++)
+    ptrs.push_back(&tris[i]);
+  for (INT i = 0; i < N; i += 8)
+    packs.push_back(triangle8(&ptrs[i], 8));
+  for (INT i = 0; i < NR; i++)
+    rays.push_back(tri_ray(ray(vec3(0), vec3(mth::Rnd0F() * 0.4, mth::Rnd0F() * 0.4, 1))));
+
+  fprintf(Log, "# closest of %d triangles, ns per ray-triangle test: single vs triangle8 packets\n", N);
+  Report("triangle8 closest hit", N * NR,
+    Measure([&]()
+    {
+      DBL s = 0;
+
+      for (auto &r : rays)
+      {
+        DBL best = HUGE_VAL, t, u, v;
+
+        for (auto &tr : tris)
+          if (r.Intersect(tr.P0, tr.P1, tr.P2, best, &t, &u, &v))
+            best = t;
+        s += best < HUGE_VAL ? best : 0;
+      }
+      return s;
+    }),
+    Measure([&]()
+    {
+      DBL s = 0;
+
+      for (auto &r : rays)
+      {
+        DBL best = HUGE_VAL, t, u, v;
+
+        for (auto &p : packs)
+          if (p.Intersect(r, best, &t, &u, &v) != -1)
+            best = t;
+        s += best < HUGE_VAL ? best : 0;
+      }
+      return s;
+    }));
+} /* End of 'ivrt::bench::Triangles' function */
+
+/* Compare scalar and eight boxes slab tests function.
+ * ARGUMENTS: None.
+ * RETURNS: None.
+ */
+VOID ivrt::bench::Boxes( VOID )
+{
+  const INT N = 512, NR = 64;
+  std::vector<aabb> boxes;
+  std::vector<mth::aabb8> packs;
+  std::vector<inv_ray> rays;
+
+  for (INT i = 0; i < 8 * N; i++)
+  {
+    vec3 c(mth::Rnd0F() * 4, mth::Rnd0F() * 4, 5 + mth::Rnd1F() * 5);
+
+    boxes.push_back(aabb(c, c + vec3(mth::Rnd1F(), mth::Rnd1F(), mth::Rnd1F())));
+  }
+  for (INT i = 0; i < 8 * N; i += 8)
+    packs.push_back(mth::aabb8(&boxes[i], 8));
+  for (INT i = 0; i < NR; i++)
+    rays.push_back(inv_ray(ray(vec3(0), vec3(mth::Rnd0F() * 0.4, mth::Rnd0F() * 0.4, 1))));
+
+  fprintf(Log, "# slab tests, ns per ray-box test: scalar aabb vs aabb8 children\n");
+  Report("aabb8 slab test", 8 * N * NR,
+    Measure([&]()
+    {
+      INT s = 0;
+
+      for (auto &r : rays)
+        for (auto &b : boxes)
+          s += b.Intersect(r, HUGE_VAL);
+      return s;
+    }),
+    Measure([&]()
+    {
+      INT s = 0;
+
+      for (auto &r : rays)
+      {
+        mth::inv_ray8 r8(r);
+
+        for (auto &p : packs)
+          s += mth::PopCount(p.Intersect(r8, HUGE_VAL));
+      }
+      return s;
+    }));
+} /* End of 'ivrt::bench::Boxes' function */
+
+/* Compare per pixel and per frame camera rays generation function.
+ * ARGUMENTS: None.
+ * RETURNS: None.
+ */
+VOID ivrt::bench::CameraRays( VOID )
+{
+  const INT W = 256, H = 256;
+  camera Cam;
+  std::vector<ray> Rays(W);
+
+  Cam.SetLocAtUp(vec3(3, 4, 5), vec3(0)).Resize(W, H);
+  ray_gen Gen(Cam);
+
+  fprintf(Log, "# %dx%d camera rays, ns per ray: camera::FrameRay vs ray_gen\n", W, H);
+  auto PerPixel =
+    [&]()
+    {
+      DBL s = 0;
+
+      for (INT y = 0; y < H; y++)
+        for (INT x = 0; x < W; x++)
+          s += Cam.FrameRay(x + 0.5, y + 0.5).Dir[0];
+      return s;
+    };
+  Report("ray_gen row", W * H, Measure(PerPixel),
+    Measure([&]()
+    {
+      DBL s = 0;
+
+      for (INT y = 0; y < H; y++)
+      {
+        Gen.Row(y, 0, W, Rays.data());
+        for (auto &r : Rays)
+          s += r.Dir[0];
+      }
+      return s;
+    }));
+  Report("ray_gen row8", W * H, Measure(PerPixel),
+    Measure([&]()
+    {
+      DBL s = 0;
+      mth::vec3x8 Org, Dir;
+
+      for (INT y = 0; y < H; y++)
+        for (INT x = 0; x < W; x += 8)
+        {
+          Gen.Row8(x, y, &Org, &Dir);
+          s += Dir.X[0];
+        }
+      return s;
+    }));
+} /* End of 'ivrt::bench::CameraRays' function */
+
+/* Compare primary rays traversal orders function.
+ * Same frame of primary rays is traced in 32x32 tiles with tiles and
+ * pixels taken in scanline, Morton and Hilbert order.
+ * ARGUMENTS: None.
+ * RETURNS: None.
+ */
+VOID ivrt::bench::Order( VOID )
+{
+  const INT W = 512, H = 512, N = 20000, TileSize = 32;
+  const CHAR *Names[3] = {"scanline order", "morton order", "hilbert order"};
+  scene Scene;
+  camera Cam;
+  cache_counters Cache;
+  DBL Times[3];
+
+  for (INT i = 0; i < N; i++)
+    Scene << new sphere(vec3(mth::Rnd0() * 30, mth::Rnd0() * 30, mth::Rnd0() * 30), 0.1 + mth::Rnd1F() * 0.4, surface());
+  Cam.SetLocAtUp(vec3(0, 0, 50), vec3(0)).Resize(W, H);
+  Scene.Update(Cam);
+  ray_gen Gen(Cam);
+
+  fprintf(Log, "# primary rays of %dx%d frame over %d spheres, ns per ray: scanline vs curve order\n", W, H, N);
+  fprintf(Log, "# cache read misses per ray: %s\n", Cache.IsValid() ? "L1 data, last level" : "n/a");
+  for (INT o = 0; o < 3; o++)
+  {
+    std::vector<INT> Tiles, Pixels;
+    UINT64 L1, LL;
+
+    GridOrder((PIXEL_ORDER)o, W / TileSize, H / TileSize, Tiles);
+    GridOrder((PIXEL_ORDER)o, TileSize, TileSize, Pixels);
+    auto Kernel =
+      [&]()
+      {
+        DBL s = 0;
+
+        for (INT t : Tiles)
+          for (INT p : Pixels)
+          {
+            INT x = t % (W / TileSize) * TileSize + p % TileSize, y = t / (W / TileSize) * TileSize + p / TileSize;
+            intr I;
+
+            if (Scene.Intersection(Gen.Get(x + 0.5, y + 0.5), &I, TRUE))
+              s += I.T;
+          }
+        return s;
+      };
+
+    Times[o] = Measure(Kernel, 4);
+    if (o > 0)
+      Report(Names[o], W * H, Times[0], Times[o]);
+    Cache.Measure(Kernel, &L1, &LL);
+    if (Cache.IsValid())
+      fprintf(Log, "%-24s %10.4f %10.4f\n", Names[o], (DBL)L1 / (W * H), (DBL)LL / (W * H));
+  }
+} /* End of 'ivrt::bench::Order' function */
+
+/* Compare plain and quantized mesh storage function.
+ * Bumpy sphere mesh is traced as triangle shapes in scene hierarchy
+ * (double positions and 32-bit indices) and as quantized mesh. Plain size
+ * counts positions, indices and hierarchy only, not triangle shapes.
+ * ARGUMENTS: None.
+ * RETURNS: None.
+ */
+VOID ivrt::bench::Meshes( VOID )
+{
+  const INT W = 512, H = 256, NR = 1 << 14;
+  auto M = std::make_shared<mesh>();
+  std::vector<shape *> Tris;
+  std::vector<ray> Rays;
+  bvh Plain;
+
+  for (INT j = 0; j <= H; j++)
+    for (INT i = 0; i < W; i++)
+    {
+      DBL
+        theta = PI * j / H, phi = 2 * PI * i / W,
+        r = 5 + 0.1 * sin(theta * 17) * cos(phi * 23);
+
+      M->P.push_back(vec3(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi)) * r);
+    }
+  for (INT j = 0; j < H; j++)
+    for (INT i = 0; i < W; i++)
+    {
+      INT a = j * W + i, b = j * W + (i + 1) % W;
+      INT Ind[6] = {a, b, b + W, a, b + W, a + W};
+
+      M->PInd.insert(M->PInd.end(), Ind, Ind + 6);
+    }
+  for (INT i = 0; i < M->Count(); i++)
+    Tris.push_back(new mesh_triangle(M, i));
+  Plain.Build(Tris);
+  qmesh Quant(*M);
+  for (INT i = 0; i < NR; i++)
+  {
+    vec3 org = vec3(mth::Rnd0F(), mth::Rnd0F(), mth::Rnd0F()).Normalizing() * 20;
+
+    Rays.push_back(ray(org, (vec3(mth::Rnd0F(), mth::Rnd0F(), mth::Rnd0F()) * 4 - org).Normalizing()));
+  }
+
+  size_t
+    plain = Plain.Size() + M->P.size() * sizeof(vec3) + M->PInd.size() * sizeof(INT),
+    quant = Quant.Size();
+  INT miss = 0;
+  DBL err = 0;
+
+  /* Hits are compared too: quantization moves vertices by half grid step at most */
+  for (auto &r : Rays)
+  {
+    intr a, b;
+    BOOL ha = Plain.Intersection(r, &a), hb = Quant.Intersection(r, &b);
+
+    if (ha != hb)
+      miss++;
+    else if (ha)
+      err = mth::Max(err, fabs(a.T - b.T));
+  }
+  fprintf(Log, "# %d triangles mesh, bytes per triangle: plain %.1f, quantized %.1f (%.2fx smaller)\n",
+    M->Count(), (DBL)plain / M->Count(), (DBL)quant / M->Count(), (DBL)plain / quant);
+  fprintf(Log, "# %d rays: %d hit/miss mismatches, largest hit distance difference %g\n", NR, miss, err);
+  fprintf(Log, "# closest hit, ns per ray: plain vs quantized mesh\n");
+  Report("qmesh closest hit", NR,
+    Measure([&]()
+    {
+      DBL s = 0;
+
+      for (auto &r : Rays)
+      {
+        intr I;
+
+        if (Plain.Intersection(r, &I))
+          s += I.T;
+      }
+      return s;
+    }, 4),
+    Measure([&]()
+    {
+      DBL s = 0;
+
+      for (auto &r : Rays)
+      {
+        intr I;
+
+        if (Quant.Intersection(r, &I))
+          s += I.T;
+      }
+      return s;
+    }, 4));
+  fprintf(Log, "# any hit, ns per ray: plain vs quantized mesh\n");
+  Report("qmesh any hit", NR,
+    Measure([&]()
+    {
+      INT s = 0;
+
+      for (auto &r : Rays)
+        s += Plain.IsIntersected(r);
+      return s;
+    }, 4),
+    Measure([&]()
+    {
+      INT s = 0;
+
+      for (auto &r : Rays)
+        s += Quant.IsIntersected(r);
+      return s;
+    }, 4));
+  for (auto T : Tris)
+    delete T;
+} /* End of 'ivrt::bench::Meshes' function */
+
+/* Compare moved sphere and moving sphere instance function.
+ * Sphere built at ray time position is the reference: instance hits,
+ * normals and texture coordinates (evaluated in sphere space) must match.
+ * ARGUMENTS: None.
+ * RETURNS: None.
+ */
+VOID ivrt::bench::Instances( VOID )
+{
+  const INT NR = 1 << 14;
+  const vec3 C0(-1, 0, 5), C1(1, 0.5, 5);
+  instance Moving(new sphere(vec3(0), 1, surface()), matr::Translate(C0), matr::Translate(C1));
+  std::vector<ray> Rays;
+
+  for (INT i = 0; i < NR; i++)
+    Rays.push_back(ray(vec3(0), vec3(mth::Rnd0F() * 0.4, mth::Rnd0F() * 0.4, 1).Normalizing(), (mth::Rnd0F() + 1) / 2));
+
+  INT miss = 0;
+  DBL err = 0, uverr = 0;
+
+  for (auto &r : Rays)
+  {
+    sphere Ref(C0 + (C1 - C0) * r.Time, 1, surface());
+    intr a, b;
+    BOOL ha = Ref.Intersection(r, &a), hb = Moving.Intersection(r, &b);
+
+    if (ha != hb)
+      miss++;
+    else if (ha)
+    {
+      a.P = r(a.T), a.IsPos = TRUE;
+      Ref.GetNormal(&a);
+      vec2 d = Ref.GetTexCoord(&a) - b.Shp->GetTexCoord(&b);
+
+      /* Longitude is compared across map seam */
+      d[0] -= floor(d[0] + 0.5);
+      err = mth::Max(err, mth::Max(fabs(a.T - b.T), !(a.N - b.N)));
+      uverr = mth::Max(uverr, sqrt(d & d));
+    }
+  }
+  fprintf(Log, "# %d rays with random times: %d hit/miss mismatches, largest hit distance or normal difference %g, "
+    "largest texture coordinates difference %g\n", NR, miss, err, uverr);
+  fprintf(Log, "# closest hit, ns per ray: moved sphere vs moving instance\n");
+  Report("instance closest hit", NR,
+    Measure([&]()
+    {
+      DBL s = 0;
+
+      for (auto &r : Rays)
+      {
+        sphere Ref(C0 + (C1 - C0) * r.Time, 1, surface());
+        intr I;
+
+        if (Ref.Intersection(r, &I))
+          s += I.T;
+      }
+      return s;
+    }, 4),
+    Measure([&]()
+    {
+      DBL s = 0;
+
+      for (auto &r : Rays)
+      {
+        intr I;
+
+        if (Moving.Intersection(r, &I))
+          s += I.T;
+      }
+      return s;
+    }, 4));
+} /* End of 'ivrt::bench::Instances' function */
+
+/* Run all benchmarks function.
+ * ARGUMENTS:
+ *   - report file name:
+ *       const CHAR *FileName;
+ * RETURNS: (BOOL) TRUE if report is written, FALSE otherwise.
+ */
+BOOL ivrt::bench::Run( const CHAR *FileName )
+{
+  if ((Log = fopen(FileName, "w")) == nullptr)
+    return FALSE;
+#ifdef MTH_AVX
+  fprintf(Log, "# SIMD: AVX\n");
+#elif defined(MTH_SSE)
+  fprintf(Log, "# SIMD: SSE2\n");
+#else
+  fprintf(Log, "# SIMD: none\n");
+#endif
+  Vectors();
+  Triangles();
+  Boxes();
+  CameraRays();
+  Order();
+  Meshes();
+  Instances();
+  fprintf(Log, "# checksum %g\n", Sink);
+  fclose(Log);
+  Log = nullptr;
+  return TRUE;
+} /* End of 'ivrt::bench::Run' function */
+
+/* END OF 'bench.cpp' FILE */
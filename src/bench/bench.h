@@ -0,0 +1,128 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : bench.h
+ * PURPOSE     : Raytracing project.
+ *               Micro-benchmarks declaration module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __bench_h_
+#define __bench_h_
+
+#include <chrono>
+#include <cstdio>
+
+#include "../def.h"
+
+/* Project namespace */
+namespace ivrt
+{
+  /* Micro-benchmarks class.
+   * Runs kernels several times, keeps the best time and writes report
+   * lines "<kernel> <reference ns> <tested ns> <speedup>" to log file. */
+  class bench
+  {
+  private:
+    FILE *Log = nullptr; // report file
+    DBL Sink = 0;        // results checksum (keeps kernels from being optimized out)
+
+    template<class Func>
+      /* Measure best kernel time function.
+       * ARGUMENTS:
+       *   - kernel (returns checksum):
+       *       Func Kernel;
+       *   - number of runs:
+       *       INT Runs;
+       * RETURNS: (DBL) best run time in nanoseconds.
+       */
+      DBL Measure( Func Kernel, INT Runs = 16 )
+      {
+        DBL best = HUGE_VAL;
+
+        for (INT i = 0; i < Runs; i++)
+        {
+          auto start = std::chrono::high_resolution_clock::now();
+
+          Sink += Kernel();
+          best = mth::Min(best, std::chrono::duration<DBL, std::nano>(std::chrono::high_resolution_clock::now() - start).count());
+        }
+        return best;
+      } /* End of 'Measure' function */
+
+    /* Write one comparison line function.
+     * ARGUMENTS:
+     *   - kernel name:
+     *       const CHAR *Name;
+     *   - number of operations per run:
+     *       INT Ops;
+     *   - reference and tested run times in nanoseconds:
+     *       DBL Ref, Test;
+     * RETURNS: None.
+     */
+    VOID Report( const CHAR *Name, INT Ops, DBL Ref, DBL Test );
+
+    /* Compare scalar and SIMD vec3 kernels function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    VOID Vectors( VOID );
+
+    /* Compare single and eight triangles packet intersection function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    VOID Triangles( VOID );
+
+    /* Compare scalar and eight boxes slab tests function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    VOID Boxes( VOID );
+
+    /* Compare per pixel and per frame camera rays generation function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    VOID CameraRays( VOID );
+
+    /* Compare primary rays traversal orders function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    VOID Order( VOID );
+
+    /* Compare plain and quantized mesh storage function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    VOID Meshes( VOID );
+
+    /* Compare moved sphere and moving sphere instance function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    VOID Instances( VOID );
+
+  public:
+    /* Run all benchmarks function.
+     * ARGUMENTS:
+     *   - report file name:
+     *       const CHAR *FileName;
+     * RETURNS: (BOOL) TRUE if report is written, FALSE otherwise.
+     */
+    BOOL Run( const CHAR *FileName );
+  }; /* End of 'bench' class */
+} /* end of 'ivrt' namespace */
+
+#endif /* __bench_h_ */
+
+/* END OF 'bench.h' FILE */
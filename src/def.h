@@ -77,7 +77,13 @@ namespace ivrt
   typedef mth::vec2<DBL> vec2;
   typedef mth::vec4<DBL> vec4;
   typedef mth::camera<DBL> camera;
+  typedef mth::ray_gen<DBL> ray_gen;
   typedef mth::ray<DBL> ray;
+  typedef mth::ray_diff<DBL> ray_diff;
+  typedef mth::inv_ray<DBL> inv_ray;
+  typedef mth::aabb<DBL> aabb;
+  typedef mth::frustum<DBL> frustum;
+  typedef mth::sampler sampler;
 }
 
 /* Stock class template */
@@ -15,28 +15,39 @@
  * Computer Graphics Support Group of 30 Phys-Math Lyceum
  */
 
+#include <atomic>
+#include <cctype>
+#include <chrono>
 #include <cmath>
 #include <ctime>
 #include <thread>
 #include <map>
+#include <string>
 #include <vector>
 
 #include "def.h"
 #include "win/win.h"
 #include "rt/frame/frame.h"
+#include "rt/frame/order.h"
 #include "rt/rt.h"
 #include "rt/rt_def.h"
 #include "rt/lights/point.h"
+#include "rt/lights/area.h"
+#include "rt/wavefront/wavefront.h"
+#include "rt/path/path.h"
+#include "bench/bench.h"
 #include "timer.h"
 
 /* Material structure */
-struct
+struct material
 {
-public:
-  std::string Name;
+  const CHAR *Name;
   ivrt::vec3 Ka, Kd, Ks;
   FLT Ph;
-} MatLib[] =
+};
+
+/* Materials library (built at compile time) */
+constexpr material MatLib[] =
 {
   {"Black Plastic", {0.0, 0.0, 0.0},             {0.01, 0.01, 0.01},           {0.5, 0.5, 0.5},               32},
   {"Brass",         {0.329412,0.223529,0.027451}, {0.780392,0.568627,0.113725}, {0.992157,0.941176,0.807843}, 27.8974},
@@ -64,16 +75,40 @@ public:
 /* Project namespace */
 namespace ivrt
 {
+  /* Rendering engine selection */
+  enum render_mode
+  {
+    RENDER_WHITTED,   // depth-first Whitted-style ray tree
+    RENDER_WAVEFRONT, // breadth-first wavefront ray tree
+    RENDER_PATH       // Monte Carlo path tracing
+  }; /* End of 'render_mode' enumeration */
+
   /* Raytracer class */
   class raytracer : public win
   {
   public:
     scene Scene; 
     camera Cam;
-    //timer T;
+    camera CamEnd; // camera at shutter close
+    timer T;      // frame and phases times
     frame Frame;  // Window frame
+    render_mode Mode = RENDER_WHITTED; // rendering engine
+    INT SamplesPerPixel = 16;          // path tracing paths per pixel
+    INT BlurSamples = 16;              // Whitted rays per out of focus (thin lens camera) or motion blurred pixel
+    DBL Shutter = 0;                   // open shutter part of frame interval (0 - no motion blur)
+    static constexpr DBL AngleStep = 3; // camera rotation per frame in degrees
+#ifdef IVRT_STATS
+    BOOL WriteStats = FALSE;           // write ray statistics after each frame
+#endif /* IVRT_STATS */
+    mth::sampler_type Sampler = mth::SAMPLER_SOBOL; // path tracing samples sequence
+    PIXEL_ORDER Order = ORDER_HILBERT; // tiles and tile pixels traversal order
+    static const INT TileSize = 32;    // tile side size in pixels (power of two)
   private:
     std::thread Th[11];
+    std::vector<INT>
+      Tiles,                           // frame tiles in traversal order
+      TilePixels;                      // tile pixels in traversal order
+    std::atomic<INT> NextTile;         // next tile to be rendered
   public:
     raytracer( VOID )
     {
@@ -87,30 +122,132 @@ namespace ivrt
     */
     VOID Render( VOID )
     {
+      IVRT_PROFILE("Frame");
+      DBL Start;
+      CHAR Buf[128];
+
+      T.Response();
+      /* Threads take tiles one by one in curve order, so neighbour rays
+       * (and hierarchy nodes they visit) stay close in time */
       auto ThreadFunc = []( raytracer *RT, INT i )
       {
-        intr I;
-        vec3 L = vec3(1, 1, 1).Normalizing();
         vec3 color;
-        envi Media(0.7, 0.3);
-        for (INT y = i * (RT->Frame.Height / 11); y < (i + 1) * (RT->Frame.Height / 11); y++)
-          for (INT x = 0; x < RT->Frame.Width; x++)
-          {
-            ray R = RT->Cam.FrameRay(x + 0.5, y + 0.5);
-            color = RT->Scene.Trace(R, Media, 1.0, 0);
+        INT tw = (RT->Frame.Width + TileSize - 1) / TileSize, t;
+        wavefront WF;
+        path_tracer PT;
+        BOOL IsBlur = RT->Shutter > 0;
+        ray_gen Gen = IsBlur ? ray_gen(RT->Cam, RT->CamEnd) : ray_gen(RT->Cam);
+        sampler Smp(RT->Sampler);
 
-            RT->Frame.PutPixel(x, y, frame::ToRGB(color));
-          }
+        profiler::Get().SetWorker(i);
+        PT.SamplesPerPixel = RT->SamplesPerPixel;
+        PT.Sampler = RT->Sampler;
+        PT.CamEnd = IsBlur ? &RT->CamEnd : nullptr;
+        while ((t = RT->NextTile++) < (INT)RT->Tiles.size())
+        {
+          IVRT_PROFILE("Render tile");
+          INT
+            X0 = RT->Tiles[t] % tw * TileSize, Y0 = RT->Tiles[t] / tw * TileSize,
+            X1 = mth::Min(X0 + TileSize, RT->Frame.Width), Y1 = mth::Min(Y0 + TileSize, RT->Frame.Height);
+          auto Start = std::chrono::steady_clock::now();
+
+          if (RT->Mode == RENDER_WAVEFRONT)
+            WF.Render(RT->Scene, RT->Cam, RT->Frame, X0, Y0, X1, Y1);
+          else if (RT->Mode == RENDER_PATH)
+            PT.Render(RT->Scene, RT->Cam, RT->Frame, X0, Y0, X1, Y1);
+          else
+            for (INT p : RT->TilePixels)
+            {
+              INT x = X0 + p % TileSize, y = Y0 + p / TileSize;
+
+              if (x >= X1 || y >= Y1)
+                continue;
+
+              ray R = Gen.Get(x + 0.5, y + 0.5);
+              ray_diff D = Gen.Diff(x + 0.5, y + 0.5);
+              intr I;
+              IVRT_STATS_ONLY(UINT64 Cost = stats::Local().Cost();)
+
+              /* Random numbers depend on pixel only, not on thread */
+              mth::Rng().Set(mth::Hash(x, y));
+              BOOL IsSharp = !Gen.IsLens() || (RT->Scene.Intersection(R, &I, TRUE) && Gen.IsInFocus(Gen.Depth(R(I.T))));
+
+              if (!IsSharp || IsBlur)
+              {
+                /* Out of focus or moving pixel: average rays through lens and shutter samples */
+                color = vec3(0);
+                D = D.Scale(1 / sqrt(mth::Max(RT->BlurSamples, 1)));
+                for (INT s = 0; s < RT->BlurSamples; s++)
+                {
+                  DBL lu = 0.5, lv = 0.5, t = 0;
+
+                  Smp.Start(x, y, s);
+                  if (!IsSharp)
+                    Smp.Get2D(&lu, &lv);
+                  if (IsBlur)
+                    t = Smp.Get1D();
+                  R = Gen.Get(x + 0.5, y + 0.5, lu, lv, t);
+                  color += RT->Scene.Trace(R, Air, 1.0, 0, D);
+                }
+                color = color / mth::Max(RT->BlurSamples, 1);
+              }
+              else
+                color = RT->Scene.Trace(R, Air, 1.0, 0, D);
+
+              RT->Frame.PutPixel(x, y, frame::ToRGB(color));
+              IVRT_STATS_ONLY(stats::Get().PutCost(x, y, stats::Local().Cost() - Cost);)
+            }
+          IVRT_STATS_ONLY(stats::Get().Merge(i, X0, Y0, X1, Y1,
+            std::chrono::duration<DBL>(std::chrono::steady_clock::now() - Start).count());)
+        }
       };
+      IVRT_STATS_ONLY(stats::Get().Start(Frame.Width, Frame.Height);)
+      Start = T.Now();
+      /* Camera keeps rotating while shutter is open */
+      CamEnd = Cam;
+      CamEnd.Rotate(vec3(0, 1, 0), AngleStep * Shutter);
+      Scene.Update(Cam, Shutter <= 0);
+      GridOrder(Order, (Frame.Width + TileSize - 1) / TileSize, (Frame.Height + TileSize - 1) / TileSize, Tiles);
+      GridOrder(Order, TileSize, TileSize, TilePixels);
+      NextTile = 0;
+      T.Phase("update", T.Now() - Start);
+      Start = T.Now();
       for (INT i = 0; i < 11; i++)
         Th[i] = std::thread(ThreadFunc, this, i);
 
       for (INT i = 0; i < 11; i++)
         Th[i].join();
+      T.Phase("render", T.Now() - Start);
+#ifdef IVRT_STATS
+      if (WriteStats)
+      {
+        IVRT_PROFILE("Write stats");
 
+        stats::Get().WriteJSON("bin/stats.json");
+        stats::Get().WriteCSV("bin/stats.csv");
+        stats::Get().WriteHeatmap("bin/heatmap.tga");
+      }
+#endif /* IVRT_STATS */
+
+      sprintf(Buf, "T06RT: %.2f FPS, frame p50 %.0f p95 %.0f p99 %.0f ms", T.FPS,
+              T.Frames.Percentile(50) * 1000, T.Frames.Percentile(95) * 1000, T.Frames.Percentile(99) * 1000);
+      SetWindowText(hWnd, Buf);
       InvalidateRect(hWnd, nullptr, TRUE);
     } /* End of 'Render' function */
 
+    /* Save frame to file function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    VOID Save( VOID )
+    {
+      IVRT_PROFILE("Save TGA");
+      DBL Start = T.Now();
+
+      Frame.SaveTGA();
+      T.Phase("save", T.Now() - Start);
+    } /* End of 'Save' function */
+
     /* Initialization function.
      * ARGUMENTS: None.
      * RETURNS: None.
@@ -153,7 +290,7 @@ namespace ivrt
       //Cam.Resize(W, H);
       //Frame.Resize(W, H);
       Render();
-      Frame.SaveTGA();
+      Save();
       //for (INT y = 0; y < H; y++)
       //  for (INT x = 0; x < W; x++)
       //    Frame.PutPixel(x, y, RGB(120 * sin(x), 10 * cos(y), 10));
@@ -170,9 +307,9 @@ namespace ivrt
     VOID Timer( VOID ) override
     {
       Render();
-      Frame.SaveTGA();
+      Save();
 
-      Cam.Rotate(vec3(0, 1, 0), 3);
+      Cam.Rotate(vec3(0, 1, 0), AngleStep);
     } /* End of 'Timer' function */
     /* Erase function.
      * ARGUMENTS: 
@@ -193,7 +330,7 @@ namespace ivrt
     VOID Idle( VOID ) final
     {
       Render();
-      Frame.SaveTGA();
+      Save();
       //Cam.Rotate(vec3(0, 1, 0), 10);
     } /* End of 'Idle' function */
 
@@ -221,77 +358,188 @@ namespace ivrt
 
 } /* end of 'ivrt' namespace */
 
-/* Load primitive from '*.OBJ' file function.
+/* Read OBJ face corner function.
+ * ARGUMENTS:
+ *   - string to read from (moved past corner):
+ *       const CHAR **S;
+ *   - position, texture coordinates and normal indices (0 if absent):
+ *       INT *C;
+ * RETURNS:
+ *   (BOOL) TRUE if corner is read, FALSE at the end of string.
+ */
+static BOOL ReadCorner( const CHAR **S, INT *C )
+{
+  INT len = 0;
+
+  C[0] = C[1] = C[2] = 0;
+  if (sscanf(*S, "%d/%d/%d%n", &C[0], &C[1], &C[2], &len) == 3 ||
+      sscanf(*S, "%d//%d%n", &C[0], &C[2], &len) == 2 ||
+      (C[2] = 0, sscanf(*S, "%d/%d%n", &C[0], &C[1], &len)) == 2 ||
+      (C[1] = 0, sscanf(*S, "%d%n", &C[0], &len)) == 1)
+  {
+    *S += len;
+    return TRUE;
+  }
+  return FALSE;
+} /* End of 'ReadCorner' function */
+
+/* Load mesh from '*.OBJ' file function.
+ * Positions, normals and texture coordinates keep own index streams;
+ * polygons are split to triangles fan. Normals (texture coordinates) are
+ * dropped if some face corner has none.
  * ARGUMENTS:
- *   - pointer to primitive to create:
- *       dg5PRIM *Pr;
- *   - primitive type:
- *       INT Type;
+ *   - mesh to fill:
+ *       ivrt::mesh *M;
  *   - '*.OBJ' file name:
  *       CHAR *FileName;
  * RETURNS:
  *   (BOOL) TRUE if success, FALSE otherwise.
  */
-BOOL PrimitiveLoad( std::vector<ivrt::vec3> &V, std::vector<INT> &I, const CHAR *FileName )
+BOOL PrimitiveLoad( ivrt::mesh *M, const CHAR *FileName )
 {
-  INT
-    noofv = 0,
-    noofi = 0;
   FILE *F;
   CHAR Buf[1000];
+  BOOL IsN = TRUE, IsUV = TRUE;
 
   /* Open file */
   if ((F = fopen(FileName, "r")) == NULL)
     return FALSE;
 
-  /* Count vertex and index quantities */
-  while (fgets(Buf, sizeof(Buf) - 1, F) != NULL)
-  {
-    if (Buf[0] == 'v' && Buf[1] == ' ')
-      noofv++;
-    else if (Buf[0] == 'f' && Buf[1] == ' ')
-      noofi++;
-  }
-  I.resize(noofi * 3);
-  V.resize(noofv);
-
-  //Ind = (INT *)(V + noofv);
-
   /* Read vertices and facets data */
-  rewind(F);
-  noofv = noofi = 0;
+  *M = ivrt::mesh();
   while (fgets(Buf, sizeof(Buf) - 1, F) != NULL)
   {
+    DBL x = 0, y = 0, z = 0;
+
     if (Buf[0] == 'v' && Buf[1] == ' ')
     {
-      FLT x, y, z;
-
-      sscanf(Buf + 2, "%f%f%f", &x, &y, &z);
-      V[noofv++] = ivrt::vec3(x, y, z);
+      sscanf(Buf + 2, "%lf%lf%lf", &x, &y, &z);
+      M->P.push_back(ivrt::vec3(x, y, z));
+    }
+    else if (Buf[0] == 'v' && Buf[1] == 'n' && Buf[2] == ' ')
+    {
+      sscanf(Buf + 3, "%lf%lf%lf", &x, &y, &z);
+      M->N.push_back(ivrt::vec3(x, y, z));
+    }
+    else if (Buf[0] == 'v' && Buf[1] == 't' && Buf[2] == ' ')
+    {
+      sscanf(Buf + 3, "%lf%lf", &x, &y);
+      M->UV.push_back(ivrt::vec2(x, y));
     }
     else if (Buf[0] == 'f' && Buf[1] == ' ')
     {
-      INT n1, n2, n3;
-
-      /* Read one of possible facet references */
-      sscanf(Buf + 2, "%d/%*d/%*d %d/%*d/%*d %d/%*d/%*d", &n1, &n2, &n3) == 3 ||
-      sscanf(Buf + 2, "%d//%*d %d//%*d %d//%*d", &n1, &n2, &n3) == 3 ||
-      sscanf(Buf + 2, "%d/%*d %d/%*d %d/%*d", &n1, &n2, &n3) == 3 ||
-      sscanf(Buf + 2, "%d %d %d", &n1, &n2, &n3);
-      n1--;
-      n2--;
-      n3--;
-      I[noofi++] = n1;
-      I[noofi++] = n2;
-      I[noofi++] = n3;
+      const CHAR *S = Buf + 2;
+      INT C[3], First[3], Prev[3], n = 0;
+      INT Sizes[3] = {(INT)M->P.size(), (INT)M->UV.size(), (INT)M->N.size()};
+
+      while (ReadCorner(&S, C))
+      {
+        /* Negative references count from the last read element */
+        for (INT k = 0; k < 3; k++)
+          C[k] = C[k] < 0 ? Sizes[k] + C[k] : C[k] - 1;
+        IsUV = IsUV && C[1] >= 0;
+        IsN = IsN && C[2] >= 0;
+        if (n == 0)
+          memcpy(First, C, sizeof(C));
+        else if (n >= 2)
+        {
+          const INT *Tri[3] = {First, Prev, C};
+
+          for (INT i = 0; i < 3; i++)
+          {
+            M->PInd.push_back(Tri[i][0]);
+            M->UVInd.push_back(Tri[i][1]);
+            M->NInd.push_back(Tri[i][2]);
+          }
+        }
+        memcpy(Prev, C, sizeof(C));
+        n++;
+      }
     }
   }
 
   fclose(F);
 
+  if (!IsUV)
+    M->UVInd.clear();
+  if (!IsN)
+    M->NInd.clear();
+  for (size_t i = 0; i < M->PInd.size(); i++)
+    if (M->PInd[i] < 0 || M->PInd[i] >= (INT)M->P.size() ||
+        (IsUV && M->UVInd[i] >= (INT)M->UV.size()) ||
+        (IsN && M->NInd[i] >= (INT)M->N.size()))
+      return FALSE;
   return TRUE;
 } /* End of 'PrimitiveLoad' function */
 
+/* Split command line to options function.
+ * Options are separated by spaces; double quotes keep spaces in option
+ * (for file names) and are removed.
+ * ARGUMENTS:
+ *   - command line string (may be nullptr):
+ *       const CHAR *CmdLine;
+ * RETURNS:
+ *   (std::vector<std::string>) options.
+ */
+static std::vector<std::string> SplitOptions( const CHAR *CmdLine )
+{
+  std::vector<std::string> Opts;
+  std::string Cur;
+  BOOL IsQuote = FALSE, IsOpt = FALSE;
+
+  for (const CHAR *S = CmdLine; S != nullptr && *S != 0; S++)
+    if (*S == '"')
+      IsQuote = !IsQuote, IsOpt = TRUE;
+    else if (!IsQuote && isspace((BYTE)*S))
+    {
+      if (IsOpt)
+        Opts.push_back(Cur);
+      Cur.clear();
+      IsOpt = FALSE;
+    }
+    else
+      Cur += *S, IsOpt = TRUE;
+  if (IsOpt)
+    Opts.push_back(Cur);
+  return Opts;
+} /* End of 'SplitOptions' function */
+
+/* Check flag option function.
+ * ARGUMENTS:
+ *   - options:
+ *       const std::vector<std::string> &Opts;
+ *   - option name:
+ *       const CHAR *Name;
+ * RETURNS:
+ *   (BOOL) TRUE if option is given, FALSE otherwise.
+ */
+static BOOL IsOption( const std::vector<std::string> &Opts, const CHAR *Name )
+{
+  for (auto &O : Opts)
+    if (O == Name)
+      return TRUE;
+  return FALSE;
+} /* End of 'IsOption' function */
+
+/* Get '<name>=<value>' option value function.
+ * ARGUMENTS:
+ *   - options:
+ *       const std::vector<std::string> &Opts;
+ *   - option name (without '='):
+ *       const CHAR *Name;
+ * RETURNS:
+ *   (const CHAR *) option value, nullptr if option is not given.
+ */
+static const CHAR * GetOption( const std::vector<std::string> &Opts, const CHAR *Name )
+{
+  size_t len = strlen(Name);
+
+  for (auto &O : Opts)
+    if (O.size() > len && O[len] == '=' && O.compare(0, len, Name) == 0)
+      return O.c_str() + len + 1;
+  return nullptr;
+} /* End of 'GetOption' function */
+
  /* The main program function.
   * ARGUMENTS:
   *   - handle of application instance:
@@ -307,7 +555,59 @@ BOOL PrimitiveLoad( std::vector<ivrt::vec3> &V, std::vector<INT> &I, const CHAR
   */
 INT WINAPI WinMain( HINSTANCE hInstance, HINSTANCE hPrevInstance, CHAR *CmdLine, INT CmdShow )
 {
+  std::vector<std::string> Opts = SplitOptions(CmdLine);
+
+  if (IsOption(Opts, "bench"))
+    return ivrt::bench().Run("bin/bench.log") ? 0 : 1;
+
+  if (IsOption(Opts, "trace"))
+    ivrt::profiler::Get().IsEnabled = TRUE;
+
   ivrt::raytracer MyNew;
+  DBL SceneStart = ivrt::profiler::Get().Now();
+  const CHAR *Opt;
+  INT Res;
+  FILE *F;
+
+  if (IsOption(Opts, "wavefront"))
+    MyNew.Mode = ivrt::RENDER_WAVEFRONT;
+  else if (IsOption(Opts, "path"))
+    MyNew.Mode = ivrt::RENDER_PATH;
+  /* stats - write ray statistics (counters are compiled in Debug configurations only) */
+  if (IsOption(Opts, "stats"))
+#ifdef IVRT_STATS
+    MyNew.WriteStats = TRUE;
+#else /* IVRT_STATS */
+    MessageBox(nullptr, "Ray statistics are disabled in this build (define IVRT_STATS)", "T06RT", MB_OK | MB_ICONWARNING);
+#endif /* IVRT_STATS */
+  if ((Opt = GetOption(Opts, "order")) != nullptr)
+  {
+    if (strcmp(Opt, "scanline") == 0)
+      MyNew.Order = ivrt::ORDER_SCANLINE;
+    else if (strcmp(Opt, "morton") == 0)
+      MyNew.Order = ivrt::ORDER_MORTON;
+  }
+  if ((Opt = GetOption(Opts, "lens")) != nullptr)
+  {
+    DBL Radius = 0, Focal = !(MyNew.Cam.At - MyNew.Cam.Loc);
+
+    /* lens=<radius>[,<focal distance>], focused on pivot point by default */
+    sscanf(Opt, "%lf,%lf", &Radius, &Focal);
+    MyNew.Cam.SetLens(Radius, Focal);
+  }
+  if ((Opt = GetOption(Opts, "shutter")) != nullptr)
+    MyNew.Shutter = mth::Min(mth::Max(atof(Opt), 0.0), 1.0);
+  if ((Opt = GetOption(Opts, "spp")) != nullptr)
+    MyNew.SamplesPerPixel = atoi(Opt);
+  if ((Opt = GetOption(Opts, "sampler")) != nullptr)
+  {
+    if (strcmp(Opt, "random") == 0)
+      MyNew.Sampler = mth::SAMPLER_RANDOM;
+    else if (strcmp(Opt, "halton") == 0)
+      MyNew.Sampler = mth::SAMPLER_HALTON;
+    else if (strcmp(Opt, "blue") == 0)
+      MyNew.Sampler = mth::SAMPLER_BLUE_NOISE;
+  }
   std::map<std::string, ivrt::surface> MtlTable;
   //ivrt::surface MtlTable[MAT_N];
   DBL Radius = 0.5;
@@ -321,16 +621,54 @@ INT WINAPI WinMain( HINSTANCE hInstance, HINSTANCE hPrevInstance, CHAR *CmdLine,
     MyNew.Scene << new ivrt::sphere(ivrt::vec3(1 * (i % 4), 2 * Radius * (i / 4), 0), Radius, 
                                      MtlTable[MatLib[i].Name]);
   }
-  MyNew.Scene << new ivrt::point(ivrt::vec3(5, 10, 5), ivrt::vec3(1, 1, 1), 10, 20) <<
-                 new ivrt::plane(ivrt::vec3(0, 1, 0), 0) <<
+  ivrt::area_sphere *Sun = new ivrt::area_sphere(ivrt::vec3(5, 10, 5), 1, ivrt::vec3(1, 1, 1), 16);
+  ivrt::plane *Floor = new ivrt::plane(ivrt::vec3(0, 1, 0), 0);
+
+  /* texmem=<megabytes> resident textures budget (counts whole mip pyramids and is
+   * enforced between frames only, so one frame textures may exceed it),
+   * texture=<file.tga|ppm> floor map (repeats every 4 units) */
+  if ((Opt = GetOption(Opts, "texmem")) != nullptr)
+    MyNew.Scene.Textures.Budget = (size_t)mth::Max(atoi(Opt), 1) << 20;
+  if ((Opt = GetOption(Opts, "texture")) != nullptr)
+  {
+    Floor->mtl.Map = MyNew.Scene.Textures.Get(Opt);
+    Floor->mtl.MapScale = 0.25;
+  }
+
+  /* floor=<checker|noise|marble|wood|gradient> procedural floor color */
+  if ((Opt = GetOption(Opts, "floor")) != nullptr)
+    if (ivrt::proc_ref Graph = ivrt::proc_texture::Preset(Opt))
+      Floor->mtl.Proc = std::make_shared<ivrt::proc_texture>(Graph);
+
+  /* Emitted radiance giving about the same irradiance as Whitted lighting */
+  Sun->Power = 30;
+  MyNew.Scene << Sun <<
+                 Floor <<
                  new ivrt::point(ivrt::vec3(-5, 10, -5), ivrt::vec3(1, 1, 1), 10, 20);
-  std::vector<ivrt::vec3> Res_V;
-  std::vector<INT> Res_I;
-  //PrimitiveLoad(Res_V, Res_I, "bin/models/cow.object");
 
-  INT V;
-  //for (INT i = 0; i < Res_I.size() - 3; i += 3)
-  //  MyNew.Scene << new ivrt::triangle(Res_V[Res_I[i]], Res_V[Res_I[i + 1]], Res_V[Res_I[i + 2]]);
+  /* moving - sphere instance moving by one unit along X while shutter is open (blurred with 'shutter') */
+  if (IsOption(Opts, "moving"))
+    MyNew.Scene << new ivrt::instance(new ivrt::sphere(ivrt::vec3(0), Radius, MtlTable[MatLib[0].Name]),
+                                      ivrt::matr::Translate(ivrt::vec3(0, Radius, 2)),
+                                      ivrt::matr::Translate(ivrt::vec3(1, Radius, 2)));
+
+  /* model=<file.obj> mesh, smooth - compute smooth normals if file has none,
+   * quantize - keep mesh compressed (for very large models) */
+  if ((Opt = GetOption(Opts, "model")) != nullptr)
+  {
+    auto Mesh = std::make_shared<ivrt::mesh>();
+
+    if (PrimitiveLoad(Mesh.get(), Opt))
+    {
+      if (Mesh->NInd.empty() && IsOption(Opts, "smooth"))
+        Mesh->SmoothNormals();
+      if (IsOption(Opts, "quantize"))
+        MyNew.Scene << new ivrt::qmesh(*Mesh);
+      else
+        for (INT i = 0; i < Mesh->Count(); i++)
+          MyNew.Scene << new ivrt::mesh_triangle(Mesh, i);
+    }
+  }
 
   //ivrt::vec3 p(120, 13, 4);
   //FLT x = p.Distance(p);
@@ -351,8 +689,18 @@ INT WINAPI WinMain( HINSTANCE hInstance, HINSTANCE hPrevInstance, CHAR *CmdLine,
   //getchar();
   //MyNew.Scene << new ivrt::box(ivrt::vec3(0, 0, 0), ivrt::vec3(1, 1, 1)); 
   //v << "";
+  if (ivrt::profiler::Get().IsEnabled)
+    ivrt::profiler::Get().Add("Scene build", SceneStart, ivrt::profiler::Get().Now() - SceneStart);
 
-  return MyNew.Run();
+  Res = MyNew.Run();
+  if ((F = fopen("bin/frames.log", "w")) != nullptr)
+  {
+    MyNew.T.Report(F);
+    fclose(F);
+  }
+  if (ivrt::profiler::Get().IsEnabled)
+    ivrt::profiler::Get().Write("bin/trace.json");
+  return Res;
 } /* End of 'WinMain' function */
 
 
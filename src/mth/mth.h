@@ -20,9 +20,13 @@
 
 #include "mth_vec2.h"
 #include "mth_vec3.h"
+#include "mth_vec3x8.h"
 #include "mth_vec4.h"
 #include "mth_matr.h"
 #include "mth_camera.h"
 #include "mth_ray.h"
+#include "mth_aabb.h"
+#include "mth_frustum.h"
+#include "mth_sampler.h"
 
 #endif /* __mth_h_ */
@@ -0,0 +1,300 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : mth_aabb.h
+ * PURPOSE     : Raytracing project.
+ *               Mathematics library.
+ *               Axis aligned bounding boxes handle module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'mth'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __mth_aabb_h_
+#define __mth_aabb_h_
+
+#include <limits>
+
+#include "mth_ray.h"
+#include "mth_vec3x8.h"
+
+/* Math library namespace */
+namespace mth
+{
+  /* Ray with precomputed inverse direction class.
+   * Built once per ray and reused for every slab test along its way
+   * (zero direction components give infinite inverses, which slab
+   * arithmetic handles without special cases). */
+  template<class Type>
+    class inv_ray
+    {
+    public:
+      vec3<Type> Org;    // ray origin
+      vec3<Type> InvDir; // inverse ray direction
+
+      /* Class constructor.
+       * ARGUMENTS:
+       *   - ray:
+       *       const ray<Type> &R;
+       */
+      inv_ray( const ray<Type> &R ) noexcept :
+        Org(R.Org), InvDir(1 / R.Dir[0], 1 / R.Dir[1], 1 / R.Dir[2])
+      {
+      } /* End of 'inv_ray' function */
+    }; /* End of 'inv_ray' class */
+
+  /* Axis aligned bounding box class */
+  template<class Type>
+    class aabb
+    {
+    public:
+      vec3<Type> Min, Max; // box corners
+
+      /* Class constructor (empty box).
+       * ARGUMENTS: None.
+       */
+      constexpr aabb( VOID ) noexcept :
+        Min(std::numeric_limits<Type>::infinity()), Max(-std::numeric_limits<Type>::infinity())
+      {
+      } /* End of 'aabb' function */
+
+      /* Class constructor.
+       * ARGUMENTS:
+       *   - box corners:
+       *       const vec3<Type> &NMin, &NMax;
+       */
+      constexpr aabb( const vec3<Type> &NMin, const vec3<Type> &NMax ) noexcept : Min(NMin), Max(NMax)
+      {
+      } /* End of 'aabb' function */
+
+      /* Check if box is empty function.
+       * ARGUMENTS: None.
+       * RETURNS: (BOOL) TRUE if box contains no points.
+       */
+      constexpr BOOL IsEmpty( VOID ) const noexcept
+      {
+        return Min[0] > Max[0] || Min[1] > Max[1] || Min[2] > Max[2];
+      } /* End of 'IsEmpty' function */
+
+      /* Extend box by point function.
+       * ARGUMENTS:
+       *   - point:
+       *       const vec3<Type> &P;
+       * RETURNS: (aabb &) self reference.
+       */
+      aabb & Grow( const vec3<Type> &P ) noexcept
+      {
+        Min = vec3<Type>::Min(Min, P);
+        Max = vec3<Type>::Max(Max, P);
+        return *this;
+      } /* End of 'Grow' function */
+
+      /* Extend box by box function.
+       * ARGUMENTS:
+       *   - box:
+       *       const aabb &B;
+       * RETURNS: (aabb &) self reference.
+       */
+      aabb & Grow( const aabb &B ) noexcept
+      {
+        Min = vec3<Type>::Min(Min, B.Min);
+        Max = vec3<Type>::Max(Max, B.Max);
+        return *this;
+      } /* End of 'Grow' function */
+
+      /* Get box center function.
+       * ARGUMENTS: None.
+       * RETURNS: (vec3<Type>) center point.
+       */
+      vec3<Type> Center( VOID ) const noexcept
+      {
+        return (Min + Max) * 0.5;
+      } /* End of 'Center' function */
+
+      /* Get box surface area function.
+       * ARGUMENTS: None.
+       * RETURNS: (Type) surface area (0 for empty box).
+       */
+      Type Area( VOID ) const noexcept
+      {
+        if (IsEmpty())
+          return 0;
+
+        vec3<Type> d = Max - Min;
+
+        return 2 * (d[0] * d[1] + d[1] * d[2] + d[2] * d[0]);
+      } /* End of 'Area' function */
+
+      /* Get longest box axis function.
+       * ARGUMENTS: None.
+       * RETURNS: (INT) axis index.
+       */
+      INT LongestAxis( VOID ) const noexcept
+      {
+        vec3<Type> d = Max - Min;
+
+        return d[0] > d[1] ? (d[0] > d[2] ? 0 : 2) : (d[1] > d[2] ? 1 : 2);
+      } /* End of 'LongestAxis' function */
+
+      /* Branchless slab test function.
+       * All three slabs are clipped at once with four-lane min/max, then
+       * the entry distance is the largest near plane and the exit one
+       * the smallest far plane.
+       * ARGUMENTS:
+       *   - prepared ray:
+       *       const inv_ray<Type> &R;
+       *   - maximal ray distance:
+       *       Type TMax;
+       *   - result entry and exit distances (entry may be negative if ray starts inside):
+       *       Type *TNear, *TFar;
+       * RETURNS: (BOOL) TRUE if ray segment [0, TMax) touches box.
+       */
+      BOOL Intersect( const inv_ray<Type> &R, Type TMax, Type *TNear, Type *TFar ) const noexcept
+      {
+        vec3<Type>
+          t0 = (Min - R.Org) * R.InvDir,
+          t1 = (Max - R.Org) * R.InvDir,
+          tn = vec3<Type>::Min(t0, t1),
+          tf = vec3<Type>::Max(t0, t1);
+
+        *TNear = mth::Max(mth::Max(tn[0], tn[1]), tn[2]);
+        *TFar = mth::Min(mth::Min(tf[0], tf[1]), tf[2]);
+        return *TNear <= *TFar && *TFar >= 0 && *TNear < TMax;
+      } /* End of 'Intersect' function */
+
+      /* Branchless slab test function.
+       * ARGUMENTS:
+       *   - prepared ray:
+       *       const inv_ray<Type> &R;
+       *   - maximal ray distance:
+       *       Type TMax;
+       * RETURNS: (BOOL) TRUE if ray segment [0, TMax) touches box.
+       */
+      BOOL Intersect( const inv_ray<Type> &R, Type TMax ) const noexcept
+      {
+        Type tn, tf;
+
+        return Intersect(R, TMax, &tn, &tf);
+      } /* End of 'Intersect' function */
+    }; /* End of 'aabb' class */
+
+  /* Ray with precomputed inverse direction in eight float lanes class */
+  class inv_ray8
+  {
+  public:
+    vec3x8 Org, InvDir; // ray origin and inverse direction in all lanes
+
+    /* Class constructor.
+     * ARGUMENTS:
+     *   - prepared ray:
+     *       const inv_ray<Type> &R;
+     */
+    template<class Type>
+      inv_ray8( const inv_ray<Type> &R ) :
+        Org(vec3<FLT>((FLT)R.Org[0], (FLT)R.Org[1], (FLT)R.Org[2])),
+        InvDir(vec3<FLT>((FLT)R.InvDir[0], (FLT)R.InvDir[1], (FLT)R.InvDir[2]))
+      {
+      } /* End of 'inv_ray8' function */
+  }; /* End of 'inv_ray8' class */
+
+  /* Eight bounding boxes class (acceleration structure node children).
+   * Corners are kept as float lanes rounded outwards, so the test is
+   * conservative; unused lanes hold NaN corners and never give a hit. */
+  class aabb8
+  {
+  public:
+    vec3x8 Min, Max; // boxes corners lanes
+
+    /* Class constructor (no boxes).
+     * ARGUMENTS: None.
+     */
+    aabb8( VOID ) : Min(vec3<FLT>(std::numeric_limits<FLT>::quiet_NaN())), Max(Min)
+    {
+    } /* End of 'aabb8' function */
+
+    /* Class constructor.
+     * ARGUMENTS:
+     *   - boxes (up to 8):
+     *       const aabb<Type> *Boxes;
+     *   - number of boxes:
+     *       INT N;
+     */
+    template<class Type>
+      aabb8( const aabb<Type> *Boxes, INT N )
+      {
+        FLT v[6][8];
+
+        for (INT i = 0; i < 8; i++)
+          for (INT k = 0; k < 3; k++)
+            if (i < N)
+            {
+              v[k][i] = RoundDown(Boxes[i].Min[k]);
+              v[3 + k][i] = RoundUp(Boxes[i].Max[k]);
+            }
+            else
+              v[k][i] = v[3 + k][i] = std::numeric_limits<FLT>::quiet_NaN();
+        Min = vec3x8(flt8::Load(v[0]), flt8::Load(v[1]), flt8::Load(v[2]));
+        Max = vec3x8(flt8::Load(v[3]), flt8::Load(v[4]), flt8::Load(v[5]));
+      } /* End of 'aabb8' function */
+
+    /* Round value down to float function.
+     * ARGUMENTS:
+     *   - value:
+     *       DBL X;
+     * RETURNS: (FLT) largest float not greater than X.
+     */
+    static FLT RoundDown( DBL X )
+    {
+      FLT f = (FLT)X;
+
+      return f > X ? nextafterf(f, -std::numeric_limits<FLT>::infinity()) : f;
+    } /* End of 'RoundDown' function */
+
+    /* Round value up to float function.
+     * ARGUMENTS:
+     *   - value:
+     *       DBL X;
+     * RETURNS: (FLT) smallest float not less than X.
+     */
+    static FLT RoundUp( DBL X )
+    {
+      FLT f = (FLT)X;
+
+      return f < X ? nextafterf(f, std::numeric_limits<FLT>::infinity()) : f;
+    } /* End of 'RoundUp' function */
+
+    /* Slab test of all eight boxes function.
+     * ARGUMENTS:
+     *   - prepared ray:
+     *       const inv_ray8 &R;
+     *   - maximal ray distance:
+     *       FLT TMax;
+     *   - result entry distances lanes (may be nullptr):
+     *       flt8 *TNear;
+     * RETURNS: (INT) bit i is set if ray segment [0, TMax) touches box i.
+     */
+    INT Intersect( const inv_ray8 &R, FLT TMax, flt8 *TNear = nullptr ) const
+    {
+      vec3x8
+        t0 = (Min - R.Org) * R.InvDir,
+        t1 = (Max - R.Org) * R.InvDir;
+      flt8
+        tn = t0.X.Min(t1.X).Max(t0.Y.Min(t1.Y)).Max(t0.Z.Min(t1.Z)),
+        tf = t0.X.Max(t1.X).Min(t0.Y.Max(t1.Y)).Min(t0.Z.Max(t1.Z));
+
+      if (TNear != nullptr)
+        *TNear = tn;
+      return ((tn <= tf) & (tf >= flt8(0)) & (tn < flt8(TMax))).MoveMask();
+    } /* End of 'Intersect' function */
+  }; /* End of 'aabb8' class */
+} /* end of 'mth' namespace */
+
+#endif /* __mth_aabb_h_ */
+
+/* END OF 'mth_aabb.h' FILE */
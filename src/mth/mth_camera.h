@@ -22,6 +22,8 @@
 #include "mth_vec3.h"
 #include "mth_matr.h"
 #include "mth_ray.h"
+#include "mth_frustum.h"
+#include "mth_ray_gen.h"
 
 /* Math library namespace */
 namespace mth
@@ -78,6 +80,12 @@ namespace mth
         Hp;             // projection y plane
       INT
         FrameW, FrameH; // Camera frame size
+      proj_type
+        ProjType = PROJ_PERSPECTIVE; // rays projection type
+      type
+        LensRadius = 0, // thin lens radius (0 for pinhole)
+        FocalDist = 1,  // distance to sharp plane along view direction
+        FisheyeFov = 180; // fisheye field of view in degrees
       matr<type>
         View,           // view matrix
         Proj,           // projection matrix
@@ -193,50 +201,111 @@ namespace mth
         SetLocAtUp(Loc, At, Up);
         return *this;
       } /* End of 'Move' function */
-      /* Obtain ray from camera and projection plane function.
+
+      /* Set projection type function.
        * ARGUMENTS:
-       *   - frame size in pixels:
-       *       INT FrameW, FrameH;
-       *   - frame pixel coordinates:
-       *       Type FrameX, FrameY;
+       *   - new projection type:
+       *       proj_type NewProjType;
+       *   - fisheye field of view in degrees:
+       *       type NewFisheyeFov;
        * RETURNS:
-       *   (ray<Type>) result ray from project plane in specified frame direction.
+       *   (camera &) self reference.
        */
-      mth::ray<type> Apply( INT FrameW, INT FrameH, type FrameX, type FrameY )
+      camera & SetProjType( proj_type NewProjType, type NewFisheyeFov = 180 )
       {
-        type ratio_x = Size, ratio_y = Size;
-
-        if (FrameW >= FrameH)
-          ratio_x *= (type)FrameW / FrameH;
-        else
-          ratio_y *= (type)FrameH / FrameW;
+        ProjType = NewProjType;
+        FisheyeFov = NewFisheyeFov;
+        return *this;
+      } /* End of 'SetProjType' function */
 
-        //ratio_x = Wp, ratio_y = Hp
-        vec3<type>
-          X = Dir * ProjDist +
-            Right * ((FrameX - FrameW / 2.0) / FrameW * ratio_x) +
-            Up * ((FrameH / 2.0 - FrameY) / FrameH * ratio_y);
+      /* Set thin lens parameters function.
+       * ARGUMENTS:
+       *   - lens radius (0 for pinhole):
+       *       type NewLensRadius;
+       *   - distance to sharp plane:
+       *       type NewFocalDist;
+       * RETURNS:
+       *   (camera &) self reference.
+       */
+      camera & SetLens( type NewLensRadius, type NewFocalDist )
+      {
+        LensRadius = NewLensRadius;
+        FocalDist = NewFocalDist;
+        return *this;
+      } /* End of 'SetLens' function */
 
-        return mth::ray<type>(Loc + X, X);
-      } /* End of 'Apply' function */
       /* Obtain ray from camera and projection plane function.
+       * Makes rays generator for one ray: per frame loops should make
+       * 'ray_gen' once and take rays from it.
        * ARGUMENTS:
        *   - frame pixel coordinates:
-       *       FLT Sx, FLT Sy;
+       *       DBL Sx, Sy;
        * RETURNS: (ray<type>) result ray.
        */
-      ray<type> FrameRay( DBL Sx, DBL Sy )
+      ray<type> FrameRay( DBL Sx, DBL Sy ) const
       {
-        ray<type> MyRay;
-
-        vec3<type> A = Dir * ProjDist;
-        vec3<type> B = Right * (Sx - FrameW / 2.0) * Wp / FrameW;
-        vec3<type> C = Up * (-Sy + FrameH / 2.0) * Hp / FrameH;
-        vec3<type> Q = (A + B) + C;
-        MyRay.Org = Loc + Q;
-        MyRay.Dir = Q.Normalizing();
-        return MyRay;
+        return ray_gen<type>(*this).Get(Sx, Sy);
       } /* End of 'FrameRay' function */
+
+      /* Obtain ray with differentials from camera and projection plane function.
+       * ARGUMENTS:
+       *   - frame pixel coordinates:
+       *       DBL Sx, Sy;
+       *   - ray derivatives per pixel (for output):
+       *       ray_diff<type> *Diff;
+       * RETURNS: (ray<type>) result ray.
+       */
+      ray<type> FrameRay( DBL Sx, DBL Sy, ray_diff<type> *Diff ) const
+      {
+        ray_gen<type> Gen(*this);
+
+        *Diff = Gen.Diff(Sx, Sy);
+        return Gen.Get(Sx, Sy);
+      } /* End of 'FrameRay' function */
+
+      /* Obtain frustum of frame rays function.
+       * Side planes go through camera location and frame corners directions,
+       * near plane is projection plane (frame rays start on it).
+       * Thin lens rays leave lens disk and cross frame rays at focal plane,
+       * so side planes are moved out by lens radius and tilted to pass
+       * lens edge and focal plane rectangle widened by lens radius.
+       * Orthographic frustum is a box, fisheye rays are not culled.
+       * ARGUMENTS: None.
+       * RETURNS: (frustum<type>) frustum containing all 'FrameRay' rays.
+       */
+      frustum<type> GetFrustum( VOID ) const
+      {
+        /* Frame is widened a bit, so rays through its border are kept */
+        type
+          A = ProjType == PROJ_PERSPECTIVE ? LensRadius : 0,
+          E = A * ProjDist / FocalDist;
+        vec3<type>
+          C = Dir * ProjDist,
+          R = Right * (Wp / 2 * 1.001 + E),
+          U = Up * (Hp / 2 * 1.001 + E),
+          Q[4] = {C - R + U, C + R + U, C + R - U, C - R - U},
+          Side[4] = {Up, Right, -Up, -Right};
+        frustum<type> F;
+
+        if (ProjType == PROJ_ORTHO)
+        {
+          type s = !(At - Loc) / ProjDist;
+
+          R = R * s, U = U * s;
+          return F.Add(Loc, Dir).Add(Loc - R, Right).Add(Loc + R, -Right).Add(Loc - U, Up).Add(Loc + U, -Up);
+        }
+        if (ProjType != PROJ_PERSPECTIVE)
+          return F;
+
+        F.Add(Loc + C * 0.999, Dir);
+        for (INT i = 0; i < 4; i++)
+        {
+          vec3<type> N = Q[i] % Q[(i + 1) % 4];
+
+          F.Add(Loc + Side[i] * A, (N & C) < 0 ? -N : N);
+        }
+        return F;
+      } /* End of 'GetFrustum' function */
     }; /* End of 'camera' class */
 } /* end of 'mth' namespace */
 
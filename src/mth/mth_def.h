@@ -55,32 +55,234 @@ namespace mth
       return Value < min ? min : Value > max ? max : Value;
     } /* End of 'Clamp' function */
 
-  template<class Type>
+  /* Random numbers generator class (PCG32, permuted congruential generator).
+   * Every render thread owns its generator (see 'Rng'), so generation is
+   * contention-free, and reseeding it by pixel makes results independent
+   * of threads number. */
+  class rnd
+  {
+  private:
+    UINT64 State, Inc; // generator state and stream selector (odd)
+
+  public:
+    /* Generator constructor.
+     * ARGUMENTS:
+     *   - seed and stream number:
+     *       UINT64 Seed, Stream;
+     */
+    rnd( UINT64 Seed = 0x853C49E6748FEA9BULL, UINT64 Stream = 0xDA3E39CB94B95BDBULL )
+    {
+      Set(Seed, Stream);
+    } /* End of 'rnd' function */
+
+    /* Reseed generator function.
+     * ARGUMENTS:
+     *   - seed and stream number:
+     *       UINT64 Seed, Stream;
+     * RETURNS: None.
+     */
+    VOID Set( UINT64 Seed, UINT64 Stream = 0xDA3E39CB94B95BDBULL )
+    {
+      State = 0;
+      Inc = (Stream << 1) | 1;
+      Next();
+      State += Seed;
+      Next();
+    } /* End of 'Set' function */
+
+    /* Get next 32 random bits function.
+     * ARGUMENTS: None.
+     * RETURNS: (UINT) result value.
+     */
+    UINT Next( VOID )
+    {
+      UINT64 Old = State;
+      UINT
+        xs = (UINT)(((Old >> 18) ^ Old) >> 27),
+        rot = (UINT)(Old >> 59);
+
+      State = Old * 6364136223846793005ULL + Inc;
+      return (xs >> rot) | (xs << ((32 - rot) & 31));
+    } /* End of 'Next' function */
+
+    /* Get next random number in [0, 1) function.
+     * ARGUMENTS: None.
+     * RETURNS: (DBL) result value.
+     */
+    DBL NextD( VOID )
+    {
+      return Next() * 2.3283064365386963e-10;
+    } /* End of 'NextD' function */
+  }; /* End of 'rnd' class */
+
+   /* Get current thread random numbers generator function.
+    * ARGUMENTS: None.
+    * RETURNS: (rnd &) thread generator.
+    */
+    inline rnd & Rng( VOID )
+    {
+      static thread_local rnd Generator;
+
+      return Generator;
+    } /* End of 'Rng' function */
+
+   /* Mix integer coordinates to well distributed 32 bits function.
+    * ARGUMENTS:
+    *   - values to be hashed:
+    *       UINT A, B, C;
+    * RETURNS: (UINT) hash value.
+    */
+    inline UINT Hash( UINT A, UINT B = 0, UINT C = 0 )
+    {
+      UINT h = A * 0x9E3779B9U ^ (B + 0x7F4A7C15U) * 0x85EBCA6BU ^ (C + 0x165667B1U) * 0xC2B2AE35U;
+
+      h ^= h >> 16;
+      h *= 0x7FEB352DU;
+      h ^= h >> 15;
+      h *= 0x846CA68BU;
+      h ^= h >> 16;
+      return h;
+    } /* End of 'Hash' function */
+
+  template<class Type = DBL>
    /* Get one random number between -1 and 1 function.
     * ARGUMENTS: None; 
     * RETURNS: (Type) result value.
     */
     static Type Rnd0( VOID )
     {
-      return 2.0 * rand() / RAND_MAX - 1;
+      return (Type)(2 * Rng().NextD() - 1);
     } /* End of 'Rnd0' function */
    /* Get one float random number between -1 and 1 function.
     * ARGUMENTS: None; 
     * RETURNS: (FLT) result value.
     */
-    static FLT Rnd0F( VOID )
+    inline FLT Rnd0F( VOID )
     {
-      return 2.0 * rand() / RAND_MAX - 1;
+      return (FLT)(2 * Rng().NextD() - 1);
     } /* End of 'Rnd0F' function */
-   /* Get one float random number between 0 and 1 function.
+   /* Get one float random number between 0 and 1 (exclusive) function.
     * ARGUMENTS: None; 
     * RETURNS: (FLT) result value.
     */
-    static FLT Rnd1F( VOID )
+    inline FLT Rnd1F( VOID )
     {
-      return 1.0 * rand() / RAND_MAX;
+      return (FLT)(Rng().Next() >> 8) * (1.0f / 16777216.0f);
     } /* End of 'Rnd1F' function */
 
+   /* Reverse bits order function.
+    * ARGUMENTS:
+    *   - value:
+    *       UINT I;
+    * RETURNS: (UINT) result value.
+    */
+    inline UINT ReverseBits( UINT I )
+    {
+      I = (I << 16) | (I >> 16);
+      I = ((I & 0x00FF00FF) << 8) | ((I & 0xFF00FF00) >> 8);
+      I = ((I & 0x0F0F0F0F) << 4) | ((I & 0xF0F0F0F0) >> 4);
+      I = ((I & 0x33333333) << 2) | ((I & 0xCCCCCCCC) >> 2);
+      return ((I & 0x55555555) << 1) | ((I & 0xAAAAAAAA) >> 1);
+    } /* End of 'ReverseBits' function */
+
+   /* Count set bits function.
+    * ARGUMENTS:
+    *   - value:
+    *       UINT I;
+    * RETURNS: (INT) number of set bits.
+    */
+    inline INT PopCount( UINT I )
+    {
+      I = I - ((I >> 1) & 0x55555555);
+      I = (I & 0x33333333) + ((I >> 2) & 0x33333333);
+      return (INT)((((I + (I >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24);
+    } /* End of 'PopCount' function */
+
+   /* Decode Morton (Z-order) curve index function.
+    * ARGUMENTS:
+    *   - curve index (X in even bits, Y in odd bits):
+    *       UINT D;
+    *   - result coordinates:
+    *       UINT *X, *Y;
+    * RETURNS: None.
+    */
+    inline VOID MortonDecode( UINT D, UINT *X, UINT *Y )
+    {
+      auto compact =
+        []( UINT V )
+        {
+          V &= 0x55555555;
+          V = (V | (V >> 1)) & 0x33333333;
+          V = (V | (V >> 2)) & 0x0F0F0F0F;
+          V = (V | (V >> 4)) & 0x00FF00FF;
+          return (V | (V >> 8)) & 0x0000FFFF;
+        };
+
+      *X = compact(D);
+      *Y = compact(D >> 1);
+    } /* End of 'MortonDecode' function */
+
+   /* Decode Hilbert curve index function.
+    * ARGUMENTS:
+    *   - curve side size (power of two):
+    *       UINT N;
+    *   - curve index in [0, N * N):
+    *       UINT D;
+    *   - result coordinates:
+    *       UINT *X, *Y;
+    * RETURNS: None.
+    */
+    inline VOID HilbertDecode( UINT N, UINT D, UINT *X, UINT *Y )
+    {
+      UINT x = 0, y = 0, t;
+
+      for (UINT s = 1; s < N; s *= 2, D /= 4)
+      {
+        UINT rx = 1 & (D / 2), ry = 1 & (D ^ rx);
+
+        /* Rotate quadrant */
+        if (ry == 0)
+        {
+          if (rx == 1)
+            x = s - 1 - x, y = s - 1 - y;
+          t = x, x = y, y = t;
+        }
+        x += s * rx;
+        y += s * ry;
+      }
+      *X = x;
+      *Y = y;
+    } /* End of 'HilbertDecode' function */
+
+   /* Get scrambled base 2 radical inverse (van der Corput) function.
+    * ARGUMENTS:
+    *   - sample index:
+    *       UINT I;
+    *   - random scramble bits:
+    *       UINT Scramble;
+    * RETURNS: (DBL) result value in [0, 1).
+    */
+    inline DBL VanDerCorput( UINT I, UINT Scramble = 0 )
+    {
+      return (ReverseBits(I) ^ Scramble) * 2.3283064365386963e-10;
+    } /* End of 'VanDerCorput' function */
+
+   /* Get scrambled second Sobol' dimension function.
+    * ARGUMENTS:
+    *   - sample index:
+    *       UINT I;
+    *   - random scramble bits:
+    *       UINT Scramble;
+    * RETURNS: (DBL) result value in [0, 1).
+    */
+    inline DBL Sobol2( UINT I, UINT Scramble = 0 )
+    {
+      for (UINT v = 1U << 31; I != 0; I >>= 1, v ^= v >> 1)
+        if (I & 1)
+          Scramble ^= v;
+      return Scramble * 2.3283064365386963e-10;
+    } /* End of 'Sobol2' function */
+
   template<class Type, class Type1>
    /* Linear interpolation between A and B values function.
     * ARGUMENTS:  
@@ -0,0 +1,79 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : mth_frustum.h
+ * PURPOSE     : Raytracing project.
+ *               Mathematics library.
+ *               View frustum handle module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'mth'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __mth_frustum_h_
+#define __mth_frustum_h_
+
+#include "mth_aabb.h"
+
+/* Math library namespace */
+namespace mth
+{
+  /* View frustum class.
+   * Convex volume bounded by planes (N & P) + D >= 0 inside. Far plane is
+   * never stored: traced rays are not clipped by distance. */
+  template<class Type>
+    class frustum
+    {
+    public:
+      static const INT MaxPlanes = 6; // maximal number of planes
+      vec3<Type> N[MaxPlanes];        // planes inner normals
+      Type D[MaxPlanes];              // planes offsets
+      INT NumOfPlanes = 0;            // number of planes
+
+      /* Add plane function.
+       * ARGUMENTS:
+       *   - point on plane:
+       *       const vec3<Type> &P;
+       *   - inner normal (not necessarily unit):
+       *       const vec3<Type> &Norm;
+       * RETURNS: (frustum &) self reference.
+       */
+      frustum & Add( const vec3<Type> &P, const vec3<Type> &Norm )
+      {
+        if (NumOfPlanes < MaxPlanes)
+        {
+          N[NumOfPlanes] = Norm;
+          D[NumOfPlanes++] = -(Norm & P);
+        }
+        return *this;
+      } /* End of 'Add' function */
+
+      /* Check if box may be visible function.
+       * Box is outside if its corner farthest along a plane normal is
+       * behind that plane (conservative: boxes near frustum edges pass).
+       * ARGUMENTS:
+       *   - box:
+       *       const aabb<Type> &B;
+       * RETURNS: (BOOL) FALSE if box is surely outside frustum.
+       */
+      BOOL IsVisible( const aabb<Type> &B ) const
+      {
+        vec3<Type> c = B.Center(), h = (B.Max - B.Min) * 0.5;
+
+        for (INT i = 0; i < NumOfPlanes; i++)
+          if ((N[i] & c) + D[i] + fabs(N[i][0]) * h[0] + fabs(N[i][1]) * h[1] + fabs(N[i][2]) * h[2] < 0)
+            return FALSE;
+        return TRUE;
+      } /* End of 'IsVisible' function */
+    }; /* End of 'frustum' class */
+} /* end of 'mth' namespace */
+
+#endif /* __mth_frustum_h_ */
+
+/* END OF 'mth_frustum.h' FILE */
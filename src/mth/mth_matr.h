@@ -9,7 +9,7 @@
  *                Matrices handle module.
  * PROGRAMMER   : CGSG-SummerCamp'2021.
  *                Ivan Dmitriev
- * LAST UPDATE  : 02.08.2021
+ * LAST UPDATE  : 08.08.2021
  * NOTE         : Module namespace 'mth'.
  * 
  * No part of this file may be changed without agreement of
@@ -89,7 +89,7 @@ namespace mth
        * ARGUMENTS: None.
        * RETURNS: None.
        */
-      matr( VOID ) : IsInverseEvaluated(FALSE), IsTransEn(FALSE)
+      matr( VOID ) noexcept : IsInverseEvaluated(FALSE), IsTransEn(FALSE)
       {
       } /* End of 'Constructor' function */
 
@@ -99,7 +99,7 @@ namespace mth
        *       R[4][4];
        * RETURNS: None.
        */
-      matr( Type1 R[4][4] ) : IsInverseEvaluated(FALSE), IsTransEn(FALSE)
+      matr( const Type1 R[4][4] ) noexcept : IsInverseEvaluated(FALSE), IsTransEn(FALSE)
       {
         memcpy(M, R, sizeof(M));
       } /* End of 'Constructor' function */
@@ -113,30 +113,16 @@ namespace mth
        *             a30, a31, a32, a33; 
        * RETURNS: (matr) result matrix.
        */
-      matr( Type1 a00, Type1 a01, Type1 a02, Type1 a03,
-            Type1 a10, Type1 a11, Type1 a12, Type1 a13,
-            Type1 a20, Type1 a21, Type1 a22, Type1 a23,
-            Type1 a30, Type1 a31, Type1 a32, Type1 a33) 
+      constexpr matr( Type1 a00, Type1 a01, Type1 a02, Type1 a03,
+                      Type1 a10, Type1 a11, Type1 a12, Type1 a13,
+                      Type1 a20, Type1 a21, Type1 a22, Type1 a23,
+                      Type1 a30, Type1 a31, Type1 a32, Type1 a33 ) noexcept :
+        M{{a00, a01, a02, a03},
+          {a10, a11, a12, a13},
+          {a20, a21, a22, a23},
+          {a30, a31, a32, a33}},
+        InvM{}, IsInverseEvaluated(FALSE), TransposeM{}, IsTransEn(FALSE)
       {
-        IsInverseEvaluated = FALSE;
-        IsTransEn = FALSE;
-        M[0][0] = a00;
-        M[0][1] = a01;
-        M[0][2] = a02;
-        M[0][3] = a03;
-        M[1][0] = a10;
-        M[1][1] = a11;
-        M[1][2] = a12;
-        M[1][3] = a13;
-        M[2][0] = a20;
-        M[2][1] = a21;
-        M[2][2] = a22;
-        M[2][3] = a23;
-        M[3][0] = a30;
-        M[3][1] = a31;
-        M[3][2] = a32;
-        M[3][3] = a33;
-        //InvM[0][0] = 0;
       } /* End of 'constructor' function */
 
       /* Constructor of matr class function.
@@ -161,7 +147,7 @@ namespace mth
        * ARGUMENTS: None.
        * RETURNS: (matr &) link on result matrix.
        */
-      static matr Identity( VOID )
+      static constexpr matr Identity( VOID ) noexcept
       {
         return matr(1, 0, 0, 0,
                     0, 1, 0, 0,
@@ -172,20 +158,17 @@ namespace mth
        * ARGUMENTS: None.
        * RETURNS: (matr &) link on result matrix.
        */
-      matr & toIdentity( VOID )
+      matr & toIdentity( VOID ) noexcept
       {
-        matr M(1, 0, 0, 0,
-               0, 1, 0, 0,
-               0, 0, 1, 0,
-               0, 0, 0, 1);
-        return M;
+        *this = Identity();
+        return *this;
       } /* End of 'Identity' function */
 
       /* Find determinator of matrix operator.
        * ARGUMENTS: None.
        * RETURNS: (Type) Result value.
        */
-      Type1 operator!( VOID )
+      Type1 operator!( VOID ) const noexcept
       {
          return Determ();
       } /* End of 'operator!' function */
@@ -194,7 +177,7 @@ namespace mth
        * ARGUMENTS: None.
        * RETURNS: None.
        */
-      VOID Inverse( VOID )  
+      VOID Inverse( VOID ) const noexcept
       {
         if (IsInverseEvaluated)
           return;
@@ -205,6 +188,7 @@ namespace mth
         if (det == 0)
         {
           memcpy(InvM, Identity().M, sizeof(Type1) * 16);
+          return;
         }
         /* build adjoint matrix */
         InvM[0][0] =
@@ -274,11 +258,41 @@ namespace mth
                          M[2][0], M[2][1], M[2][2]) / det;
       } /* End of 'Inverse' function */
 
+      /* Obtain inverse matrix function.
+       * ARGUMENTS: None.
+       * RETURNS: (matr) inverse matrix (identity for degenerate one).
+       */
+      matr Inversing( VOID ) const noexcept
+      {
+        Inverse();
+        return matr(InvM);
+      } /* End of 'Inversing' function */
+
+      /* Interpolate matrices elements function.
+       * Affine transforms are blended linearly, so transformed point moves
+       * along segment between its start and end positions.
+       * ARGUMENTS:
+       *   - start and end matrices:
+       *       const matr &A, &B;
+       *   - interpolation parameter in [0, 1]:
+       *       Type1 T;
+       * RETURNS: (matr) result matrix.
+       */
+      static matr Lerp( const matr &A, const matr &B, Type1 T ) noexcept
+      {
+        Type1 R[4][4];
+
+        for (INT i = 0; i < 4; i++)
+          for (INT j = 0; j < 4; j++)
+            R[i][j] = A.M[i][j] + (B.M[i][j] - A.M[i][j]) * T;
+        return matr(R);
+      } /* End of 'Lerp' function */
+
       /* Evaluate transpose matrix function.
        * ARGUMENTS: None.
        * RETURNS: None.
        */
-      VOID EvalTransMatr( VOID )
+      VOID EvalTransMatr( VOID ) const noexcept
       {
         if (this->IsTransEn)
           return;
@@ -293,7 +307,7 @@ namespace mth
        * ARGUMENTS: None.
        * RETURNS: (matr) transposed matrix
        */
-      matr Transpose( VOID )
+      matr Transpose( VOID ) const noexcept
       {
         EvalTransMatr();
         return TransposeM;
@@ -306,7 +320,7 @@ namespace mth
       } /* End of 'Transpose' function */
 
 
-      static matr Translate( vec3<Type1> T )
+      static constexpr matr Translate( const vec3<Type1> &T ) noexcept
       {
         return matr(1, 0, 0, 0,
                     0, 1, 0, 0,
@@ -318,7 +332,7 @@ namespace mth
        * ARGUMENTS: None.
        * RETURNS: (matr) result matrix.
        */
-      matr operator*( const matr &Matr )
+      matr operator*( const matr &Matr ) const noexcept
       {
         matr r; 
         INT k;
@@ -335,24 +349,16 @@ namespace mth
        * ARGUMENTS: None.
        * RETURNS: (matr) result matrix.
        */
-      matr operator*=( matr Matr )
+      matr & operator*=( const matr &Matr ) noexcept
       {
-        matr r; 
-        INT k;
-
-        for (INT i = 0; i < 4; i++)
-          for (INT j = 0; j < 4; j++)
-            for (r.M[i][j] = 0, k = 0; k < 4; k++)
-              r.M[i][j] += M[i][k] * Matr.M[k][j];
-
-        return r;
+        return *this = *this * Matr;
       } /* End of 'operator*' function */
 
       /* Pointer operator of matrix function.
        * ARGUMENTS: None.
        * RETURNS: (matr *) Result matrix.
        */
-      operator Type1*( VOID )
+      operator Type1*( VOID ) noexcept
       {
         return M[0];
       } /* End of 'Type1*' function */
@@ -361,7 +367,7 @@ namespace mth
        * ARGUMENTS: None.
        * RETURNS: (matr *) Result matrix.
        */
-      operator const Type1*( VOID ) const
+      operator const Type1*( VOID ) const noexcept
       {
         return M[0];
       } /* End of 'Type1*' function */
@@ -373,7 +379,7 @@ namespace mth
        * RETURNS:
        *   (matr) result matrix.
        */
-      static matr Scale( vec3<Type1> S )
+      static constexpr matr Scale( const vec3<Type1> &S ) noexcept
       {
         return matr(S.X, 0, 0, 0,
                     0, S.Y, 0, 0,
@@ -390,7 +396,7 @@ namespace mth
        * RETURNS:
        *   (matr) result matrix.
        */
-      static matr Rotate( vec3<Type1> V, Type1 AngleInDegree )
+      static matr Rotate( const vec3<Type1> &V, Type1 AngleInDegree ) noexcept
       {
         Type1 a = D2R(AngleInDegree), s = sin(a), c = cos(a);
         vec3<Type1> A = V.Normalizing();
@@ -408,7 +414,7 @@ namespace mth
        * RETURNS:
        *   (matr) result matrix.
        */
-      static matr RotateX( Type1 AngleInDegree )
+      static matr RotateX( Type1 AngleInDegree ) noexcept
       {
         Type1 a = D2R(AngleInDegree), s = sin(a), c = cos(a);
 
@@ -425,7 +431,7 @@ namespace mth
        * RETURNS:
        *   (matr) result matrix.
        */
-      static matr RotateY( Type1 AngleInDegree )
+      static matr RotateY( Type1 AngleInDegree ) noexcept
       {
         Type1 a = D2R(AngleInDegree), s = sin(a), c = cos(a);
 
@@ -442,7 +448,7 @@ namespace mth
        * RETURNS:
        *   (matr) result matrix.
        */
-      matr RotateZ( Type1 AngleInDegree )
+      static matr RotateZ( Type1 AngleInDegree ) noexcept
       {
         Type1 a = D2R(AngleInDegree), s = sin(a), c = cos(a);
         return matr(c, s, 0, 0,
@@ -458,7 +464,7 @@ namespace mth
        * RETURNS:
        *   (vec3<Type1>) result vector.
        */
-      vec3<Type1> TransformNormal( const vec3<Type1> &N ) const
+      vec3<Type1> TransformNormal( const vec3<Type1> &N ) const noexcept
       {
         Inverse();
         return vec3<Type1>(N.X * InvM[0][0] + N.Y * InvM[0][1] + N.Z * InvM[0][2],
@@ -473,7 +479,7 @@ namespace mth
        * RETURNS:
        *   (vec3<Type1>) result vector.
        */
-      vec3<Type1> TransformPoint( const vec3<Type1> V ) const
+      vec3<Type1> TransformPoint( const vec3<Type1> &V ) const noexcept
       {
         //type w = V.X * M[0][3] + V.Y * M[1][3] + V.Z * M[2][3] + V.X * M[3][3];
         return vec3<Type1>(V.X * M[0][0] + V.Y * M[1][0] + V.Z * M[2][0] + M[3][0],
@@ -488,7 +494,7 @@ namespace mth
        * RETURNS:
        *   (vec3<Type1>) result vector.
        */
-      vec3<Type1> TransformVector( const vec3<Type1> V ) const
+      vec3<Type1> TransformVector( const vec3<Type1> &V ) const noexcept
       {
         return vec3<Type1>(V.X * M[0][0] + V.Y * M[1][0] + V.Z * M[2][0],
                            V.X * M[0][1] + V.Y * M[1][1] + V.Z * M[2][1],
@@ -502,7 +508,7 @@ namespace mth
        * RETURNS:
        *   (vec3<Type1>) result vector.
        */
-      vec3<Type1> Transform4x4( const vec3<Type1> V ) const
+      vec3<Type1> Transform4x4( const vec3<Type1> &V ) const noexcept
       {
         Type1 w = V.X * M[0][3] + V.Y * M[1][3] + V.Z * M[2][3] + M[3][3];
 
@@ -521,7 +527,7 @@ namespace mth
       * RETURNS:
       *   (matr) result matrix.
       */
-      static matr View( vec3<Type1> &Loc, vec3<Type1> &At, vec3<Type1> &Up1 ) 
+      static matr View( const vec3<Type1> &Loc, const vec3<Type1> &At, const vec3<Type1> &Up1 ) noexcept
       {
         vec3<Type1> Dir, Up, Right;
 
@@ -552,7 +558,7 @@ namespace mth
        * RETURNS:
        *   (matr) result matrix.
        */
-      static matr Frustum( Type1 L, Type1 R, Type1 B, Type1 T, Type1 N, Type1 F ) 
+      static constexpr matr Frustum( Type1 L, Type1 R, Type1 B, Type1 T, Type1 N, Type1 F ) noexcept
       {
         return matr(2 * N / (R - L), 0, 0, 0,
                        0, 2 * N / (T - B), 0, 0,
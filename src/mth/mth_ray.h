@@ -9,7 +9,7 @@
  *                Space camera handle module.
  * PROGRAMMER   : CGSG-SummerCamp'2021.
  *                Ivan Dmitriev
- * LAST UPDATE  : 02.08.2021
+ * LAST UPDATE  : 08.08.2021
  * NOTE         : Module namespace 'mth'.
  *
  * No part of this file may be changed without agreement of
@@ -23,10 +23,14 @@
 #include "mth.h"
 
 #include <iostream>
+#include <limits>
 
  /* Math library namespace */
 namespace mth
 {
+  template<class Type> class aabb;
+  template<class Type> class inv_ray;
+
   /* 3D ray class declaration */
   template<class type>
     class ray
@@ -38,6 +42,9 @@ namespace mth
         Org, 
         /* Ray normalized direction */
         Dir; 
+      type
+        /* Ray time inside frame shutter interval [0, 1] (motion blur) */
+        Time = 0;
 
     public:
       /* Class default constructor */
@@ -50,7 +57,7 @@ namespace mth
        *   - ray to be copied:
        *       const ray &R;
        */
-      ray( const ray &R ) : Org(R.Org), Dir(R.Dir)
+      ray( const ray &R ) : Org(R.Org), Dir(R.Dir), Time(R.Time)
       {
       } /* End of 'ray' function */
 
@@ -60,11 +67,12 @@ namespace mth
        *       const vec3<type> &Origin, &Direction;
        *   - ray new Direction:
        *       const vec3<type> &Direction;
+       *   - ray time:
+       *       type NewTime;
        */
-      ray( const vec3<type> &Origin, const vec3<type> &Direction ) : 
-        Org(Origin), Dir(static_cast<vec3<type>>(Direction).Normalizing())
+      ray( const vec3<type> &Origin, const vec3<type> &Direction, type NewTime = 0 ) : 
+        Org(Origin), Dir(Direction.Normalizing()), Time(NewTime)
       {
-        //Dir.Normalize();
       } /* End of 'ray' function */
 
       /* Obtain ray point function.
@@ -139,55 +147,138 @@ namespace mth
 
       /* Check intersection between box and ray function.
        * ARGUMENTS:
-       *   - box borders:
-       *       vec3<type> min, max;
        *   - ray:
        *       const ray &r;
+       *   - box borders:
+       *       const vec3<type> &min, &max;
        * RETURNS:
        *   (BOOL) TRUE if ok, FALSE otherwise.
        */
-      BOOL BoxInter( const ray &r, vec3<type> min, vec3<type> max )
-      { 
-        FLT tmin = (min[0] - r.Org[0]) / r.Dir[0]; 
-        FLT tmax = (max[0] - r.Org[0]) / r.Dir[0]; 
- 
-        if (tmin > tmax) 
-          ;//mth::Swap(&tmin, &tmax); 
- 
-        FLT tymin = (min[1] - r.Org[1]) / r.Dir[1]; 
-        FLT tymax = (max[1] - r.Org[1]) / r.Dir[1]; 
- 
-        if (tymin > tymax) 
-          ;//mth::Swap(&tymin, &tymax); 
- 
-        if ((tmin > tymax) || (tymin > tmax)) 
-          return FALSE; 
- 
-        if (tymin > tmin) 
-            tmin = tymin; 
- 
-        if (tymax < tmax) 
-            tmax = tymax; 
- 
-        FLT tzmin = (min[2] - r.Org[2]) / r.Dir[2]; 
-        FLT tzmax = (max[2] - r.Org[2]) / r.Dir[2]; 
- 
-        if (tzmin > tzmax) 
-          ;//mth::Swap(&tzmin, &tzmax); 
- 
-        if ((tmin > tzmax) || (tzmin > tmax)) 
-            return FALSE; 
- 
-        if (tzmin > tmin) 
-            tmin = tzmin; 
- 
-        if (tzmax < tmax) 
-            tmax = tzmax; 
- 
-        return TRUE; 
+      static BOOL BoxInter( const ray &r, const vec3<type> &min, const vec3<type> &max )
+      {
+        return aabb<type>(min, max).Intersect(inv_ray<type>(r), std::numeric_limits<type>::infinity());
       } /* End of 'BoxInter' function */
     }; /* End of 'ray' class */
 
+  /* Ray differentials class.
+   * Keeps derivatives of ray origin and direction along frame X and Y
+   * (per pixel), so ray footprint can be followed through specular bounces
+   * (Igehy, "Tracing ray differentials"). Surfaces are locally flat here:
+   * normal derivatives are neglected. */
+  template<class type>
+    class ray_diff
+    {
+    public:
+      vec3<type>
+        DOdx, DOdy,  // origin derivatives
+        DDdx, DDdy;  // direction derivatives
+      BOOL IsValid;  // differentials are known flag (footprint is zero otherwise)
+
+      /* Class default constructor (unknown differentials) */
+      ray_diff( VOID ) : DOdx(0), DOdy(0), DDdx(0), DDdy(0), IsValid(FALSE)
+      {
+      } /* End of 'ray_diff' function */
+
+      /* Class constructor.
+       * ARGUMENTS:
+       *   - origin derivatives:
+       *       const vec3<type> &NDOdx, &NDOdy;
+       *   - direction derivatives:
+       *       const vec3<type> &NDDdx, &NDDdy;
+       */
+      ray_diff( const vec3<type> &NDOdx, const vec3<type> &NDOdy, const vec3<type> &NDDdx, const vec3<type> &NDDdy ) :
+        DOdx(NDOdx), DOdy(NDOdy), DDdx(NDDdx), DDdy(NDDdy), IsValid(TRUE)
+      {
+      } /* End of 'ray_diff' function */
+
+      /* Scale differentials function (for several samples per pixel).
+       * ARGUMENTS:
+       *   - scale:
+       *       type S;
+       * RETURNS: (ray_diff) scaled differentials.
+       */
+      ray_diff Scale( type S ) const
+      {
+        if (!IsValid)
+          return *this;
+        return ray_diff(DOdx * S, DOdy * S, DDdx * S, DDdy * S);
+      } /* End of 'Scale' function */
+
+      /* Transfer differentials to surface point function.
+       * Result origin derivatives are hit point derivatives on surface tangent plane.
+       * ARGUMENTS:
+       *   - ray:
+       *       const ray<type> &R;
+       *   - hit distance:
+       *       type T;
+       *   - surface normal:
+       *       const vec3<type> &N;
+       * RETURNS: (ray_diff) differentials of ray restarted at hit point.
+       */
+      ray_diff Transfer( const ray<type> &R, type T, const vec3<type> &N ) const
+      {
+        type dn = R.Dir & N;
+
+        if (!IsValid || dn == 0)
+          return ray_diff();
+
+        vec3<type>
+          px = DOdx + DDdx * T,
+          py = DOdy + DDdy * T;
+
+        return ray_diff(px - R.Dir * ((px & N) / dn), py - R.Dir * ((py & N) / dn), DDdx, DDdy);
+      } /* End of 'Transfer' function */
+
+      /* Reflect differentials function.
+       * ARGUMENTS:
+       *   - incoming ray (differentials are already transferred to its hit):
+       *       const ray<type> &R;
+       *   - surface normal:
+       *       const vec3<type> &N;
+       * RETURNS: (ray_diff) reflected ray differentials.
+       */
+      ray_diff Reflect( const ray<type> &R, const vec3<type> &N ) const
+      {
+        if (!IsValid)
+          return *this;
+        return ray_diff(DOdx, DOdy, DDdx - N * (2 * (DDdx & N)), DDdy - N * (2 * (DDdy & N)));
+      } /* End of 'Reflect' function */
+
+      /* Refract differentials function.
+       * Transmitted direction is Eta * D + Mu * N with Mu = -Eta * (D, N) - cos(t),
+       * so its derivative is Eta * dD + dMu * N, dMu = -(Eta + Eta^2 (D, N) / cos(t)) (dD, N).
+       * ARGUMENTS:
+       *   - incoming ray (differentials are already transferred to its hit):
+       *       const ray<type> &R;
+       *   - surface normal (facing incoming ray):
+       *       const vec3<type> &N;
+       *   - transmitted direction:
+       *       const vec3<type> &T;
+       *   - relative index of refraction (incoming to transmitted media):
+       *       type Eta;
+       * RETURNS: (ray_diff) transmitted ray differentials.
+       */
+      ray_diff Refract( const ray<type> &R, const vec3<type> &N, const vec3<type> &T, type Eta ) const
+      {
+        type cost = -(T & N);
+
+        if (!IsValid || cost <= 0)
+          return ray_diff();
+
+        type k = -(Eta + Eta * Eta * (R.Dir & N) / cost);
+
+        return ray_diff(DOdx, DOdy, DDdx * Eta + N * (k * (DDdx & N)), DDdy * Eta + N * (k * (DDdy & N)));
+      } /* End of 'Refract' function */
+
+      /* Obtain footprint size function.
+       * ARGUMENTS: None.
+       * RETURNS: (type) larger of origin derivatives lengths (0 if unknown).
+       */
+      type Footprint( VOID ) const
+      {
+        return IsValid ? mth::Max(!DOdx, !DOdy) : 0;
+      } /* End of 'Footprint' function */
+    }; /* End of 'ray_diff' class */
 } /* end of 'mth' namespace */
 
 #endif /* __mth_ray_h_ */
@@ -0,0 +1,336 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : mth_ray_gen.h
+ * PURPOSE     : Raytracing project.
+ *               Mathematics library.
+ *               Camera rays generator module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'mth'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __mth_ray_gen_h_
+#define __mth_ray_gen_h_
+
+#include "mth_vec3x8.h"
+#include "mth_ray.h"
+
+/* Math library namespace */
+namespace mth
+{
+  /* Camera projection types */
+  enum proj_type
+  {
+    PROJ_PERSPECTIVE, // pinhole (or thin lens) perspective
+    PROJ_ORTHO,       // parallel rays, frame covers pivot point plane
+    PROJ_FISHEYE      // equidistant fisheye, field of view across smaller frame side
+  }; /* End of 'proj_type' enumeration */
+
+  template<class type>
+    class camera;
+
+  /* Camera rays generator class.
+   * Made once per frame from camera: basis is scaled to per pixel deltas,
+   * so frame point of pixel (X, Y) is Corner + DX * X + DY * Y and rows
+   * are stepped by one addition per ray. Generator of moving camera keeps
+   * basis at shutter close too and blends both at ray time. */
+  template<class type>
+    class ray_gen
+    {
+    private:
+      proj_type Proj;            // projection type
+      vec3<type>
+        Loc, Dir, Right, Up,     // camera location and basis
+        Corner,                  // frame point of pixel (0, 0) corner (relative to origin base)
+        DX, DY;                  // frame point deltas per pixel
+      vec3<type>
+        EndLoc, EndDir, EndRight, EndUp, // camera location and basis at shutter close
+        EndCorner, EndDX, EndDY;         // frame point and deltas at shutter close
+      BOOL IsMoving = FALSE;             // basis changes during shutter interval flag
+      type
+        LensRadius,              // thin lens radius (0 for pinhole)
+        FocalDist,               // distance to sharp plane
+        FocusRatio,              // focal distance to projection distance ratio
+        CocScale,                // circle of confusion radius in pixels at zero depth
+        AngleScale,              // fisheye angle per pixel from frame center
+        CenterX, CenterY;        // frame center in pixels
+
+      /* Convert vector to float one function.
+       * ARGUMENTS:
+       *   - vector:
+       *       const vec3<type> &V;
+       * RETURNS: (vec3<FLT>) result vector.
+       */
+      static vec3<FLT> Flt( const vec3<type> &V )
+      {
+        return vec3<FLT>((FLT)V[0], (FLT)V[1], (FLT)V[2]);
+      } /* End of 'Flt' function */
+
+      /* Make ray of already normalized direction function.
+       * ARGUMENTS:
+       *   - ray origin and unit direction:
+       *       const vec3<type> &Org, &Dir;
+       * RETURNS: (ray<type>) result ray.
+       */
+      static ray<type> Make( const vec3<type> &Org, const vec3<type> &Dir, type Time = 0 )
+      {
+        ray<type> R;
+
+        R.Org = Org;
+        R.Dir = Dir;
+        R.Time = Time;
+        return R;
+      } /* End of 'Make' function */
+
+      /* Obtain not moving generator at time function.
+       * Basis is blended linearly (and renormalized), so camera motion during
+       * one frame is assumed to be small.
+       * ARGUMENTS:
+       *   - time in shutter interval [0, 1]:
+       *       type T;
+       * RETURNS: (ray_gen) generator with blended basis.
+       */
+      ray_gen At( type T ) const
+      {
+        ray_gen G = *this;
+
+        G.IsMoving = FALSE;
+        G.Loc = Loc + (EndLoc - Loc) * T;
+        G.Dir = (Dir + (EndDir - Dir) * T).Normalizing();
+        G.Right = (Right + (EndRight - Right) * T).Normalizing();
+        G.Up = (Up + (EndUp - Up) * T).Normalizing();
+        G.Corner = Corner + (EndCorner - Corner) * T;
+        G.DX = DX + (EndDX - DX) * T;
+        G.DY = DY + (EndDY - DY) * T;
+        return G;
+      } /* End of 'At' function */
+
+    public:
+      /* Constructor of ray_gen class function.
+       * ARGUMENTS:
+       *   - camera:
+       *       const camera<type> &Cam;
+       */
+      ray_gen( const camera<type> &Cam ) :
+        Proj(Cam.ProjType), Loc(Cam.Loc), Dir(Cam.Dir), Right(Cam.Right), Up(Cam.Up),
+        LensRadius(Cam.LensRadius), FocalDist(Cam.FocalDist), FocusRatio(Cam.FocalDist / Cam.ProjDist),
+        CocScale(Cam.LensRadius * Cam.ProjDist * Cam.FrameW / Cam.Wp),
+        AngleScale(Cam.FisheyeFov * (type)PI / 180 / mth::Min(Cam.FrameW, Cam.FrameH)),
+        CenterX(Cam.FrameW / (type)2), CenterY(Cam.FrameH / (type)2)
+      {
+        if (Proj == PROJ_ORTHO)
+        {
+          /* Projection plane is scaled to pivot point distance */
+          type s = !(Cam.At - Cam.Loc) / Cam.ProjDist;
+
+          DX = Right * (Cam.Wp * s / Cam.FrameW);
+          DY = Up * (-Cam.Hp * s / Cam.FrameH);
+          Corner = DX * -CenterX + DY * -CenterY;
+        }
+        else
+        {
+          DX = Right * (Cam.Wp / Cam.FrameW);
+          DY = Up * (-Cam.Hp / Cam.FrameH);
+          Corner = Dir * Cam.ProjDist + DX * -CenterX + DY * -CenterY;
+        }
+      } /* End of 'ray_gen' function */
+
+      /* Constructor of ray_gen class function (moving camera).
+       * Projection parameters are taken from shutter open camera.
+       * ARGUMENTS:
+       *   - camera at shutter open and close:
+       *       const camera<type> &Cam, &CamEnd;
+       */
+      ray_gen( const camera<type> &Cam, const camera<type> &CamEnd ) : ray_gen(Cam)
+      {
+        ray_gen E(CamEnd);
+
+        EndLoc = E.Loc, EndDir = E.Dir, EndRight = E.Right, EndUp = E.Up;
+        EndCorner = E.Corner, EndDX = E.DX, EndDY = E.DY;
+        IsMoving = (EndLoc - Loc).Length2() > 0 || (EndCorner - Corner).Length2() > 0 ||
+                   (EndDX - DX).Length2() > 0 || (EndDY - DY).Length2() > 0;
+      } /* End of 'ray_gen' function */
+
+      /* Check if camera moves during shutter interval function.
+       * ARGUMENTS: None.
+       * RETURNS: (BOOL) TRUE if rays depend on time.
+       */
+      BOOL IsMotion( VOID ) const
+      {
+        return IsMoving;
+      } /* End of 'IsMotion' function */
+
+      /* Check if rays of row can be stepped incrementally function.
+       * ARGUMENTS: None.
+       * RETURNS: (BOOL) TRUE for pinhole perspective and orthographic projections.
+       */
+      BOOL IsLinear( VOID ) const
+      {
+        return Proj == PROJ_ORTHO || (Proj == PROJ_PERSPECTIVE && LensRadius == 0);
+      } /* End of 'IsLinear' function */
+
+      /* Check if rays go through lens (depth of field) function.
+       * ARGUMENTS: None.
+       * RETURNS: (BOOL) TRUE for thin lens perspective projection.
+       */
+      BOOL IsLens( VOID ) const
+      {
+        return Proj == PROJ_PERSPECTIVE && LensRadius > 0;
+      } /* End of 'IsLens' function */
+
+      /* Check if point at depth is in focus function.
+       * Lens rays of pixel spread from focus point, point image (circle of
+       * confusion) radius is LensRadius * |Depth - Focal| / Focal * ProjDist / Depth.
+       * ARGUMENTS:
+       *   - point distance along view direction:
+       *       type Depth;
+       *   - maximal circle of confusion radius in pixels:
+       *       type MaxRadius;
+       * RETURNS: (BOOL) TRUE if point image is not larger than MaxRadius.
+       */
+      BOOL IsInFocus( type Depth, type MaxRadius = 0.5 ) const
+      {
+        if (!IsLens())
+          return TRUE;
+        if (Depth <= 0)
+          return FALSE;
+        return CocScale * fabs(Depth - FocalDist) / (FocalDist * Depth) <= MaxRadius;
+      } /* End of 'IsInFocus' function */
+
+      /* Obtain depth of point function.
+       * ARGUMENTS:
+       *   - point:
+       *       const vec3<type> &P;
+       * RETURNS: (type) point distance from camera along view direction.
+       */
+      type Depth( const vec3<type> &P ) const
+      {
+        return (P - Loc) & Dir;
+      } /* End of 'Depth' function */
+
+      /* Obtain ray of frame point function.
+       * ARGUMENTS:
+       *   - frame point coordinates in pixels:
+       *       type Sx, Sy;
+       *   - lens sample in [0, 1) square (thin lens only):
+       *       type Lu, Lv;
+       *   - ray time in shutter interval [0, 1]:
+       *       type Time;
+       * RETURNS: (ray<type>) result ray.
+       */
+      ray<type> Get( type Sx, type Sy, type Lu = 0.5, type Lv = 0.5, type Time = 0 ) const
+      {
+        if (IsMoving)
+          return At(Time).Get(Sx, Sy, Lu, Lv, Time);
+
+        vec3<type> Q = Corner + DX * Sx + DY * Sy;
+
+        if (Proj == PROJ_ORTHO)
+          return Make(Loc + Q, Dir, Time);
+        if (Proj == PROJ_FISHEYE)
+        {
+          /* Equidistant mapping: angle to view direction grows linearly from center */
+          type
+            x = Sx - CenterX, y = CenterY - Sy, r = sqrt(x * x + y * y),
+            theta = r * AngleScale, s = r > 0 ? sin(theta) / r : 0;
+
+          return Make(Loc, Dir * cos(theta) + Right * (x * s) + Up * (y * s), Time);
+        }
+        if (LensRadius > 0)
+        {
+          /* Lens point on concentric disk, ray goes through pinhole ray focus point */
+          type a = 2 * Lu - 1, b = 2 * Lv - 1, r, phi;
+
+          if (a == 0 && b == 0)
+            r = phi = 0;
+          else if (a * a > b * b)
+            r = a, phi = (type)PI / 4 * (b / a);
+          else
+            r = b, phi = (type)PI / 2 - (type)PI / 4 * (a / b);
+          vec3<type>
+            L = (Right * cos(phi) + Up * sin(phi)) * (r * LensRadius),
+            F = Q * FocusRatio - L;
+
+          /* Origin is moved to projection plane as pinhole rays' one */
+          return Make(Loc + L + F / FocusRatio, F.Normalizing(), Time);
+        }
+        return Make(Loc + Q, Q.Normalizing(), Time);
+      } /* End of 'Get' function */
+
+      /* Obtain ray differentials of frame point function.
+       * Neighbour pixels' rays through lens center are differenced, so all
+       * projections are handled alike; lens samples are not differentiated.
+       * ARGUMENTS:
+       *   - frame point coordinates in pixels:
+       *       type Sx, Sy;
+       *   - ray time in shutter interval [0, 1]:
+       *       type Time;
+       * RETURNS: (ray_diff<type>) ray derivatives per pixel.
+       */
+      ray_diff<type> Diff( type Sx, type Sy, type Time = 0 ) const
+      {
+        ray<type>
+          R = Get(Sx, Sy, 0.5, 0.5, Time),
+          Rx = Get(Sx + 1, Sy, 0.5, 0.5, Time),
+          Ry = Get(Sx, Sy + 1, 0.5, 0.5, Time);
+
+        return ray_diff<type>(Rx.Org - R.Org, Ry.Org - R.Org, Rx.Dir - R.Dir, Ry.Dir - R.Dir);
+      } /* End of 'Diff' function */
+
+      /* Obtain pixel centers rays of row function (at shutter open).
+       * ARGUMENTS:
+       *   - row index:
+       *       INT Y;
+       *   - pixels range:
+       *       INT X0, X1;
+       *   - rays array to be filled (X1 - X0 rays):
+       *       ray<type> *Rays;
+       * RETURNS: None.
+       */
+      VOID Row( INT Y, INT X0, INT X1, ray<type> *Rays ) const
+      {
+        if (!IsLinear())
+        {
+          for (INT x = X0; x < X1; x++)
+            *Rays++ = Get(x + (type)0.5, Y + (type)0.5);
+          return;
+        }
+
+        vec3<type> Q = Corner + DX * (X0 + (type)0.5) + DY * (Y + (type)0.5);
+
+        for (INT x = X0; x < X1; x++, Q += DX)
+          *Rays++ = Proj == PROJ_ORTHO ? Make(Loc + Q, Dir) : Make(Loc + Q, Q.Normalizing());
+      } /* End of 'Row' function */
+
+      /* Obtain eight pixel centers rays batch function (at shutter open).
+       * Only for incrementally stepped projections ('IsLinear').
+       * ARGUMENTS:
+       *   - first pixel coordinates (batch goes along row):
+       *       INT X, Y;
+       *   - rays origins and directions to be stored:
+       *       vec3x8 *Org, *Dirs;
+       * RETURNS: None.
+       */
+      VOID Row8( INT X, INT Y, vec3x8 *Org, vec3x8 *Dirs ) const
+      {
+        static const FLT Lanes[8] = {0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f};
+        flt8 i = flt8::Load(Lanes) + flt8((FLT)X);
+        vec3x8
+          Q = vec3x8(Flt(Corner + DY * (Y + (type)0.5))) + vec3x8(Flt(DX)) * i;
+
+        *Org = vec3x8(Flt(Loc)) + Q;
+        *Dirs = Proj == PROJ_ORTHO ? vec3x8(Flt(Dir)) : Q.Normalizing();
+      } /* End of 'Row8' function */
+    }; /* End of 'ray_gen' class */
+} /* end of 'mth' namespace */
+
+#endif /* __mth_ray_gen_h_ */
+
+/* END OF 'mth_ray_gen.h' FILE */
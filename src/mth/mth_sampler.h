@@ -0,0 +1,250 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME    : mth_sampler.h
+ * PURPOSE      : Raytracing project.
+ *                Mathematics library.
+ *                Pixel samples generators handle module.
+ * PROGRAMMER   : CGSG-SummerCamp'2021.
+ *                Ivan Dmitriev
+ * LAST UPDATE  : 07.08.2021
+ * NOTE         : Module namespace 'mth'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __mth_sampler_h_
+#define __mth_sampler_h_
+
+#include "mth_def.h"
+
+/* Math library namespace */
+namespace mth
+{
+  /* Sample sequences types */
+  enum sampler_type
+  {
+    SAMPLER_RANDOM,    // independent PCG random numbers
+    SAMPLER_SOBOL,     // Owen scrambled Sobol' (0, 2)-sequence, padded by dimensions
+    SAMPLER_HALTON,    // Halton sequence with per-pixel Cranley-Patterson rotation
+    SAMPLER_BLUE_NOISE // same Sobol' points in every pixel, rotated by screen space blue noise mask
+  }; /* End of 'sampler_type' enumeration */
+
+  /* Pixel samples generator class.
+   * Sample values depend only on pixel coordinates, sample index, dimension
+   * and seed, so images are reproducible for any threads number and order.
+   * Usage: 'Start' sample of pixel, then take 'Get1D'/'Get2D' values in the
+   * same order for every sample. */
+  class sampler
+  {
+  private:
+    sampler_type Type;     // sequence type
+    UINT Seed;             // frame seed
+    UINT PixelX, PixelY;   // current pixel
+    UINT PixelHash;        // current pixel scramble bits
+    UINT Index;            // current sample index
+    UINT Dim;              // next dimension
+    rnd Gen;               // random numbers generator
+
+    /* Nested uniform (Owen) scramble of bits function.
+     * Laine-Karras hash is applied to reversed bits, so every bit is
+     * flipped depending on more significant bits only.
+     * ARGUMENTS:
+     *   - bits to be scrambled:
+     *       UINT X;
+     *   - scramble seed:
+     *       UINT S;
+     * RETURNS: (UINT) scrambled bits.
+     */
+    static UINT Owen( UINT X, UINT S )
+    {
+      X = ReverseBits(X);
+      X += S;
+      X ^= X * 0x6C50B47CU;
+      X ^= X * 0xB82F1E52U;
+      X ^= X * 0xC7AFE638U;
+      X ^= X * 0x8D22F6E6U;
+      return ReverseBits(X);
+    } /* End of 'Owen' function */
+
+    /* Radical inverse function.
+     * ARGUMENTS:
+     *   - number:
+     *       UINT I;
+     *   - base:
+     *       UINT Base;
+     * RETURNS: (DBL) result value in [0, 1).
+     */
+    static DBL RadicalInverse( UINT I, UINT Base )
+    {
+      DBL inv = 1.0 / Base, f = inv, r = 0;
+
+      for (; I > 0; I /= Base, f *= inv)
+        r += (I % Base) * f;
+      return r;
+    } /* End of 'RadicalInverse' function */
+
+    /* Get fractional part function.
+     * ARGUMENTS:
+     *   - value:
+     *       DBL X;
+     * RETURNS: (DBL) result value in [0, 1).
+     */
+    static DBL Frac( DBL X )
+    {
+      X -= floor(X);
+      return X < 1 ? X : 0;
+    } /* End of 'Frac' function */
+
+    /* Get Sobol' point coordinates function.
+     * ARGUMENTS:
+     *   - dimension (pair start for 2D):
+     *       UINT D;
+     *   - scramble bits (same for all pixels for blue noise sampler):
+     *       UINT S;
+     *   - result coordinates (V may be nullptr for 1D):
+     *       DBL *U, *V;
+     * RETURNS: None.
+     */
+    VOID Sobol( UINT D, UINT S, DBL *U, DBL *V )
+    {
+      UINT i = Owen(Index, Hash(S, D, 0));
+
+      *U = Owen(ReverseBits(i), Hash(S, D, 1)) * 2.3283064365386963e-10;
+      if (V != nullptr)
+        *V = Owen((UINT)(Sobol2(i) * 4294967296.0), Hash(S, D, 2)) * 2.3283064365386963e-10;
+    } /* End of 'Sobol' function */
+
+    /* Get blue noise mask value function (interleaved gradient noise).
+     * ARGUMENTS:
+     *   - dimension:
+     *       UINT D;
+     * RETURNS: (DBL) result value in [0, 1).
+     */
+    DBL Mask( UINT D )
+    {
+      DBL
+        x = PixelX + 5.588238 * D,
+        y = PixelY + 5.588238 * D;
+
+      return Frac(52.9829189 * Frac(0.06711056 * x + 0.00583715 * y));
+    } /* End of 'Mask' function */
+
+    /* Get Halton sequence coordinate function.
+     * Dimensions past primes table get hashed random values: reused bases
+     * would correlate coordinates of deep path vertices.
+     * ARGUMENTS:
+     *   - dimension:
+     *       UINT D;
+     * RETURNS: (DBL) result value in [0, 1).
+     */
+    DBL Halton( UINT D )
+    {
+      static const UINT Primes[] =
+      {
+        2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53,
+        59, 61, 67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131,
+        137, 139, 149, 151, 157, 163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223,
+        227, 229, 233, 239, 241, 251, 257, 263, 269, 271, 277, 281, 283, 293, 307, 311
+      };
+      const UINT N = sizeof(Primes) / sizeof(Primes[0]);
+
+      if (D >= N)
+        return Hash(PixelHash, D, Index) * 2.3283064365386963e-10;
+      return Frac(RadicalInverse(Index, Primes[D]) + Hash(PixelHash, D) * 2.3283064365386963e-10);
+    } /* End of 'Halton' function */
+
+  public:
+    /* Sampler constructor.
+     * ARGUMENTS:
+     *   - sequence type:
+     *       sampler_type NType;
+     *   - frame seed:
+     *       UINT NSeed;
+     */
+    sampler( sampler_type NType = SAMPLER_SOBOL, UINT NSeed = 0 ) :
+      Type(NType), Seed(NSeed), PixelX(0), PixelY(0), PixelHash(0), Index(0), Dim(0)
+    {
+    } /* End of 'sampler' function */
+
+    /* Start pixel sample function.
+     * ARGUMENTS:
+     *   - pixel coordinates:
+     *       UINT X, Y;
+     *   - sample index in pixel:
+     *       UINT SampleIndex;
+     * RETURNS: None.
+     */
+    VOID Start( UINT X, UINT Y, UINT SampleIndex )
+    {
+      PixelX = X;
+      PixelY = Y;
+      PixelHash = Hash(X, Y, Seed);
+      Index = SampleIndex;
+      Dim = 0;
+      Gen.Set(PixelHash, SampleIndex);
+    } /* End of 'Start' function */
+
+    /* Get next sample dimension function.
+     * ARGUMENTS: None.
+     * RETURNS: (DBL) result value in [0, 1).
+     */
+    DBL Get1D( VOID )
+    {
+      UINT d = Dim++;
+      DBL u;
+
+      switch (Type)
+      {
+      case SAMPLER_SOBOL:
+        Sobol(d, PixelHash, &u, nullptr);
+        return u;
+      case SAMPLER_HALTON:
+        return Halton(d);
+      case SAMPLER_BLUE_NOISE:
+        Sobol(d, Seed, &u, nullptr);
+        return Frac(u + Mask(d));
+      default:
+        return Gen.NextD();
+      }
+    } /* End of 'Get1D' function */
+
+    /* Get next two sample dimensions function.
+     * ARGUMENTS:
+     *   - result values in [0, 1):
+     *       DBL *U, *V;
+     * RETURNS: None.
+     */
+    VOID Get2D( DBL *U, DBL *V )
+    {
+      UINT d = Dim;
+
+      Dim += 2;
+      switch (Type)
+      {
+      case SAMPLER_SOBOL:
+        Sobol(d, PixelHash, U, V);
+        break;
+      case SAMPLER_HALTON:
+        *U = Halton(d);
+        *V = Halton(d + 1);
+        break;
+      case SAMPLER_BLUE_NOISE:
+        Sobol(d, Seed, U, V);
+        *U = Frac(*U + Mask(d));
+        *V = Frac(*V + Mask(d + 1));
+        break;
+      default:
+        *U = Gen.NextD();
+        *V = Gen.NextD();
+      }
+    } /* End of 'Get2D' function */
+  }; /* End of 'sampler' class */
+} /* end of 'mth' namespace */
+
+#endif /* __mth_sampler_h_ */
+
+/* END OF 'mth_sampler.h' FILE */
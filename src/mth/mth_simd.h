@@ -0,0 +1,400 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : mth_simd.h
+ * PURPOSE     : Raytracing project.
+ *               Mathematics library.
+ *               Four lanes vector kernels (SSE/AVX) handle module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'mth'.
+ *               Define MTH_NO_SIMD to build scalar code only.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __mth_simd_h_
+#define __mth_simd_h_
+
+#include "mth_def.h"
+
+#ifndef MTH_NO_SIMD
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define MTH_SSE
+#    include <emmintrin.h>
+#  endif
+#  if defined(__AVX__)
+#    define MTH_AVX
+#    include <immintrin.h>
+#  endif
+#endif /* MTH_NO_SIMD */
+
+namespace mth
+{
+  /* Scalar four lanes kernels.
+   * Vectors are arrays of four values, vec3 keeps zero in fourth lane.
+   * Pointers may be unaligned and result may alias arguments. */
+  template<class Type>
+    struct lanes4_scalar
+    {
+      /* Sum of vectors function.
+       * ARGUMENTS:
+       *   - vectors:
+       *       const Type *A, *B;
+       *   - result vector:
+       *       Type *R;
+       * RETURNS: None.
+       */
+      static VOID Add( const Type *A, const Type *B, Type *R )
+      {
+        for (INT i = 0; i < 4; i++)
+          R[i] = A[i] + B[i];
+      } /* End of 'Add' function */
+
+      /* Difference of vectors function.
+       * ARGUMENTS:
+       *   - vectors:
+       *       const Type *A, *B;
+       *   - result vector:
+       *       Type *R;
+       * RETURNS: None.
+       */
+      static VOID Sub( const Type *A, const Type *B, Type *R )
+      {
+        for (INT i = 0; i < 4; i++)
+          R[i] = A[i] - B[i];
+      } /* End of 'Sub' function */
+
+      /* Per component product of vectors function.
+       * ARGUMENTS:
+       *   - vectors:
+       *       const Type *A, *B;
+       *   - result vector:
+       *       Type *R;
+       * RETURNS: None.
+       */
+      static VOID Mul( const Type *A, const Type *B, Type *R )
+      {
+        for (INT i = 0; i < 4; i++)
+          R[i] = A[i] * B[i];
+      } /* End of 'Mul' function */
+
+      /* Per component quotient of vectors function.
+       * ARGUMENTS:
+       *   - vectors:
+       *       const Type *A, *B;
+       *   - result vector:
+       *       Type *R;
+       * RETURNS: None.
+       */
+      static VOID Div( const Type *A, const Type *B, Type *R )
+      {
+        for (INT i = 0; i < 4; i++)
+          R[i] = A[i] / B[i];
+      } /* End of 'Div' function */
+
+      /* Multiply vector by number function.
+       * ARGUMENTS:
+       *   - vector:
+       *       const Type *A;
+       *   - number:
+       *       Type N;
+       *   - result vector:
+       *       Type *R;
+       * RETURNS: None.
+       */
+      static VOID MulN( const Type *A, Type N, Type *R )
+      {
+        for (INT i = 0; i < 4; i++)
+          R[i] = A[i] * N;
+      } /* End of 'MulN' function */
+
+      /* Add number to first three lanes function.
+       * ARGUMENTS:
+       *   - vector:
+       *       const Type *A;
+       *   - number:
+       *       Type N;
+       *   - result vector:
+       *       Type *R;
+       * RETURNS: None.
+       */
+      static VOID AddN3( const Type *A, Type N, Type *R )
+      {
+        for (INT i = 0; i < 3; i++)
+          R[i] = A[i] + N;
+        R[3] = A[3];
+      } /* End of 'AddN3' function */
+
+      /* Per component minimum function.
+       * ARGUMENTS:
+       *   - vectors:
+       *       const Type *A, *B;
+       *   - result vector:
+       *       Type *R;
+       * RETURNS: None.
+       */
+      static VOID Min( const Type *A, const Type *B, Type *R )
+      {
+        for (INT i = 0; i < 4; i++)
+          R[i] = A[i] > B[i] ? B[i] : A[i];
+      } /* End of 'Min' function */
+
+      /* Per component maximum function.
+       * ARGUMENTS:
+       *   - vectors:
+       *       const Type *A, *B;
+       *   - result vector:
+       *       Type *R;
+       * RETURNS: None.
+       */
+      static VOID Max( const Type *A, const Type *B, Type *R )
+      {
+        for (INT i = 0; i < 4; i++)
+          R[i] = A[i] > B[i] ? A[i] : B[i];
+      } /* End of 'Max' function */
+
+      /* Dot product of first three lanes function.
+       * ARGUMENTS:
+       *   - vectors:
+       *       const Type *A, *B;
+       * RETURNS: (Type) result value.
+       */
+      static Type Dot3( const Type *A, const Type *B )
+      {
+        return A[0] * B[0] + A[1] * B[1] + A[2] * B[2];
+      } /* End of 'Dot3' function */
+
+      /* Dot product of four lanes function.
+       * ARGUMENTS:
+       *   - vectors:
+       *       const Type *A, *B;
+       * RETURNS: (Type) result value.
+       */
+      static Type Dot4( const Type *A, const Type *B )
+      {
+        return A[0] * B[0] + A[1] * B[1] + A[2] * B[2] + A[3] * B[3];
+      } /* End of 'Dot4' function */
+
+      /* Cross product of first three lanes function (fourth lane is zero).
+       * ARGUMENTS:
+       *   - vectors:
+       *       const Type *A, *B;
+       *   - result vector (must not alias arguments):
+       *       Type *R;
+       * RETURNS: None.
+       */
+      static VOID Cross( const Type *A, const Type *B, Type *R )
+      {
+        R[0] = A[1] * B[2] - A[2] * B[1];
+        R[1] = A[2] * B[0] - A[0] * B[2];
+        R[2] = A[0] * B[1] - A[1] * B[0];
+        R[3] = 0;
+      } /* End of 'Cross' function */
+    }; /* End of 'lanes4_scalar' structure */
+
+  /* Four lanes kernels (scalar for types without SIMD support) */
+  template<class Type>
+    struct lanes4 : public lanes4_scalar<Type>
+    {
+    }; /* End of 'lanes4' structure */
+
+#ifdef MTH_SSE
+  /* Four float lanes SSE kernels (same interface as 'lanes4_scalar') */
+  template<>
+    struct lanes4<FLT> : public lanes4_scalar<FLT>
+    {
+      static VOID Add( const FLT *A, const FLT *B, FLT *R )
+      {
+        _mm_storeu_ps(R, _mm_add_ps(_mm_loadu_ps(A), _mm_loadu_ps(B)));
+      } /* End of 'Add' function */
+
+      static VOID Sub( const FLT *A, const FLT *B, FLT *R )
+      {
+        _mm_storeu_ps(R, _mm_sub_ps(_mm_loadu_ps(A), _mm_loadu_ps(B)));
+      } /* End of 'Sub' function */
+
+      static VOID Mul( const FLT *A, const FLT *B, FLT *R )
+      {
+        _mm_storeu_ps(R, _mm_mul_ps(_mm_loadu_ps(A), _mm_loadu_ps(B)));
+      } /* End of 'Mul' function */
+
+      static VOID Div( const FLT *A, const FLT *B, FLT *R )
+      {
+        _mm_storeu_ps(R, _mm_div_ps(_mm_loadu_ps(A), _mm_loadu_ps(B)));
+      } /* End of 'Div' function */
+
+      static VOID MulN( const FLT *A, FLT N, FLT *R )
+      {
+        _mm_storeu_ps(R, _mm_mul_ps(_mm_loadu_ps(A), _mm_set1_ps(N)));
+      } /* End of 'MulN' function */
+
+      static VOID AddN3( const FLT *A, FLT N, FLT *R )
+      {
+        _mm_storeu_ps(R, _mm_add_ps(_mm_loadu_ps(A), _mm_set_ps(0, N, N, N)));
+      } /* End of 'AddN3' function */
+
+      static VOID Min( const FLT *A, const FLT *B, FLT *R )
+      {
+        _mm_storeu_ps(R, _mm_min_ps(_mm_loadu_ps(A), _mm_loadu_ps(B)));
+      } /* End of 'Min' function */
+
+      static VOID Max( const FLT *A, const FLT *B, FLT *R )
+      {
+        _mm_storeu_ps(R, _mm_max_ps(_mm_loadu_ps(A), _mm_loadu_ps(B)));
+      } /* End of 'Max' function */
+
+      static FLT Dot3( const FLT *A, const FLT *B )
+      {
+        __m128
+          m = _mm_mul_ps(_mm_loadu_ps(A), _mm_loadu_ps(B)),
+          s = _mm_add_ss(m, _mm_movehl_ps(m, m));
+
+        return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1))));
+      } /* End of 'Dot3' function */
+
+      static FLT Dot4( const FLT *A, const FLT *B )
+      {
+        __m128
+          m = _mm_mul_ps(_mm_loadu_ps(A), _mm_loadu_ps(B)),
+          s = _mm_add_ps(m, _mm_movehl_ps(m, m));
+
+        return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1))));
+      } /* End of 'Dot4' function */
+
+      static VOID Cross( const FLT *A, const FLT *B, FLT *R )
+      {
+        __m128
+          a = _mm_loadu_ps(A), b = _mm_loadu_ps(B),
+          a1 = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)),
+          b1 = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2)),
+          a2 = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2)),
+          b2 = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+
+        _mm_storeu_ps(R, _mm_sub_ps(_mm_mul_ps(a1, b1), _mm_mul_ps(a2, b2)));
+      } /* End of 'Cross' function */
+    }; /* End of 'lanes4<FLT>' structure */
+
+  /* Four double lanes AVX (or SSE2 pairs) kernels (same interface as 'lanes4_scalar') */
+  template<>
+    struct lanes4<DBL> : public lanes4_scalar<DBL>
+    {
+#ifdef MTH_AVX
+      static VOID Add( const DBL *A, const DBL *B, DBL *R )
+      {
+        _mm256_storeu_pd(R, _mm256_add_pd(_mm256_loadu_pd(A), _mm256_loadu_pd(B)));
+      } /* End of 'Add' function */
+
+      static VOID Sub( const DBL *A, const DBL *B, DBL *R )
+      {
+        _mm256_storeu_pd(R, _mm256_sub_pd(_mm256_loadu_pd(A), _mm256_loadu_pd(B)));
+      } /* End of 'Sub' function */
+
+      static VOID Mul( const DBL *A, const DBL *B, DBL *R )
+      {
+        _mm256_storeu_pd(R, _mm256_mul_pd(_mm256_loadu_pd(A), _mm256_loadu_pd(B)));
+      } /* End of 'Mul' function */
+
+      static VOID Div( const DBL *A, const DBL *B, DBL *R )
+      {
+        _mm256_storeu_pd(R, _mm256_div_pd(_mm256_loadu_pd(A), _mm256_loadu_pd(B)));
+      } /* End of 'Div' function */
+
+      static VOID MulN( const DBL *A, DBL N, DBL *R )
+      {
+        _mm256_storeu_pd(R, _mm256_mul_pd(_mm256_loadu_pd(A), _mm256_set1_pd(N)));
+      } /* End of 'MulN' function */
+
+      static VOID AddN3( const DBL *A, DBL N, DBL *R )
+      {
+        _mm256_storeu_pd(R, _mm256_add_pd(_mm256_loadu_pd(A), _mm256_set_pd(0, N, N, N)));
+      } /* End of 'AddN3' function */
+
+      static VOID Min( const DBL *A, const DBL *B, DBL *R )
+      {
+        _mm256_storeu_pd(R, _mm256_min_pd(_mm256_loadu_pd(A), _mm256_loadu_pd(B)));
+      } /* End of 'Min' function */
+
+      static VOID Max( const DBL *A, const DBL *B, DBL *R )
+      {
+        _mm256_storeu_pd(R, _mm256_max_pd(_mm256_loadu_pd(A), _mm256_loadu_pd(B)));
+      } /* End of 'Max' function */
+
+      static DBL Dot3( const DBL *A, const DBL *B )
+      {
+        __m256d m = _mm256_mul_pd(_mm256_loadu_pd(A), _mm256_loadu_pd(B));
+        __m128d
+          lo = _mm256_castpd256_pd128(m),
+          s = _mm_add_sd(lo, _mm256_extractf128_pd(m, 1));
+
+        return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(lo, lo)));
+      } /* End of 'Dot3' function */
+
+      static DBL Dot4( const DBL *A, const DBL *B )
+      {
+        __m256d m = _mm256_mul_pd(_mm256_loadu_pd(A), _mm256_loadu_pd(B));
+        __m128d s = _mm_add_pd(_mm256_castpd256_pd128(m), _mm256_extractf128_pd(m, 1));
+
+        return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+      } /* End of 'Dot4' function */
+#else /* MTH_AVX */
+      static VOID Add( const DBL *A, const DBL *B, DBL *R )
+      {
+        __m128d lo = _mm_add_pd(_mm_loadu_pd(A), _mm_loadu_pd(B)), hi = _mm_add_pd(_mm_loadu_pd(A + 2), _mm_loadu_pd(B + 2));
+
+        _mm_storeu_pd(R, lo);
+        _mm_storeu_pd(R + 2, hi);
+      } /* End of 'Add' function */
+
+      static VOID Sub( const DBL *A, const DBL *B, DBL *R )
+      {
+        __m128d lo = _mm_sub_pd(_mm_loadu_pd(A), _mm_loadu_pd(B)), hi = _mm_sub_pd(_mm_loadu_pd(A + 2), _mm_loadu_pd(B + 2));
+
+        _mm_storeu_pd(R, lo);
+        _mm_storeu_pd(R + 2, hi);
+      } /* End of 'Sub' function */
+
+      static VOID Mul( const DBL *A, const DBL *B, DBL *R )
+      {
+        __m128d lo = _mm_mul_pd(_mm_loadu_pd(A), _mm_loadu_pd(B)), hi = _mm_mul_pd(_mm_loadu_pd(A + 2), _mm_loadu_pd(B + 2));
+
+        _mm_storeu_pd(R, lo);
+        _mm_storeu_pd(R + 2, hi);
+      } /* End of 'Mul' function */
+
+      static VOID Div( const DBL *A, const DBL *B, DBL *R )
+      {
+        __m128d lo = _mm_div_pd(_mm_loadu_pd(A), _mm_loadu_pd(B)), hi = _mm_div_pd(_mm_loadu_pd(A + 2), _mm_loadu_pd(B + 2));
+
+        _mm_storeu_pd(R, lo);
+        _mm_storeu_pd(R + 2, hi);
+      } /* End of 'Div' function */
+
+      static VOID MulN( const DBL *A, DBL N, DBL *R )
+      {
+        __m128d n = _mm_set1_pd(N), lo = _mm_mul_pd(_mm_loadu_pd(A), n), hi = _mm_mul_pd(_mm_loadu_pd(A + 2), n);
+
+        _mm_storeu_pd(R, lo);
+        _mm_storeu_pd(R + 2, hi);
+      } /* End of 'MulN' function */
+
+      static DBL Dot3( const DBL *A, const DBL *B )
+      {
+        __m128d
+          lo = _mm_mul_pd(_mm_loadu_pd(A), _mm_loadu_pd(B)),
+          s = _mm_add_sd(lo, _mm_mul_sd(_mm_load_sd(A + 2), _mm_load_sd(B + 2)));
+
+        return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(lo, lo)));
+      } /* End of 'Dot3' function */
+#endif /* MTH_AVX */
+    }; /* End of 'lanes4<DBL>' structure */
+#endif /* MTH_SSE */
+} /* end of 'mth' namespace */
+
+#endif /* __mth_simd_h_ */
+
+/* END OF 'mth_simd.h' FILE */
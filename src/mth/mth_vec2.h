@@ -9,7 +9,7 @@
  *               Vec2 handle module.
  * PROGRAMMER  : CGSG-SummerCamp'2021.
  *               Ivan Dmitriev
- * LAST UPDATE : 02.08.2021
+ * LAST UPDATE : 08.08.2021
  * NOTE        : Module namespace 'mth'.
  * 
  * No part of this file may be changed without agreement of
@@ -25,31 +25,104 @@
 
 namespace mth
 {
+  /* 2D vector class.
+   * Fully 'constexpr': two lanes are too narrow for SIMD kernels, so all
+   * operations are plain scalar code usable in constant expressions. */
   template<typename Type>
     class vec2
     {
     private:
       Type X, Y;
     public:
-      vec2( Type NewX, Type NewY ) : X(NewX), Y(NewY)
+      /* Constructor of vec2 class function.
+       * ARGUMENTS:
+       *   - coordinates:
+       *       Type NewX, NewY;
+       */
+      constexpr vec2( Type NewX, Type NewY ) noexcept : X(NewX), Y(NewY)
       {
       } /* End of 'constructor' function */
 
-      /* Constructor of vec3 class function.
-       * ARGUMENTS: None.
-       * RETURNS: None.  
+      /* Constructor of vec2 class function.
+       * ARGUMENTS:
+       *   - value of both coordinates:
+       *       Type NewV;
        */
-      explicit vec2( Type NewV ) : X(NewV), Y(NewV)
+      constexpr explicit vec2( Type NewV ) noexcept : X(NewV), Y(NewV)
       {
       } /* End of 'constructor' function */
-      /* Constructor of vec3 class function.
+
+      /* Constructor of vec2 class function.
        * ARGUMENTS: None.
        * RETURNS: None.  
        */
-      explicit vec2( VOID )
+      constexpr explicit vec2( VOID ) noexcept : X(0), Y(0)
       {
       } /* End of 'constructor' function */
 
+      /* Dot product operator of vec2 class.
+       * ARGUMENTS:
+       *   Component of dot product vector:
+       *     - const vec2 &V;
+       * RETURNS: (Type) result value.
+       */
+      constexpr Type operator&( const vec2 &V ) const noexcept
+      {
+        return X * V.X + Y * V.Y;
+      } /* End of 'operator&' function */
+
+      /* Plus vector operator of vec2 class.
+       *   Component of sum of vectors:
+       *     - const vec2 &V;
+       * RETURNS: (vec2) result vector.
+       */
+      constexpr vec2 operator+( const vec2 &V ) const noexcept
+      {
+        return vec2(X + V.X, Y + V.Y);
+      } /* End of 'operator+' function */
+
+      /* Minus vector operator of vec2 class.
+       *   Component of subtraction of vectors:
+       *     - const vec2 &V;
+       * RETURNS: (vec2) result vector.
+       */
+      constexpr vec2 operator-( const vec2 &V ) const noexcept
+      {
+        return vec2(X - V.X, Y - V.Y);
+      } /* End of 'operator-' function */
+
+      /* Multiply vec2 by number function.
+       * ARGUMENTS:
+       *   - multiplier:
+       *       Type N;
+       * RETURNS: (vec2) result vector.
+       */
+      constexpr vec2 operator*( Type N ) const noexcept
+      {
+        return vec2(X * N, Y * N);
+      } /* End of 'operator*' function */
+
+      /* Get coord of vector by index function.
+       * ARGUMENTS: 
+       *   Index of coord:
+       *     - INT i;
+       * RETURNS: (Type) result value.
+       */
+      constexpr Type operator[]( INT i ) const noexcept
+      {
+        return i == 0 ? X : Y;
+      } /* End of 'operator[]' function */
+
+      /* Get coord of vector by index function.
+       * ARGUMENTS: 
+       *   Index of coord:
+       *     - INT i;
+       * RETURNS: (Type &) link on result value.
+       */
+      constexpr Type & operator[]( INT i ) noexcept
+      {
+        return i == 0 ? X : Y;
+      } /* End of 'operator[]' function */
     }; /* End of 'vec2' class */
 } /* end of 'mth' namespace */
 
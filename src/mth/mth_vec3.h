@@ -9,7 +9,7 @@
  *               Vector3 handle module.
  * PROGRAMMER  : CGSG-SummerCamp'2021.
  *               Ivan Dmitriev
- * LAST UPDATE : 02.08.2021
+ * LAST UPDATE : 08.08.2021
  * NOTE        : Module namespace 'mth'.
  * 
  * No part of this file may be changed without agreement of
@@ -21,22 +21,29 @@
 
 #include <iostream>
 
-#include "mth_def.h"
+#include "mth_simd.h"
 
 namespace mth
 {
+  /* 3D vector class.
+   * Vector is padded to four lanes (fourth is zero), so arithmetic goes
+   * through SSE/AVX 'lanes4' kernels for float and double.
+   * Constructors and coordinate access are 'constexpr', so constant
+   * vectors tables are built at compile time; all non-mutating members
+   * are 'const' and work on temporaries and const references. */
   template<typename Type>
     class vec3
     {
       template<typename Type1> friend class matr;
     private:
-      Type X, Y, Z;
+      typedef lanes4<Type> lanes;
+      Type X, Y, Z, W; // coordinates and padding lane
     public:
       /* Constructor of vec3 class function.
        * ARGUMENTS: None.
        * RETURNS: None.  
        */
-      vec3( Type NewX, Type NewY, Type NewZ ) : X(NewX), Y(NewY), Z(NewZ)
+      constexpr vec3( Type NewX, Type NewY, Type NewZ ) noexcept : X(NewX), Y(NewY), Z(NewZ), W(0)
       {
       } /* End of 'constructor' function */
 
@@ -44,7 +51,7 @@ namespace mth
        * ARGUMENTS: None.
        * RETURNS: None.  
        */
-      explicit vec3( Type NewV ) : X(NewV), Y(NewV), Z(NewV)
+      constexpr explicit vec3( Type NewV ) noexcept : X(NewV), Y(NewV), Z(NewV), W(0)
       {
       } /* End of 'constructor' function */
 
@@ -52,7 +59,7 @@ namespace mth
        * ARGUMENTS: None.
        * RETURNS: None.  
        */
-      explicit vec3( VOID )
+      explicit vec3( VOID ) noexcept : W(0)
       {
       } /* End of 'constructor' function */
 
@@ -60,9 +67,9 @@ namespace mth
        * ARGUMENTS: None.
        * RETURNS: (Type) length of vector.
        */
-      Type operator!( VOID )
+      Type operator!( VOID ) const noexcept
       {
-        return sqrt(X * X + Y * Y + Z * Z);
+        return sqrt(lanes::Dot3(&X, &X));
       } /* End of 'operator!' function */
 
       /* Dot product operator of vec3 class.
@@ -71,9 +78,9 @@ namespace mth
        *     - const vec3 &V;
        * RETURNS: (Type) result value.
        */
-      Type operator&( const vec3 &V )
+      Type operator&( const vec3 &V ) const noexcept
       {
-        return X * V.X + Y * V.Y + Z * V.Z;
+        return lanes::Dot3(&X, &V.X);
       } /* End of 'operator&' function */
 
       /* Cross product operator of vec3 class.
@@ -82,18 +89,24 @@ namespace mth
        *     - const vec3 &V;
        * RETURNS: (vec3) result vector.
        */
-      vec3 operator%( const vec3 &V )
+      vec3 operator%( const vec3 &V ) const noexcept
       {
-        return vec3(Y * V.Z - Z * V.Y, Z * V.X - X * V.Z, X * V.Y - Y * V.X);
+        vec3 R;
+
+        lanes::Cross(&X, &V.X, &R.X);
+        return R;
       } /* End of 'operator%' function */
 
       /* Inverse coords of vec3 class.
        * ARGUMENTS: None.
        * RETURNS: (vec3) result vector.
        */
-      vec3 operator-( VOID )
+      vec3 operator-( VOID ) const noexcept
       {
-        return vec3(-X, -Y, -Z);
+        vec3 R;
+
+        lanes::MulN(&X, -1, &R.X);
+        return R;
       } /* End of 'operator-' function */
 
       /* Plus vector operator of vec3 class.
@@ -101,9 +114,12 @@ namespace mth
        *     - const vec3 &V;
        * RETURNS: (vec3) result vector.
        */
-      vec3 operator+( const vec3 &V ) const
+      vec3 operator+( const vec3 &V ) const noexcept
       {
-         return vec3(V.X + X, V.Y + Y, V.Z + Z);
+         vec3 R;
+
+         lanes::Add(&X, &V.X, &R.X);
+         return R;
       } /* End of 'operator+' function */
 
       /* Minus vector operator of vec3 class.
@@ -111,9 +127,12 @@ namespace mth
        *     - const vec3 &V;
        * RETURNS: (vec3) result vector.
        */
-      vec3 operator-( const vec3 &V )
+      vec3 operator-( const vec3 &V ) const noexcept
       {
-         return vec3(X - V.X, Y - V.Y, Z - V.Z);
+         vec3 R;
+
+         lanes::Sub(&X, &V.X, &R.X);
+         return R;
       } /* End of 'operator-' function */
 
       /* Multiply vector operator of vec3 class.
@@ -121,9 +140,12 @@ namespace mth
        *     - const vec3 &V;
        * RETURNS: (vec3) result vector.
        */
-      vec3 operator*( const vec3 &V ) const
+      vec3 operator*( const vec3 &V ) const noexcept
       {
-         return vec3(V.X * X, V.Y * Y, V.Z * Z);
+         vec3 R;
+
+         lanes::Mul(&X, &V.X, &R.X);
+         return R;
       } /* End of 'operator*' function */
 
       /* Sum vec3 and number function.
@@ -132,9 +154,12 @@ namespace mth
        *       DBL N;
        * RETURNS: (vec3) result vector.
        */
-      vec3 operator+( Type N )
+      vec3 operator+( Type N ) const noexcept
       {
-         return vec3(X + N, Y + N, Z + N);
+         vec3 R;
+
+         lanes::AddN3(&X, N, &R.X);
+         return R;
       } /* End of 'operator/' function */
       /* Sum vec3 and number function.
        * ARGUMENTS: 
@@ -142,18 +167,24 @@ namespace mth
        *       DBL N;
        * RETURNS: (vec3) result vector.
        */
-      vec3 operator-( Type N )
+      vec3 operator-( Type N ) const noexcept
       {
-         return vec3(X - N, Y - N, Z - N);
+         vec3 R;
+
+         lanes::AddN3(&X, -N, &R.X);
+         return R;
       } /* End of 'operator/' function */
 
       /* Multiply vec3 by number function.
        * ARGUMENTS: None.
        * RETURNS: (vec3) result vector.
        */
-      vec3 operator*( Type N ) const
+      vec3 operator*( Type N ) const noexcept
       {
-         return vec3(X * N, Y * N, Z * N);
+         vec3 R;
+
+         lanes::MulN(&X, N, &R.X);
+         return R;
       } /* End of 'operator*' function */
 
       /* Divide vec3 by number function.
@@ -162,11 +193,15 @@ namespace mth
        *       float N;
        * RETURNS: (vec3) result vector.
        */
-      vec3 operator/( Type N )
+      vec3 operator/( Type N ) const noexcept
       {
          if (N == 0)
            return vec3(0);
-         return vec3(X / N, Y / N, Z / N);
+
+         vec3 R;
+
+         lanes::MulN(&X, 1 / N, &R.X);
+         return R;
       } /* End of 'operator/' function */
 
       /* Add vec3 to vec3 function.
@@ -175,11 +210,9 @@ namespace mth
        *     - const vec3 &V;
        * RETURNS: (vec3 &) link on result vector.
        */
-      vec3 & operator+=( const vec3 &V )
+      vec3 & operator+=( const vec3 &V ) noexcept
       {
-         X += V.X;
-         Y += V.Y;
-         Z += V.Z;
+         lanes::Add(&X, &V.X, &X);
          return *this;
       } /* End of 'operator+=' function */
 
@@ -189,11 +222,9 @@ namespace mth
        *     - const vec3 &V;
        * RETURNS: (vec3 &) link on result vector.
        */
-      vec3 & operator-=( const vec3 &V )
+      vec3 & operator-=( const vec3 &V ) noexcept
       {
-         X -= V.X;
-         Y -= V.Y;
-         Z -= V.Z;
+         lanes::Sub(&X, &V.X, &X);
          return *this;
       } /* End of 'operator-=' function */
 
@@ -203,11 +234,9 @@ namespace mth
        *     - const vec3 &V;
        * RETURNS: (vec3 &) link on result vector.
        */
-      vec3 & operator*=( const vec3 &V )
+      vec3 & operator*=( const vec3 &V ) noexcept
       {
-         X *= V.X;
-         Y *= V.Y;
-         Z *= V.Z;
+         lanes::Mul(&X, &V.X, &X);
          return *this;
       } /* End of 'operator*=' function */
 
@@ -217,7 +246,7 @@ namespace mth
        *     - const vec3 &V;
        * RETURNS: (vec3 &) link on result vector.
        */
-      vec3 & operator/=( const vec3 &V )
+      vec3 & operator/=( const vec3 &V ) noexcept
       {
          X /= V.X;
          Y /= V.Y;
@@ -229,12 +258,13 @@ namespace mth
        * ARGUMENTS: None.
        * RETURNS: (vec3) result vector.
        */
-      vec3 Normalizing( VOID )
+      vec3 Normalizing( VOID ) const noexcept
       {
-        if (!*this == 0 || !*this == 1)
+        Type len2 = lanes::Dot3(&X, &X);
+
+        if (len2 == 0 || len2 == 1)
           return *this;
-        Type length = sqrt(X * X + Y * Y + Z * Z);
-        return *this / length;
+        return *this * (1 / sqrt(len2));
         //return vec3(X / !*this, Y / !*this, Z / !*this);
       } /* End of 'Normalizing' function */
 
@@ -242,14 +272,13 @@ namespace mth
        * ARGUMENTS: None.
        * RETURNS: None.
        */
-      VOID Normalize( VOID )
+      VOID Normalize( VOID ) noexcept
       {
-        if (!*this == 0 || !*this == 1)
+        Type len2 = lanes::Dot3(&X, &X);
+
+        if (len2 == 0 || len2 == 1)
           return;
-        Type length = !*this;
-        X /= length;
-        Y /= length;
-        Z /= length;
+        lanes::MulN(&X, 1 / sqrt(len2), &X);
         //*this /= !(*this);
       } /* End of 'Normalize' function */
 
@@ -257,9 +286,9 @@ namespace mth
        * ARGUMENTS: None.
        * RETURNS: (Type) result value.
        */
-      Type Length2( VOID )
+      Type Length2( VOID ) const noexcept
       {
-        return X * X + Y * Y + Z * Z;
+        return lanes::Dot3(&X, &X);
       } /* End of 'Length2' function */
 
       /* Find distance between two vectors function.
@@ -268,9 +297,9 @@ namespace mth
        *     - const vec3 &V;
        * RETURNS: (DBL) result value.
        */
-      Type Distance( const vec3 &V ) const
+      Type Distance( const vec3 &V ) const noexcept
       {
-        return sqrt((X - V.X) * (X - V.X) + (Y - V.Y) * (Y - V.Y) + (Z - V.Z) * (Z - V.Z));
+        return sqrt(Distance2(V));
       } /* End of 'Distance' function */
 
       /* Find squared distance between two vectors function.
@@ -279,24 +308,27 @@ namespace mth
        *     - const vec3 &V;
        * RETURNS: (DBL) result value.
        */
-      Type Distance2( const vec3 &V ) const
+      Type Distance2( const vec3 &V ) const noexcept
       {
-        return (X - V.X) * (X - V.X) + (Y - V.Y) * (Y - V.Y) + (Z - V.Z) * (Z - V.Z);
+        Type D[4];
+
+        lanes::Sub(&X, &V.X, D);
+        return lanes::Dot3(D, D);
       } /* End of 'Distance2' function */
 
       /* Set zero vector function.
        * ARGUMENTS: None.
        * RETURNS: (vec3) result vector.
        */
-      vec3 Zero( VOID )
+      static constexpr vec3 Zero( VOID ) noexcept
       {
         return vec3(0);
       } /* End of 'Zero' function */
       /* Get random vector function.
        * ARGUMENTS: None.
-       * RETURNS: (vec3 &) link on result vector.
+       * RETURNS: (vec3) result vector.
        */
-      vec3 & Rnd0( VOID )
+      static vec3 Rnd0( VOID )
       {
         return vec3(mth::Rnd0(), mth::Rnd0(), mth::Rnd0());
       } /* End of 'Rnd0' function */
@@ -307,7 +339,7 @@ namespace mth
        *     - INT i;
        * RETURNS: (Type &) link on result value.
        */
-      Type & operator[]( INT i )
+      constexpr Type & operator[]( INT i ) noexcept
       {
         assert(i >= 0 && i <= 2);
 
@@ -325,7 +357,7 @@ namespace mth
        *     - INT i;
        * RETURNS: (Type) result value.
        */
-      Type operator[]( INT i ) const
+      constexpr Type operator[]( INT i ) const noexcept
       {
         assert(i >= 0 && i <= 2);
 
@@ -341,16 +373,7 @@ namespace mth
        * ARGUMENTS: None. 
        * RETURNS: None.
        */
-      operator const Type *( VOID ) const
-      {
-        return &X;
-      } /* End of 'const Type *' function */
-
-      /* Get address of first coord of vector function.
-       * ARGUMENTS: None. 
-       * RETURNS: None.
-       */
-      operator const Type *( VOID ) 
+      constexpr operator const Type *( VOID ) const noexcept
       {
         return &X;
       } /* End of 'const Type *' function */
@@ -373,11 +396,10 @@ namespace mth
       *       Type A, B;
       * RETURNS: (Type) result value.
       */
-      static vec3 Min( vec3 V1, vec3 V2 )
+      static vec3 Min( vec3 V1, vec3 V2 ) noexcept
       {
-        return vec3(V1[0] > V2[0] ? V2[0] : V1[0],
-                    V1[1] > V2[1] ? V2[1] : V1[1],
-                    V1[2] > V2[2] ? V2[2] : V1[2]);
+        lanes::Min(&V1.X, &V2.X, &V1.X);
+        return V1;
       } /* End of 'Min' function */
      /* Get maximum value function.
       * ARGUMENTS:
@@ -385,11 +407,10 @@ namespace mth
       *       Type A, B;
       * RETURNS: (Type) result value.
       */
-      static vec3 Max( vec3 V1, vec3 V2 )
+      static vec3 Max( vec3 V1, vec3 V2 ) noexcept
       {
-        return vec3(V1[0] > V2[0] ? V1[0] : V2[0],
-                    V1[1] > V2[1] ? V1[1] : V2[1],
-                    V1[2] > V2[2] ? V1[2] : V2[2]);
+        lanes::Max(&V1.X, &V2.X, &V1.X);
+        return V1;
       } /* End of 'Max' function */
 
      /* Zero y-coord function.
@@ -409,7 +430,7 @@ namespace mth
     *       Type A, B;
     * RETURNS: (Type) result value.
     */
-    vec3 GetVecInPlaneXZ( vec3 V )
+    static constexpr vec3 GetVecInPlaneXZ( const vec3 &V ) noexcept
     {
       return vec3(V[0], 5, V[2]);
     }
@@ -419,7 +440,7 @@ namespace mth
      *       DBL N;
      * RETURNS: (vec3) result vector.
      */
-    vec3 Reflect( vec3 &val )  
+    vec3 Reflect( const vec3 &val ) const noexcept
     {
       vec3 Norm = this->Normalizing();
       return val - Norm * 2 * (val & Norm);
@@ -432,11 +453,9 @@ namespace mth
      *       Type min, max; 
      * RETURNS: (Type) result value.  
      */
-    static vec3 ClampV( vec3 Value, vec3 min = vec3(0), vec3 max = vec3(1) )
+    static vec3 ClampV( const vec3 &Value, const vec3 &min = vec3(0), const vec3 &max = vec3(1) ) noexcept
     {
-      return vec3(Clamp(Value[0], min[0], max[0]),
-                  Clamp(Value[1], min[1], max[1]),
-                  Clamp(Value[2], min[2], max[2]));
+      return Min(Max(Value, min), max);
     } /* End of 'ClampV' function */
 
   }; /* End of 'vec3' class */
@@ -0,0 +1,489 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : mth_vec3x8.h
+ * PURPOSE     : Raytracing project.
+ *               Mathematics library.
+ *               Eight vectors batch (structure of arrays) handle module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'mth'.
+ *               Objects are always passed by reference: 32 bytes aligned
+ *               arguments can't be passed by value on x86.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __mth_vec3x8_h_
+#define __mth_vec3x8_h_
+
+#include <cstring>
+
+#include "mth_vec3.h"
+
+namespace mth
+{
+  /* Eight float lanes class (AVX register or plain array) */
+  class flt8
+  {
+  public:
+#ifdef MTH_AVX
+    __m256 V; // lanes values
+#else
+    FLT V[8]; // lanes values
+#endif /* MTH_AVX */
+
+    /* Constructor of flt8 class function.
+     * ARGUMENTS: None.
+     */
+    flt8( VOID )
+    {
+    } /* End of 'flt8' function */
+
+    /* Constructor of flt8 class function.
+     * ARGUMENTS:
+     *   - value for all lanes:
+     *       FLT N;
+     */
+    explicit flt8( FLT N )
+    {
+#ifdef MTH_AVX
+      V = _mm256_set1_ps(N);
+#else
+      for (INT i = 0; i < 8; i++)
+        V[i] = N;
+#endif /* MTH_AVX */
+    } /* End of 'flt8' function */
+
+    /* Load lanes from memory function.
+     * ARGUMENTS:
+     *   - eight values (may be unaligned):
+     *       const FLT *P;
+     * RETURNS: (flt8) result lanes.
+     */
+    static flt8 Load( const FLT *P )
+    {
+      flt8 R;
+
+#ifdef MTH_AVX
+      R.V = _mm256_loadu_ps(P);
+#else
+      for (INT i = 0; i < 8; i++)
+        R.V[i] = P[i];
+#endif /* MTH_AVX */
+      return R;
+    } /* End of 'Load' function */
+
+    /* Load lanes from unsigned bytes function.
+     * ARGUMENTS:
+     *   - eight bytes (may be unaligned):
+     *       const BYTE *P;
+     * RETURNS: (flt8) result lanes (byte values 0..255).
+     */
+    static flt8 LoadBytes( const BYTE *P )
+    {
+      flt8 R;
+
+#ifdef MTH_AVX
+      __m128i b = _mm_loadl_epi64((const __m128i *)P);
+
+      R.V = _mm256_cvtepi32_ps(_mm256_insertf128_si256(_mm256_castsi128_si256(_mm_cvtepu8_epi32(b)),
+                                                       _mm_cvtepu8_epi32(_mm_srli_si128(b, 4)), 1));
+#else
+      for (INT i = 0; i < 8; i++)
+        R.V[i] = P[i];
+#endif /* MTH_AVX */
+      return R;
+    } /* End of 'LoadBytes' function */
+
+    /* Store lanes to memory function.
+     * ARGUMENTS:
+     *   - eight values (may be unaligned):
+     *       FLT *P;
+     * RETURNS: None.
+     */
+    VOID Store( FLT *P ) const
+    {
+#ifdef MTH_AVX
+      _mm256_storeu_ps(P, V);
+#else
+      for (INT i = 0; i < 8; i++)
+        P[i] = V[i];
+#endif /* MTH_AVX */
+    } /* End of 'Store' function */
+
+    /* Get lane value function.
+     * ARGUMENTS:
+     *   - lane index:
+     *       INT i;
+     * RETURNS: (FLT) result value.
+     */
+    FLT operator[]( INT i ) const
+    {
+      assert(i >= 0 && i < 8);
+
+      return ((const FLT *)&V)[i];
+    } /* End of 'operator[]' function */
+
+#ifdef MTH_AVX
+#  define MTH_FLT8_OP(Op, Intr, Expr)                  \
+    flt8 Op( const flt8 &B ) const                      \
+    {                                                   \
+      flt8 R;                                           \
+                                                        \
+      R.V = Intr(V, B.V);                               \
+      return R;                                         \
+    }
+#else
+#  define MTH_FLT8_OP(Op, Intr, Expr)                  \
+    flt8 Op( const flt8 &B ) const                      \
+    {                                                   \
+      flt8 R;                                           \
+                                                        \
+      for (INT i = 0; i < 8; i++)                       \
+        R.V[i] = Expr;                                  \
+      return R;                                         \
+    }
+#endif /* MTH_AVX */
+
+    /* Lane-wise arithmetic operators */
+    MTH_FLT8_OP(operator+, _mm256_add_ps, V[i] + B.V[i])
+    MTH_FLT8_OP(operator-, _mm256_sub_ps, V[i] - B.V[i])
+    MTH_FLT8_OP(operator*, _mm256_mul_ps, V[i] * B.V[i])
+    MTH_FLT8_OP(operator/, _mm256_div_ps, V[i] / B.V[i])
+
+    /* Lane-wise minimum and maximum */
+    MTH_FLT8_OP(Min, _mm256_min_ps, V[i] > B.V[i] ? B.V[i] : V[i])
+    MTH_FLT8_OP(Max, _mm256_max_ps, V[i] > B.V[i] ? V[i] : B.V[i])
+
+    /* Lane-wise logical operations on comparison masks */
+    MTH_FLT8_OP(operator&, _mm256_and_ps, Bits(Bits(V[i]) & Bits(B.V[i])))
+    MTH_FLT8_OP(operator|, _mm256_or_ps, Bits(Bits(V[i]) | Bits(B.V[i])))
+#undef MTH_FLT8_OP
+
+#ifndef MTH_AVX
+    /* Reinterpret float bits as integer function.
+     * ARGUMENTS:
+     *   - value:
+     *       FLT F;
+     * RETURNS: (UINT) result bits.
+     */
+    static UINT Bits( FLT F )
+    {
+      UINT U;
+
+      memcpy(&U, &F, sizeof(U));
+      return U;
+    } /* End of 'Bits' function */
+
+    /* Reinterpret integer bits as float function.
+     * ARGUMENTS:
+     *   - bits:
+     *       UINT U;
+     * RETURNS: (FLT) result value.
+     */
+    static FLT Bits( UINT U )
+    {
+      FLT F;
+
+      memcpy(&F, &U, sizeof(F));
+      return F;
+    } /* End of 'Bits' function */
+
+    /* Make comparison mask lane function.
+     * ARGUMENTS:
+     *   - comparison result:
+     *       BOOL C;
+     * RETURNS: (FLT) all ones or all zeroes lane.
+     */
+    static FLT Mask( BOOL C )
+    {
+      return Bits(C ? 0xFFFFFFFFU : 0U);
+    } /* End of 'Mask' function */
+#endif /* MTH_AVX */
+
+#ifdef MTH_AVX
+#  define MTH_FLT8_CMP(Op, Pred, Expr)                 \
+    flt8 Op( const flt8 &B ) const                      \
+    {                                                   \
+      flt8 R;                                           \
+                                                        \
+      R.V = _mm256_cmp_ps(V, B.V, Pred);                \
+      return R;                                         \
+    }
+#else
+#  define MTH_FLT8_CMP(Op, Pred, Expr)                 \
+    flt8 Op( const flt8 &B ) const                      \
+    {                                                   \
+      flt8 R;                                           \
+                                                        \
+      for (INT i = 0; i < 8; i++)                       \
+        R.V[i] = Mask(Expr);                            \
+      return R;                                         \
+    }
+#endif /* MTH_AVX */
+
+    /* Lane-wise comparisons (all ones lanes where true) */
+    MTH_FLT8_CMP(operator<, _CMP_LT_OQ, V[i] < B.V[i])
+    MTH_FLT8_CMP(operator<=, _CMP_LE_OQ, V[i] <= B.V[i])
+    MTH_FLT8_CMP(operator>, _CMP_GT_OQ, V[i] > B.V[i])
+    MTH_FLT8_CMP(operator>=, _CMP_GE_OQ, V[i] >= B.V[i])
+#undef MTH_FLT8_CMP
+
+    /* Get comparison mask bits function.
+     * ARGUMENTS: None.
+     * RETURNS: (INT) bit i is set if lane i is true.
+     */
+    INT MoveMask( VOID ) const
+    {
+#ifdef MTH_AVX
+      return _mm256_movemask_ps(V);
+#else
+      INT m = 0;
+
+      for (INT i = 0; i < 8; i++)
+        m |= (Bits(V[i]) >> 31) << i;
+      return m;
+#endif /* MTH_AVX */
+    } /* End of 'MoveMask' function */
+
+    /* Choose lanes by mask function.
+     * ARGUMENTS:
+     *   - comparison mask:
+     *       const flt8 &M;
+     *   - lanes for true and false mask lanes:
+     *       const flt8 &A, &B;
+     * RETURNS: (flt8) result lanes.
+     */
+    static flt8 Select( const flt8 &M, const flt8 &A, const flt8 &B )
+    {
+      flt8 R;
+
+#ifdef MTH_AVX
+      R.V = _mm256_blendv_ps(B.V, A.V, M.V);
+#else
+      for (INT i = 0; i < 8; i++)
+        R.V[i] = Bits(M.V[i]) >> 31 ? A.V[i] : B.V[i];
+#endif /* MTH_AVX */
+      return R;
+    } /* End of 'Select' function */
+
+    /* Lane-wise absolute value function.
+     * ARGUMENTS: None.
+     * RETURNS: (flt8) result lanes.
+     */
+    flt8 Abs( VOID ) const
+    {
+      flt8 R;
+
+#ifdef MTH_AVX
+      R.V = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), V);
+#else
+      for (INT i = 0; i < 8; i++)
+        R.V[i] = fabsf(V[i]);
+#endif /* MTH_AVX */
+      return R;
+    } /* End of 'Abs' function */
+
+    /* Lane-wise square root function.
+     * ARGUMENTS: None.
+     * RETURNS: (flt8) result lanes.
+     */
+    flt8 Sqrt( VOID ) const
+    {
+      flt8 R;
+
+#ifdef MTH_AVX
+      R.V = _mm256_sqrt_ps(V);
+#else
+      for (INT i = 0; i < 8; i++)
+        R.V[i] = sqrtf(V[i]);
+#endif /* MTH_AVX */
+      return R;
+    } /* End of 'Sqrt' function */
+
+    /* Lane-wise floor function.
+     * ARGUMENTS: None.
+     * RETURNS: (flt8) result lanes.
+     */
+    flt8 Floor( VOID ) const
+    {
+      flt8 R;
+
+#ifdef MTH_AVX
+      R.V = _mm256_floor_ps(V);
+#else
+      for (INT i = 0; i < 8; i++)
+        R.V[i] = floorf(V[i]);
+#endif /* MTH_AVX */
+      return R;
+    } /* End of 'Floor' function */
+  }; /* End of 'flt8' class */
+
+  /* Eight 3D vectors batch class (structure of arrays) */
+  class vec3x8
+  {
+  public:
+    flt8 X, Y, Z; // coordinates of eight vectors
+
+    /* Constructor of vec3x8 class function.
+     * ARGUMENTS: None.
+     */
+    vec3x8( VOID )
+    {
+    } /* End of 'vec3x8' function */
+
+    /* Constructor of vec3x8 class function.
+     * ARGUMENTS:
+     *   - coordinates lanes:
+     *       const flt8 &NX, &NY, &NZ;
+     */
+    vec3x8( const flt8 &NX, const flt8 &NY, const flt8 &NZ ) : X(NX), Y(NY), Z(NZ)
+    {
+    } /* End of 'vec3x8' function */
+
+    /* Constructor of vec3x8 class function (same vector in all lanes).
+     * ARGUMENTS:
+     *   - vector:
+     *       const vec3<FLT> &V;
+     */
+    explicit vec3x8( const vec3<FLT> &V ) : X(V[0]), Y(V[1]), Z(V[2])
+    {
+    } /* End of 'vec3x8' function */
+
+    /* Gather eight vectors function.
+     * ARGUMENTS:
+     *   - vectors array:
+     *       const vec3<FLT> *P;
+     * RETURNS: (vec3x8) result batch.
+     */
+    static vec3x8 Load( const vec3<FLT> *P )
+    {
+      FLT x[8], y[8], z[8];
+
+      for (INT i = 0; i < 8; i++)
+        x[i] = P[i][0], y[i] = P[i][1], z[i] = P[i][2];
+      return vec3x8(flt8::Load(x), flt8::Load(y), flt8::Load(z));
+    } /* End of 'Load' function */
+
+    /* Scatter eight vectors function.
+     * ARGUMENTS:
+     *   - vectors array:
+     *       vec3<FLT> *P;
+     * RETURNS: None.
+     */
+    VOID Store( vec3<FLT> *P ) const
+    {
+      FLT x[8], y[8], z[8];
+
+      X.Store(x), Y.Store(y), Z.Store(z);
+      for (INT i = 0; i < 8; i++)
+        P[i] = vec3<FLT>(x[i], y[i], z[i]);
+    } /* End of 'Store' function */
+
+    /* Get one vector function.
+     * ARGUMENTS:
+     *   - lane index:
+     *       INT i;
+     * RETURNS: (vec3<FLT>) result vector.
+     */
+    vec3<FLT> operator[]( INT i ) const
+    {
+      return vec3<FLT>(X[i], Y[i], Z[i]);
+    } /* End of 'operator[]' function */
+
+    /* Sum of batches operator.
+     * ARGUMENTS:
+     *   - batch:
+     *       const vec3x8 &V;
+     * RETURNS: (vec3x8) result batch.
+     */
+    vec3x8 operator+( const vec3x8 &V ) const
+    {
+      return vec3x8(X + V.X, Y + V.Y, Z + V.Z);
+    } /* End of 'operator+' function */
+
+    /* Difference of batches operator.
+     * ARGUMENTS:
+     *   - batch:
+     *       const vec3x8 &V;
+     * RETURNS: (vec3x8) result batch.
+     */
+    vec3x8 operator-( const vec3x8 &V ) const
+    {
+      return vec3x8(X - V.X, Y - V.Y, Z - V.Z);
+    } /* End of 'operator-' function */
+
+    /* Per component product of batches operator.
+     * ARGUMENTS:
+     *   - batch:
+     *       const vec3x8 &V;
+     * RETURNS: (vec3x8) result batch.
+     */
+    vec3x8 operator*( const vec3x8 &V ) const
+    {
+      return vec3x8(X * V.X, Y * V.Y, Z * V.Z);
+    } /* End of 'operator*' function */
+
+    /* Multiply batch by numbers operator.
+     * ARGUMENTS:
+     *   - lanes multipliers:
+     *       const flt8 &N;
+     * RETURNS: (vec3x8) result batch.
+     */
+    vec3x8 operator*( const flt8 &N ) const
+    {
+      return vec3x8(X * N, Y * N, Z * N);
+    } /* End of 'operator*' function */
+
+    /* Dot products operator.
+     * ARGUMENTS:
+     *   - batch:
+     *       const vec3x8 &V;
+     * RETURNS: (flt8) eight dot products.
+     */
+    flt8 operator&( const vec3x8 &V ) const
+    {
+      return X * V.X + Y * V.Y + Z * V.Z;
+    } /* End of 'operator&' function */
+
+    /* Cross products operator.
+     * ARGUMENTS:
+     *   - batch:
+     *       const vec3x8 &V;
+     * RETURNS: (vec3x8) result batch.
+     */
+    vec3x8 operator%( const vec3x8 &V ) const
+    {
+      return vec3x8(Y * V.Z - Z * V.Y, Z * V.X - X * V.Z, X * V.Y - Y * V.X);
+    } /* End of 'operator%' function */
+
+    /* Lengths operator.
+     * ARGUMENTS: None.
+     * RETURNS: (flt8) eight lengths.
+     */
+    flt8 operator!( VOID ) const
+    {
+      return (X * X + Y * Y + Z * Z).Sqrt();
+    } /* End of 'operator!' function */
+
+    /* Normalize batch function (zero vectors stay zero).
+     * ARGUMENTS: None.
+     * RETURNS: (vec3x8) result batch.
+     */
+    vec3x8 Normalizing( VOID ) const
+    {
+      flt8 len = !*this, zero(0);
+
+      return *this * flt8::Select(len > zero, flt8(1) / len, zero);
+    } /* End of 'Normalizing' function */
+  }; /* End of 'vec3x8' class */
+} /* end of 'mth' namespace */
+
+#endif /* __mth_vec3x8_h_ */
+
+/* END OF 'mth_vec3x8.h' FILE */
@@ -22,17 +22,19 @@
 
 #include <iostream>
 
-#include "mth_def.h"
+#include "mth_simd.h"
 
 namespace mth
 {
+  /* 4D vector class (arithmetic goes through SSE/AVX 'lanes4' kernels) */
   template<typename Type>
     class vec4
     {
     private:
+      typedef lanes4<Type> lanes;
       Type X, Y, Z, W;
     public:
-      vec4( Type NewX, Type NewY, Type NewZ, Type NewW  ) : X(NewX), Y(NewY), Z(NewZ), W(NewW)
+      constexpr vec4( Type NewX, Type NewY, Type NewZ, Type NewW ) noexcept : X(NewX), Y(NewY), Z(NewZ), W(NewW)
       {
       } /* End of default constructor */
 
@@ -40,17 +42,119 @@ namespace mth
        * ARGUMENTS: None.
        * RETURNS: None.  
        */
-      explicit vec4( Type NewV ) : X(NewV), Y(NewV), Z(NewV), W(NewV)
+      constexpr explicit vec4( Type NewV ) noexcept : X(NewV), Y(NewV), Z(NewV), W(NewV)
       {
       } /* End of default constructor */
       /* Constructor of vec3 class function.
        * ARGUMENTS: None.
        * RETURNS: None.  
        */
-      explicit vec4( VOID )
+      explicit vec4( VOID ) noexcept
       {
       } /* End of 'constructor' function */
 
+      /* Dot product operator of vec4 class.
+       * ARGUMENTS:
+       *   Component of dot product vector:
+       *     - const vec4 &V;
+       * RETURNS: (Type) result value.
+       */
+      Type operator&( const vec4 &V ) const noexcept
+      {
+        return lanes::Dot4(&X, &V.X);
+      } /* End of 'operator&' function */
+
+      /* Plus vector operator of vec4 class.
+       *   Component of sum of vectors:
+       *     - const vec4 &V;
+       * RETURNS: (vec4) result vector.
+       */
+      vec4 operator+( const vec4 &V ) const noexcept
+      {
+        vec4 R;
+
+        lanes::Add(&X, &V.X, &R.X);
+        return R;
+      } /* End of 'operator+' function */
+
+      /* Minus vector operator of vec4 class.
+       *   Component of subtraction of vectors:
+       *     - const vec4 &V;
+       * RETURNS: (vec4) result vector.
+       */
+      vec4 operator-( const vec4 &V ) const noexcept
+      {
+        vec4 R;
+
+        lanes::Sub(&X, &V.X, &R.X);
+        return R;
+      } /* End of 'operator-' function */
+
+      /* Multiply vector operator of vec4 class.
+       *   Component of multiplication of vectors:
+       *     - const vec4 &V;
+       * RETURNS: (vec4) result vector.
+       */
+      vec4 operator*( const vec4 &V ) const noexcept
+      {
+        vec4 R;
+
+        lanes::Mul(&X, &V.X, &R.X);
+        return R;
+      } /* End of 'operator*' function */
+
+      /* Multiply vec4 by number function.
+       * ARGUMENTS:
+       *   - multiplier:
+       *       Type N;
+       * RETURNS: (vec4) result vector.
+       */
+      vec4 operator*( Type N ) const noexcept
+      {
+        vec4 R;
+
+        lanes::MulN(&X, N, &R.X);
+        return R;
+      } /* End of 'operator*' function */
+
+      /* Add vec4 to vec4 function.
+       * ARGUMENTS: 
+       *   Link on vector sum component:
+       *     - const vec4 &V;
+       * RETURNS: (vec4 &) link on result vector.
+       */
+      vec4 & operator+=( const vec4 &V ) noexcept
+      {
+        lanes::Add(&X, &V.X, &X);
+        return *this;
+      } /* End of 'operator+=' function */
+
+      /* Get coord of vector by index function.
+       * ARGUMENTS: 
+       *   Index of coord:
+       *     - INT i;
+       * RETURNS: (Type) result value.
+       */
+      Type operator[]( INT i ) const noexcept
+      {
+        assert(i >= 0 && i <= 3);
+
+        return (&X)[i];
+      } /* End of 'operator[]' function */
+
+      /* Get coord of vector by index function.
+       * ARGUMENTS: 
+       *   Index of coord:
+       *     - INT i;
+       * RETURNS: (Type &) link on result value.
+       */
+      Type & operator[]( INT i ) noexcept
+      {
+        assert(i >= 0 && i <= 3);
+
+        return (&X)[i];
+      } /* End of 'operator[]' function */
+
     }; /* End of 'vec4' class */
 } /* end of 'mth' namespace */
 
@@ -0,0 +1,286 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : bvh.cpp
+ * PURPOSE     : Raytracing project.
+ *               Bounding volume hierarchy implementation module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#include <algorithm>
+
+#include "../rt_def.h"
+#include "../shapes/triangle8.h"
+
+/* Traversal stack size.
+ * Expanded node of depth D leaves at most 7 entries per upper level and
+ * pushes 8, so 7 * D + 8 entries are enough ('Build' asserts this bound;
+ * median splits keep D below 32 for any shapes count). */
+static const INT BvhStackSize = 256;
+
+/* Class constructor */
+ivrt::bvh::bvh( VOID )
+{
+} /* End of 'ivrt::bvh::bvh' function */
+
+/* Class destructor */
+ivrt::bvh::~bvh( VOID )
+{
+} /* End of 'ivrt::bvh::~bvh' function */
+
+/* Build hierarchy function.
+ * ARGUMENTS:
+ *   - bounded shapes:
+ *       const std::vector<shape *> &NewShapes;
+ * RETURNS: None.
+ */
+VOID ivrt::bvh::Build( const std::vector<shape *> &NewShapes )
+{
+  Shapes = NewShapes;
+  Nodes.clear();
+  Packets.clear();
+  if (!Shapes.empty())
+    Build(0, (INT)Shapes.size(), 0);
+} /* End of 'ivrt::bvh::Build' function */
+
+/* Get storage size function.
+ * ARGUMENTS: None.
+ * RETURNS: (size_t) size of nodes, leaf shapes references and packets in bytes.
+ */
+size_t ivrt::bvh::Size( VOID ) const
+{
+  return Nodes.size() * sizeof(node) + Shapes.size() * sizeof(shape *) + Packets.size() * sizeof(triangle8);
+} /* End of 'ivrt::bvh::Size' function */
+
+/* Build subtree function.
+ * Largest shapes group is split in halves until there are eight groups
+ * or all of them fit in leaves; larger groups become child subtrees.
+ * ARGUMENTS:
+ *   - shapes range:
+ *       INT First, Count;
+ *   - subtree root depth:
+ *       INT Depth;
+ * RETURNS: (INT) subtree root node index.
+ */
+INT ivrt::bvh::Build( INT First, INT Count, INT Depth )
+{
+  INT groups[8][2] = {{First, Count}}, ng = 1, child[8], count[8], packet[8], idx = (INT)Nodes.size();
+  aabb boxes[8];
+
+  assert(7 * Depth + 8 <= BvhStackSize);
+  Nodes.push_back(node());
+  while (ng < 8)
+  {
+    INT g = 0;
+
+    for (INT i = 1; i < ng; i++)
+      if (groups[i][1] > groups[g][1])
+        g = i;
+    if (groups[g][1] <= LeafSize)
+      break;
+
+    INT f = groups[g][0], c = groups[g][1], axis;
+    aabb centers;
+
+    for (INT i = f; i < f + c; i++)
+      centers.Grow(Shapes[i]->Bounds().Center());
+    axis = centers.LongestAxis();
+    std::nth_element(Shapes.begin() + f, Shapes.begin() + f + c / 2, Shapes.begin() + f + c,
+      [axis]( shape *A, shape *B )
+      {
+        return A->Bounds().Center()[axis] < B->Bounds().Center()[axis];
+      });
+    groups[g][1] = c / 2;
+    groups[ng][0] = f + c / 2;
+    groups[ng++][1] = c - c / 2;
+  }
+
+  for (INT i = 0; i < ng; i++)
+  {
+    for (INT k = groups[i][0]; k < groups[i][0] + groups[i][1]; k++)
+      boxes[i].Grow(Shapes[k]->Bounds());
+    packet[i] = -1;
+    if (groups[i][1] <= LeafSize)
+    {
+      const triangle *tris[LeafSize];
+      INT n = 0;
+
+      child[i] = groups[i][0], count[i] = groups[i][1];
+      /* All leaf triangles use plain triangle intersection (mesh ones only differ in shading) */
+      for (INT k = child[i]; k < child[i] + count[i] && (tris[n] = dynamic_cast<const triangle *>(Shapes[k])) != nullptr; k++)
+        n++;
+      if (n == count[i])
+      {
+        packet[i] = (INT)Packets.size();
+        Packets.push_back(triangle8(tris, n));
+      }
+    }
+    else
+      child[i] = Build(groups[i][0], groups[i][1], Depth + 1), count[i] = 0;
+  }
+  /* Node reference is taken only now: children building moves nodes */
+  node &N = Nodes[idx];
+
+  N.Boxes = mth::aabb8(boxes, ng);
+  for (INT i = 0; i < 8; i++)
+  {
+    N.Child[i] = i < ng ? child[i] : -1;
+    N.Count[i] = i < ng ? count[i] : 0;
+    N.Packet[i] = i < ng ? packet[i] : -1;
+  }
+  return idx;
+} /* End of 'ivrt::bvh::Build' function */
+
+/* Find closest intersection function.
+ * Hit children are pushed farthest first, so nearer ones are visited
+ * earlier and shrink ray distance for the rest.
+ * ARGUMENTS:
+ *   - ray:
+ *       const ray &R;
+ *   - intersection to be updated if closer one is found (Shp may be nullptr):
+ *       intr *Intr;
+ * RETURNS: (BOOL) TRUE if closer intersection is found.
+ */
+BOOL ivrt::bvh::Intersection( const ray &R, intr *Intr ) const
+{
+  if (Nodes.empty())
+    return FALSE;
+
+  mth::inv_ray8 ir((inv_ray(R)));
+  tri_ray tr(R);
+  INT stack[BvhStackSize], top = 0;
+  FLT dist[BvhStackSize];
+  DBL best = Intr->Shp != nullptr ? Intr->T : HUGE_VAL;
+  BOOL found = FALSE;
+
+  stack[top] = 0, dist[top++] = 0;
+  while (top > 0)
+  {
+    INT n = stack[--top];
+
+    if (dist[top] > best)
+      continue;
+
+    /* Leaf entry: -1 - (node index * 8 + child lane) */
+    if (n < 0)
+    {
+      const node &L = Nodes[(-1 - n) >> 3];
+      INT lane = (-1 - n) & 7;
+
+      if (L.Packet[lane] >= 0)
+      {
+        DBL t, u, v;
+        INT i;
+
+        IVRT_STAT_ADD(ShapeTests, L.Count[lane]);
+        if ((i = Packets[L.Packet[lane]].Intersect(tr, best, &t, &u, &v)) >= 0)
+        {
+          intr I;
+
+          /* Same results as 'triangle::Intersection' */
+          I.Shp = Shapes[L.Child[lane] + i];
+          I.T = t;
+          I.D[0] = u;
+          I.D[1] = v;
+          for (INT k = 0; k < 5; k++)
+            I.add[k] = 0;
+          *Intr = I, best = t, found = TRUE;
+        }
+        continue;
+      }
+      for (INT k = L.Child[lane]; k < L.Child[lane] + L.Count[lane]; k++)
+      {
+        intr I;
+
+        IVRT_STAT(ShapeTests);
+        if (Shapes[k]->Intersection(R, &I) && I.T < best)
+          *Intr = I, best = I.T, found = TRUE;
+      }
+      continue;
+    }
+
+    const node &N = Nodes[n];
+    mth::flt8 tn;
+    INT mask = N.Boxes.Intersect(ir, mth::aabb8::RoundUp(best), &tn), order[8], no = 0;
+
+    IVRT_STAT(NodeVisits);
+    /* Sort hit children by entry distance, farthest first */
+    for (INT i = 0; i < 8; i++)
+      if (mask & (1 << i))
+      {
+        INT j = no++;
+
+        for (; j > 0 && tn[order[j - 1]] < tn[i]; j--)
+          order[j] = order[j - 1];
+        order[j] = i;
+      }
+    for (INT j = 0; j < no; j++)
+    {
+      INT i = order[j];
+
+      stack[top] = N.Count[i] > 0 ? -1 - (n * 8 + i) : N.Child[i];
+      dist[top++] = tn[i];
+    }
+  }
+  return found;
+} /* End of 'ivrt::bvh::Intersection' function */
+
+/* Check if ray intersects any shape function.
+ * ARGUMENTS:
+ *   - ray:
+ *       const ray &R;
+ * RETURNS: (BOOL) TRUE if intersected.
+ */
+BOOL ivrt::bvh::IsIntersected( const ray &R ) const
+{
+  if (Nodes.empty())
+    return FALSE;
+
+  mth::inv_ray8 ir((inv_ray(R)));
+  tri_ray tr(R);
+  INT stack[BvhStackSize], top = 0;
+
+  stack[top++] = 0;
+  while (top > 0)
+  {
+    const node &N = Nodes[stack[--top]];
+    INT mask = N.Boxes.Intersect(ir, std::numeric_limits<FLT>::infinity());
+
+    IVRT_STAT(NodeVisits);
+    for (INT i = 0; i < 8; i++)
+      if (mask & (1 << i))
+      {
+        if (N.Count[i] == 0)
+        {
+          stack[top++] = N.Child[i];
+          continue;
+        }
+        if (N.Packet[i] >= 0)
+        {
+          DBL t, u, v;
+
+          IVRT_STAT_ADD(ShapeTests, N.Count[i]);
+          if (Packets[N.Packet[i]].Intersect(tr, HUGE_VAL, &t, &u, &v) >= 0)
+            return TRUE;
+          continue;
+        }
+        for (INT k = N.Child[i]; k < N.Child[i] + N.Count[i]; k++)
+        {
+          IVRT_STAT(ShapeTests);
+          if (Shapes[k]->IsIntersected(R))
+            return TRUE;
+        }
+      }
+  }
+  return FALSE;
+} /* End of 'ivrt::bvh::IsIntersected' function */
+
+/* END OF 'bvh.cpp' FILE */
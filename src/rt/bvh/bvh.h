@@ -0,0 +1,120 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : bvh.h
+ * PURPOSE     : Raytracing project.
+ *               Bounding volume hierarchy declaration module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __bvh_h_
+#define __bvh_h_
+
+#include <vector>
+
+#include "../../def.h"
+
+/* Project namespace */
+namespace ivrt
+{
+  class shape;
+  class intr;
+  class triangle8;
+
+  /* Eight-wide bounding volume hierarchy class.
+   * Every node keeps boxes of up to eight children in 'aabb8' lanes, so
+   * one slab test visits all of them; children are either nodes or leaves
+   * of a few shapes. Hierarchy is built over bounded shapes only, by
+   * median splits of shapes centers along the longest axis. Leaves of
+   * triangles only are also kept as 'triangle8' packets and tested at
+   * once, without virtual call per triangle. */
+  class bvh
+  {
+  private:
+    /* Hierarchy node */
+    struct node
+    {
+      mth::aabb8 Boxes; // children boxes
+      INT
+        Child[8],       // child node index or first leaf shape index
+        Count[8],       // number of leaf shapes (0 for child node)
+        Packet[8];      // leaf triangles packet index (-1 if leaf has other shapes)
+    }; /* End of 'node' structure */
+
+    std::vector<node> Nodes;          // nodes (root is first)
+    std::vector<shape *> Shapes;      // shapes in leaves order
+    std::vector<triangle8> Packets;   // triangles only leaves packets
+
+    /* Build subtree function.
+     * ARGUMENTS:
+     *   - shapes range:
+     *       INT First, Count;
+     *   - subtree root depth:
+     *       INT Depth;
+     * RETURNS: (INT) subtree root node index.
+     */
+    INT Build( INT First, INT Count, INT Depth );
+
+  public:
+    static const INT LeafSize = 4; // maximal number of shapes in leaf
+
+    /* Class constructor */
+    bvh( VOID );
+
+    /* Class destructor (packets type is complete in implementation only) */
+    ~bvh( VOID );
+
+    /* Build hierarchy function.
+     * ARGUMENTS:
+     *   - bounded shapes:
+     *       const std::vector<shape *> &NewShapes;
+     * RETURNS: None.
+     */
+    VOID Build( const std::vector<shape *> &NewShapes );
+
+    /* Check if hierarchy has no shapes function.
+     * ARGUMENTS: None.
+     * RETURNS: (BOOL) TRUE if hierarchy is empty.
+     */
+    BOOL IsEmpty( VOID ) const
+    {
+      return Shapes.empty();
+    } /* End of 'IsEmpty' function */
+
+    /* Get storage size function.
+     * ARGUMENTS: None.
+     * RETURNS: (size_t) size of nodes, leaf shapes references and packets in bytes.
+     */
+    size_t Size( VOID ) const;
+
+    /* Find closest intersection function.
+     * ARGUMENTS:
+     *   - ray:
+     *       const ray &R;
+     *   - intersection to be updated if closer one is found (Shp may be nullptr):
+     *       intr *Intr;
+     * RETURNS: (BOOL) TRUE if closer intersection is found.
+     */
+    BOOL Intersection( const ray &R, intr *Intr ) const;
+
+    /* Check if ray intersects any shape function.
+     * ARGUMENTS:
+     *   - ray:
+     *       const ray &R;
+     * RETURNS: (BOOL) TRUE if intersected.
+     */
+    BOOL IsIntersected( const ray &R ) const;
+  }; /* End of 'bvh' class */
+} /* end of 'ivrt' namespace */
+
+#endif /* __bvh_h_ */
+
+/* END OF 'bvh.h' FILE */
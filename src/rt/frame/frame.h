@@ -176,8 +176,6 @@ namespace ivrt
      */
     BOOL SaveTGA( VOID )
     {
-      std::string Addon = "CGSG_FOREVER";
-
       std::string FileName; 
       SYSTEMTIME st;
       GetLocalTime(&st);
@@ -192,8 +190,19 @@ namespace ivrt
         std::to_string(st.wMinute) + "_" +
         std::to_string(st.wSecond) + "_" +
         std::to_string(st.wMilliseconds) + ".tga";
+      return SaveTGA(path + "\\" + FileName);
+    } /* End of 'SaveTGA' function */
 
-      std::fstream f(path + "\\" + FileName, std::fstream::out | std::fstream::binary);
+    /* Save image to named TGA file function.
+     * ARGUMENTS:
+     *   - file name:
+     *       const std::string &FileName;
+     * RETURNS:
+     *   (BOOL) TRUE if ok, FALSE otherwise.
+     */
+    BOOL SaveTGA( const std::string &FileName )
+    {
+      std::fstream f(FileName, std::fstream::out | std::fstream::binary);
       tgaFILEHEADER fh;
       tgaFILEFOOTER ff;
       tgaEXTHEADER eh;
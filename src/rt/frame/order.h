@@ -0,0 +1,75 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : order.h
+ * PURPOSE     : Raytracing project.
+ *               Frame traversal order module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __order_h_
+#define __order_h_
+
+#include <vector>
+
+#include "../../def.h"
+
+/* Project namespace */
+namespace ivrt
+{
+  /* Grid traversal order */
+  enum PIXEL_ORDER
+  {
+    ORDER_SCANLINE, // rows from left to right
+    ORDER_MORTON,   // Z-order curve
+    ORDER_HILBERT   // Hilbert curve (neighbour cells are always adjacent)
+  }; /* End of 'PIXEL_ORDER' enum */
+
+  /* Build grid cells traversal order function.
+   * Curves are walked over the smallest power of two square holding the
+   * grid, cells outside grid are skipped.
+   * ARGUMENTS:
+   *   - order:
+   *       PIXEL_ORDER Order;
+   *   - grid size:
+   *       INT W, H;
+   *   - result cells indices (Y * W + X):
+   *       std::vector<INT> &Cells;
+   * RETURNS: None.
+   */
+  inline VOID GridOrder( PIXEL_ORDER Order, INT W, INT H, std::vector<INT> &Cells )
+  {
+    UINT n = 1, x, y;
+
+    Cells.clear();
+    if (Order == ORDER_SCANLINE)
+    {
+      for (INT i = 0; i < W * H; i++)
+        Cells.push_back(i);
+      return;
+    }
+    while (n < (UINT)W || n < (UINT)H)
+      n *= 2;
+    for (UINT d = 0; d < n * n; d++)
+    {
+      if (Order == ORDER_MORTON)
+        mth::MortonDecode(d, &x, &y);
+      else
+        mth::HilbertDecode(n, d, &x, &y);
+      if (x < (UINT)W && y < (UINT)H)
+        Cells.push_back(y * W + x);
+    }
+  } /* End of 'GridOrder' function */
+} /* end of 'ivrt' namespace */
+
+#endif /* __order_h_ */
+
+/* END OF 'order.h' FILE */
@@ -0,0 +1,534 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : area.h
+ * PURPOSE     : Raytracing project.
+ *               Area lights declaration class.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev.
+ * LAST UPDATE : 05.08.2021.
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __area_h_
+#define __area_h_
+
+#include "light.h"
+
+/* Project namespace */
+namespace ivrt
+{
+  /* Area light base class */
+  class area : public light
+  {
+  protected:
+    vec3 LgtPos, LgtColor; // light center and color
+
+    /* Fill light info by point on light surface function.
+     * ARGUMENTS:
+     *   - shaded point:
+     *      const vec3 &P;
+     *   - point on light surface:
+     *      vec3 Pos;
+     *   - information about light:
+     *      light_info *L;
+     * RETURNS: (DBL) attenuation factor.
+     */
+    DBL Fill( const vec3 &P, vec3 Pos, light_info *L )
+    {
+      DBL Dist = Pos.Distance(P);
+
+      L->L = (Pos - P).Normalizing();
+      L->Color = LgtColor;
+      L->Dist = Dist;
+
+      return mth::Min(1 / (Cc + Cl * Dist + Cq * Dist * Dist), 1.0);
+    } /* End of 'Fill' function */
+
+    /* Build orthonormal basis around direction function.
+     * ARGUMENTS:
+     *   - basis normal:
+     *      vec3 N;
+     *   - result tangent vectors:
+     *      vec3 *T, *B;
+     * RETURNS: None.
+     */
+    static VOID Basis( vec3 N, vec3 *T, vec3 *B )
+    {
+      vec3 A = fabs(N[0]) > 0.9 ? vec3(0, 1, 0) : vec3(1, 0, 0);
+
+      *T = (N % A).Normalizing();
+      *B = N % *T;
+    } /* End of 'Basis' function */
+
+    /* Map unit square sample to unit disk function (concentric mapping).
+     * ARGUMENTS:
+     *   - sample coordinates in [0, 1):
+     *      DBL U, V;
+     *   - result disk coordinates:
+     *      DBL *X, *Y;
+     * RETURNS: None.
+     */
+    static VOID ToDisk( DBL U, DBL V, DBL *X, DBL *Y )
+    {
+      DBL a = 2 * U - 1, b = 2 * V - 1, r, phi;
+
+      if (a == 0 && b == 0)
+      {
+        *X = *Y = 0;
+        return;
+      }
+      if (a * a > b * b)
+        r = a, phi = PI / 4 * (b / a);
+      else
+        r = b, phi = PI / 2 - PI / 4 * (a / b);
+      *X = r * cos(phi);
+      *Y = r * sin(phi);
+    } /* End of 'ToDisk' function */
+
+    /* Obtain point on light surface function.
+     * ARGUMENTS:
+     *   - shaded point:
+     *      const vec3 &P;
+     *   - sample coordinates in [0, 1):
+     *      DBL U, V;
+     * RETURNS: (vec3) point on light surface.
+     */
+    virtual vec3 SamplePoint( const vec3 &P, DBL U, DBL V )
+    {
+      return LgtPos;
+    } /* End of 'SamplePoint' function */
+
+    /* Obtain light surface area function.
+     * ARGUMENTS: None.
+     * RETURNS: (DBL) surface area.
+     */
+    virtual DBL Area( VOID )
+    {
+      return 0;
+    } /* End of 'Area' function */
+
+    /* Obtain light surface normal function.
+     * ARGUMENTS:
+     *   - point on light surface:
+     *      const vec3 &Q;
+     * RETURNS: (vec3) unit normal.
+     */
+    virtual vec3 Normal( const vec3 &Q )
+    {
+      return vec3(0, 1, 0);
+    } /* End of 'Normal' function */
+
+    /* Intersect ray with light surface function.
+     * ARGUMENTS:
+     *   - ray:
+     *      const ray &R;
+     *   - intersection distance (for output):
+     *      DBL *T;
+     * RETURNS: (BOOL) TRUE if light surface is hit, FALSE otherwise.
+     */
+    virtual BOOL Hit( const ray &R, DBL *T )
+    {
+      return FALSE;
+    } /* End of 'Hit' function */
+
+    /* Intersect ray with light plane function.
+     * ARGUMENTS:
+     *   - ray:
+     *      const ray &R;
+     *   - point on plane and plane normal:
+     *      const vec3 &Q, vec3 N;
+     *   - intersection distance (for output):
+     *      DBL *T;
+     * RETURNS: (BOOL) TRUE if plane is hit in front of ray origin, FALSE otherwise.
+     */
+    static BOOL HitPlane( const ray &R, const vec3 &Q, vec3 N, DBL *T )
+    {
+      DBL dn = N & R.Dir;
+
+      if (fabs(dn) < Threshold)
+        return FALSE;
+      *T = ((N & Q) - (N & R.Org)) / dn;
+      return *T > Threshold;
+    } /* End of 'HitPlane' function */
+
+  public:
+    DBL Power = 1; // emitted radiance scale (path tracing only)
+
+    /* Create area light function.
+     * ARGUMENTS:
+     *   - light center and color:
+     *      vec3 NLgtPos, NLgtColor;
+     *   - shadow rays budget:
+     *      INT NSamples;
+     * RETURNS: NONE.
+     */
+    area( vec3 NLgtPos, vec3 NLgtColor, INT NSamples ) : LgtPos(NLgtPos), LgtColor(NLgtColor)
+    {
+      Samples = mth::Max(NSamples, 1);
+    } /* End of 'area' function */
+
+    /* Get attenuation factor function (light center).
+     * ARGUMENTS:
+     *   - shaded point:
+     *      vec3 &P;
+     *   - information about light:
+     *      light_info *L;
+     * RETURNS: (DBL) result value.
+     */
+    DBL Shadow( vec3 &P, light_info *L ) override
+    {
+      return Fill(P, LgtPos, L);
+    } /* End of 'Shadow' function */
+
+    /* Get attenuation factor for one light surface sample function.
+     * ARGUMENTS:
+     *   - shaded point:
+     *      const vec3 &P;
+     *   - sample coordinates on light surface in [0, 1):
+     *      DBL U, V;
+     *   - information about light:
+     *      light_info *L;
+     * RETURNS: (DBL) result value.
+     */
+    DBL Sample( const vec3 &P, DBL U, DBL V, light_info *L ) override
+    {
+      return Fill(P, SamplePoint(P, U, V), L);
+    } /* End of 'Sample' function */
+
+    /* Check if light has no surface function.
+     * ARGUMENTS: None.
+     * RETURNS: (BOOL) FALSE.
+     */
+    BOOL IsDelta( VOID ) override
+    {
+      return FALSE;
+    } /* End of 'IsDelta' function */
+
+    /* Sample incident radiance function (uniform by surface area).
+     * ARGUMENTS: 
+     *   - shaded point:
+     *      const vec3 &P;
+     *   - sample coordinates in [0, 1):
+     *      DBL U, V;
+     *   - sampled direction, distance and radiance (for output):
+     *      light_info *L;
+     * RETURNS: (DBL) solid angle probability density (0 if sample failed).
+     */
+    DBL SampleLi( const vec3 &P, DBL U, DBL V, light_info *L ) override
+    {
+      vec3 Q = SamplePoint(P, U, V), N = Normal(Q);
+      DBL Dist = Q.Distance(P), cl;
+
+      if (Dist < Threshold)
+        return 0;
+      L->L = (Q - P) / Dist;
+      if ((cl = fabs(N & L->L)) < Threshold)
+        return 0;
+      L->Color = LgtColor * Power;
+      L->Dist = Dist;
+      return Dist * Dist / (cl * Area());
+    } /* End of 'SampleLi' function */
+
+    /* Intersect ray with light surface function.
+     * ARGUMENTS: 
+     *   - ray:
+     *      const ray &R;
+     *   - intersection distance (for output):
+     *      DBL *T;
+     *   - emitted radiance (for output):
+     *      vec3 *Le;
+     *   - solid angle density of sampling this direction by 'SampleLi' (for output):
+     *      DBL *Pdf;
+     * RETURNS: (BOOL) TRUE if light is hit, FALSE otherwise.
+     */
+    BOOL HitLight( const ray &R, DBL *T, vec3 *Le, DBL *Pdf ) override
+    {
+      DBL cl;
+
+      if (!Hit(R, T) || (cl = fabs(Normal(R(*T)) & R.Dir)) < Threshold)
+        return FALSE;
+      *Le = LgtColor * Power;
+      *Pdf = *T * *T / (cl * Area());
+      return TRUE;
+    } /* End of 'HitLight' function */
+  }; /* End of 'area' class */
+
+  /* Rectangle area light class */
+  class area_rect : public area
+  {
+  private:
+    vec3 Corner, Edge1, Edge2; // rectangle corner and edges
+  public:
+    /* Create rectangle light function.
+     * ARGUMENTS:
+     *   - rectangle corner and edges:
+     *      vec3 NCorner, NEdge1, NEdge2;
+     *   - light color:
+     *      vec3 NLgtColor;
+     *   - shadow rays budget:
+     *      INT NSamples;
+     * RETURNS: NONE.
+     */
+    area_rect( vec3 NCorner, vec3 NEdge1, vec3 NEdge2, vec3 NLgtColor, INT NSamples = 16 ) :
+      area(NCorner + NEdge1 * 0.5 + NEdge2 * 0.5, NLgtColor, NSamples),
+      Corner(NCorner), Edge1(NEdge1), Edge2(NEdge2)
+    {
+    } /* End of 'area_rect' function */
+
+    /* Obtain point on light surface function.
+     * ARGUMENTS:
+     *   - shaded point:
+     *      const vec3 &P;
+     *   - sample coordinates in [0, 1):
+     *      DBL U, V;
+     * RETURNS: (vec3) point on light surface.
+     */
+    vec3 SamplePoint( const vec3 &P, DBL U, DBL V ) override
+    {
+      return Corner + Edge1 * U + Edge2 * V;
+    } /* End of 'SamplePoint' function */
+
+    /* Obtain light surface area function.
+     * ARGUMENTS: None.
+     * RETURNS: (DBL) surface area.
+     */
+    DBL Area( VOID ) override
+    {
+      return !(Edge1 % Edge2);
+    } /* End of 'Area' function */
+
+    /* Obtain light surface normal function.
+     * ARGUMENTS:
+     *   - point on light surface:
+     *      const vec3 &Q;
+     * RETURNS: (vec3) unit normal.
+     */
+    vec3 Normal( const vec3 &Q ) override
+    {
+      return (Edge1 % Edge2).Normalizing();
+    } /* End of 'Normal' function */
+
+    /* Intersect ray with light surface function.
+     * ARGUMENTS:
+     *   - ray:
+     *      const ray &R;
+     *   - intersection distance (for output):
+     *      DBL *T;
+     * RETURNS: (BOOL) TRUE if light surface is hit, FALSE otherwise.
+     */
+    BOOL Hit( const ray &R, DBL *T ) override
+    {
+      if (!HitPlane(R, Corner, Normal(Corner), T))
+        return FALSE;
+
+      vec3 D = R(*T) - Corner;
+      DBL u = (D & Edge1) / Edge1.Length2(), v = (D & Edge2) / Edge2.Length2();
+
+      return u >= 0 && u <= 1 && v >= 0 && v <= 1;
+    } /* End of 'Hit' function */
+  }; /* End of 'area_rect' class */
+
+  /* Disk area light class */
+  class area_disk : public area
+  {
+  private:
+    vec3 T, B, N; // disk plane tangent vectors and normal
+    DBL Radius;   // disk radius
+  public:
+    /* Create disk light function.
+     * ARGUMENTS:
+     *   - disk center and normal:
+     *      vec3 NLgtPos, NNorm;
+     *   - disk radius:
+     *      DBL NRadius;
+     *   - light color:
+     *      vec3 NLgtColor;
+     *   - shadow rays budget:
+     *      INT NSamples;
+     * RETURNS: NONE.
+     */
+    area_disk( vec3 NLgtPos, vec3 NNorm, DBL NRadius, vec3 NLgtColor, INT NSamples = 16 ) :
+      area(NLgtPos, NLgtColor, NSamples), Radius(NRadius)
+    {
+      N = NNorm.Normalizing();
+      Basis(N, &T, &B);
+    } /* End of 'area_disk' function */
+
+    /* Obtain point on light surface function.
+     * ARGUMENTS:
+     *   - shaded point:
+     *      const vec3 &P;
+     *   - sample coordinates in [0, 1):
+     *      DBL U, V;
+     * RETURNS: (vec3) point on light surface.
+     */
+    vec3 SamplePoint( const vec3 &P, DBL U, DBL V ) override
+    {
+      DBL x, y;
+
+      ToDisk(U, V, &x, &y);
+      return LgtPos + T * (x * Radius) + B * (y * Radius);
+    } /* End of 'SamplePoint' function */
+
+    /* Obtain light surface area function.
+     * ARGUMENTS: None.
+     * RETURNS: (DBL) surface area.
+     */
+    DBL Area( VOID ) override
+    {
+      return PI * Radius * Radius;
+    } /* End of 'Area' function */
+
+    /* Obtain light surface normal function.
+     * ARGUMENTS:
+     *   - point on light surface:
+     *      const vec3 &Q;
+     * RETURNS: (vec3) unit normal.
+     */
+    vec3 Normal( const vec3 &Q ) override
+    {
+      return N;
+    } /* End of 'Normal' function */
+
+    /* Intersect ray with light surface function.
+     * ARGUMENTS:
+     *   - ray:
+     *      const ray &R;
+     *   - intersection distance (for output):
+     *      DBL *T;
+     * RETURNS: (BOOL) TRUE if light surface is hit, FALSE otherwise.
+     */
+    BOOL Hit( const ray &R, DBL *T ) override
+    {
+      return HitPlane(R, LgtPos, N, T) && R(*T).Distance2(LgtPos) <= Radius * Radius;
+    } /* End of 'Hit' function */
+  }; /* End of 'area_disk' class */
+
+  /* Sphere area light class */
+  class area_sphere : public area
+  {
+  private:
+    DBL Radius; // sphere radius
+  public:
+    /* Create sphere light function.
+     * ARGUMENTS:
+     *   - sphere center:
+     *      vec3 NLgtPos;
+     *   - sphere radius:
+     *      DBL NRadius;
+     *   - light color:
+     *      vec3 NLgtColor;
+     *   - shadow rays budget:
+     *      INT NSamples;
+     * RETURNS: NONE.
+     */
+    area_sphere( vec3 NLgtPos, DBL NRadius, vec3 NLgtColor, INT NSamples = 16 ) :
+      area(NLgtPos, NLgtColor, NSamples), Radius(NRadius)
+    {
+    } /* End of 'area_sphere' function */
+
+    /* Obtain point on light surface function.
+     * Sphere is seen from the shaded point as a disk orthogonal to view direction.
+     * ARGUMENTS:
+     *   - shaded point:
+     *      const vec3 &P;
+     *   - sample coordinates in [0, 1):
+     *      DBL U, V;
+     * RETURNS: (vec3) point on light surface.
+     */
+    vec3 SamplePoint( const vec3 &P, DBL U, DBL V ) override
+    {
+      vec3 T, B;
+      DBL x, y;
+
+      Basis((LgtPos - P).Normalizing(), &T, &B);
+      ToDisk(U, V, &x, &y);
+      return LgtPos + T * (x * Radius) + B * (y * Radius);
+    } /* End of 'SamplePoint' function */
+
+    /* Obtain cosine of half angle the sphere is seen at function.
+     * ARGUMENTS:
+     *   - shaded point:
+     *      const vec3 &P;
+     * RETURNS: (DBL) cosine value (-1 if point is inside sphere).
+     */
+    DBL CosMax( const vec3 &P )
+    {
+      DBL d2 = LgtPos.Distance2(P);
+
+      if (d2 <= Radius * Radius)
+        return -1;
+      return sqrt(1 - Radius * Radius / d2);
+    } /* End of 'CosMax' function */
+
+    /* Sample incident radiance function (uniform in visible cone).
+     * ARGUMENTS: 
+     *   - shaded point:
+     *      const vec3 &P;
+     *   - sample coordinates in [0, 1):
+     *      DBL U, V;
+     *   - sampled direction, distance and radiance (for output):
+     *      light_info *L;
+     * RETURNS: (DBL) solid angle probability density (0 if sample failed).
+     */
+    DBL SampleLi( const vec3 &P, DBL U, DBL V, light_info *L ) override
+    {
+      DBL cm = CosMax(P);
+
+      if (cm < 0)
+        return 0;
+
+      DBL
+        dc = LgtPos.Distance(P),
+        ct = 1 - U * (1 - cm), st = sqrt(mth::Max(0.0, 1 - ct * ct)),
+        phi = 2 * PI * V;
+      vec3 W = (LgtPos - P) / dc, T, B;
+
+      Basis(W, &T, &B);
+      L->L = W * ct + T * (st * cos(phi)) + B * (st * sin(phi));
+      L->Dist = dc * ct - sqrt(mth::Max(0.0, Radius * Radius - dc * dc * st * st));
+      L->Color = LgtColor * Power;
+      return 1 / (2 * PI * (1 - cm));
+    } /* End of 'SampleLi' function */
+
+    /* Intersect ray with light surface function.
+     * ARGUMENTS: 
+     *   - ray:
+     *      const ray &R;
+     *   - intersection distance (for output):
+     *      DBL *T;
+     *   - emitted radiance (for output):
+     *      vec3 *Le;
+     *   - solid angle density of sampling this direction by 'SampleLi' (for output):
+     *      DBL *Pdf;
+     * RETURNS: (BOOL) TRUE if light is hit, FALSE otherwise.
+     */
+    BOOL HitLight( const ray &R, DBL *T, vec3 *Le, DBL *Pdf ) override
+    {
+      DBL cm = CosMax(R.Org);
+
+      if (cm < 0)
+        return FALSE;
+
+      vec3 A = LgtPos - R.Org;
+      DBL oc = A & R.Dir, h2 = Radius * Radius - (A.Length2() - oc * oc);
+
+      if (oc < 0 || h2 < 0)
+        return FALSE;
+      *T = oc - sqrt(h2);
+      *Le = LgtColor * Power;
+      *Pdf = 1 / (2 * PI * (1 - cm));
+      return TRUE;
+    } /* End of 'HitLight' function */
+  }; /* End of 'area_sphere' class */
+} /* end of 'ivrt' namespace */
+
+#endif /* __area_h_ */
+
+/* END OF 'area.h' FILE */
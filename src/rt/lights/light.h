@@ -48,11 +48,17 @@ namespace ivrt
   {
   public:
     DBL Cc, Cl, Cq;
+    INT Samples; // shadow rays budget (1 for hard-edged lights)
  
-    light( VOID ) : Cc(1.0), Cl(0.01), Cq(0.01)
+    light( VOID ) : Cc(1.0), Cl(0.01), Cq(0.01), Samples(1)
     {
     } /* End of 'light' function */
 
+    /* Light class virtual destructor */
+    virtual ~light( VOID )
+    {
+    } /* End of '~light' function */
+
     /* Get attenuation factor function.
      * ARGUMENTS: 
      *   - input ray:
@@ -66,6 +72,67 @@ namespace ivrt
       return 0.0;
     } /* End of 'Shadow' function */
 
+    /* Get attenuation factor for one light surface sample function.
+     * ARGUMENTS: 
+     *   - shaded point:
+     *      const vec3 &P;
+     *   - sample coordinates on light surface in [0, 1):
+     *      DBL U, V;
+     *   - information about light:
+     *      light_info *L;
+     * RETURNS: (DBL) result value.
+     */
+    virtual DBL Sample( const vec3 &P, DBL U, DBL V, light_info *L )
+    {
+      vec3 Pos = P;
+
+      return Shadow(Pos, L);
+    } /* End of 'Sample' function */
+
+    /* Check if light has no surface (can't be hit by ray) function.
+     * ARGUMENTS: None.
+     * RETURNS: (BOOL) TRUE for point-like lights, FALSE otherwise.
+     */
+    virtual BOOL IsDelta( VOID )
+    {
+      return TRUE;
+    } /* End of 'IsDelta' function */
+
+    /* Sample incident radiance function (path tracing).
+     * ARGUMENTS: 
+     *   - shaded point:
+     *      const vec3 &P;
+     *   - sample coordinates in [0, 1):
+     *      DBL U, V;
+     *   - sampled direction, distance and radiance (for output):
+     *      light_info *L;
+     * RETURNS: (DBL) solid angle probability density (1 for delta lights, 0 if sample failed).
+     */
+    virtual DBL SampleLi( const vec3 &P, DBL U, DBL V, light_info *L )
+    {
+      DBL att = Sample(P, U, V, L);
+
+      L->Color = L->Color * att;
+      return 1;
+    } /* End of 'SampleLi' function */
+
+    /* Intersect ray with light surface function (path tracing).
+     * ARGUMENTS: 
+     *   - ray:
+     *      const ray &R;
+     *   - intersection distance (for output):
+     *      DBL *T;
+     *   - emitted radiance (for output):
+     *      vec3 *Le;
+     *   - solid angle density of sampling this direction by 'SampleLi' (for output):
+     *      DBL *Pdf;
+     * RETURNS: (BOOL) TRUE if light is hit, FALSE otherwise.
+     */
+    virtual BOOL HitLight( const ray &R, DBL *T, vec3 *Le, DBL *Pdf )
+    {
+      return FALSE;
+    } /* End of 'HitLight' function */
+
     /* Get color function.
      * ARGUMENTS: 
      *   - intersection info:
@@ -0,0 +1,339 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : path.cpp
+ * PURPOSE     : Raytracing project.
+ *               Monte Carlo path tracer implementation module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 07.08.2021
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#include "path.h"
+
+/* Build orthonormal basis around direction function.
+ * ARGUMENTS:
+ *   - basis normal:
+ *      vec3 N;
+ *   - result tangent vectors:
+ *      vec3 *T, *B;
+ * RETURNS: None.
+ */
+VOID ivrt::path_tracer::Basis( vec3 N, vec3 *T, vec3 *B )
+{
+  vec3 A = fabs(N[0]) > 0.9 ? vec3(0, 1, 0) : vec3(1, 0, 0);
+
+  *T = (N % A).Normalizing();
+  *B = N % *T;
+} /* End of 'ivrt::path_tracer::Basis' function */
+
+/* Build bsdf for intersection function.
+ * Lobes weights sum is scaled down to 1 if material reflects more than it gets.
+ * ARGUMENTS:
+ *   - incoming ray direction:
+ *       const vec3 &Dir;
+ *   - intersection (normal is already oriented towards ray, texture color is evaluated):
+ *       intr *I;
+ *   - is ray entering the shape flag:
+ *       BOOL IsEnter;
+ *   - result bsdf:
+ *       bsdf *B;
+ * RETURNS: None.
+ */
+VOID ivrt::path_tracer::MakeBsdf( const vec3 &Dir, intr *I, BOOL IsEnter, bsdf *B )
+{
+  const surface &Mtl = I->Shp->mtl;
+  vec3 D = Dir, Kd = Mtl.Kd * I->Color;
+  DBL
+    kd = (Kd[0] + Kd[1] + Kd[2]) / 3,
+    ks = (Mtl.Ks[0] + Mtl.Ks[1] + Mtl.Ks[2]) / 3,
+    sum = kd + ks + Mtl.Kr + Mtl.Kt,
+    scale = sum > 1 ? 1 / sum : 1;
+
+  B->N = I->N;
+  B->Refl = I->N.Reflect(D);
+  B->Kd = Kd * scale;
+  B->Ks = Mtl.Ks * scale;
+  B->Ph = Mtl.Ph;
+  B->Kr = Mtl.Kr * scale;
+  B->Kt = Mtl.Kt * scale;
+  if (sum > 0)
+    B->Pd = kd / sum, B->Ps = ks / sum, B->Pr = Mtl.Kr / sum, B->Pt = Mtl.Kt / sum;
+  else
+    B->Pd = B->Ps = B->Pr = B->Pt = 0;
+  B->Inner = IsEnter ? &Mtl.Env : &Air;
+} /* End of 'ivrt::path_tracer::MakeBsdf' function */
+
+/* Evaluate non-delta lobes function.
+ * ARGUMENTS:
+ *   - surface bsdf:
+ *       const bsdf &B;
+ *   - outgoing direction:
+ *       const vec3 &Wi;
+ *   - solid angle density of sampling 'Wi' by lobes sampling (for output):
+ *       DBL *Pdf;
+ * RETURNS: (vec3) bsdf value.
+ */
+ivrt::vec3 ivrt::path_tracer::EvalBsdf( const bsdf &B, const vec3 &Wi, DBL *Pdf )
+{
+  vec3 N = B.N, R = B.Refl;
+  DBL cn = N & Wi, lobe;
+
+  *Pdf = 0;
+  if (cn <= 0)
+    return vec3(0);
+  lobe = pow(mth::Max(R & Wi, 0.0), B.Ph);
+  *Pdf = B.Pd * cn / PI + B.Ps * (B.Ph + 1) / (2 * PI) * lobe;
+  return B.Kd * (1 / PI) + B.Ks * ((B.Ph + 2) / (2 * PI) * lobe);
+} /* End of 'ivrt::path_tracer::EvalBsdf' function */
+
+/* Estimate direct light by sampling one light function.
+ * ARGUMENTS:
+ *   - scene:
+ *       scene &Scene;
+ *   - shaded point:
+ *       const vec3 &P;
+ *   - surface bsdf:
+ *       const bsdf &B;
+ *   - light choice and light surface samples in [0, 1):
+ *       DBL Ul, U, V;
+ *   - ray time in shutter interval:
+ *       DBL Time;
+ * RETURNS: (vec3) reflected radiance.
+ */
+ivrt::vec3 ivrt::path_tracer::DirectLight( scene &Scene, const vec3 &P, const bsdf &B, DBL Ul, DBL U, DBL V, DBL Time )
+{
+  INT n = (INT)Scene.Lights.size();
+
+  if (n == 0)
+    return vec3(0);
+
+  light *Lgt = Scene.Lights[mth::Min((INT)(Ul * n), n - 1)];
+  light_info li;
+  DBL pl = Lgt->SampleLi(P, U, V, &li), pb;
+
+  if (pl <= 0)
+    return vec3(0);
+
+  vec3 f = EvalBsdf(B, li.L, &pb), N = B.N;
+
+  if (pb <= 0 || Scene.IsShadowed(P, li, Time))
+    return vec3(0);
+  return f * li.Color * ((N & li.L) * n / pl * (Lgt->IsDelta() ? 1 : PowerHeuristic(pl / n, pb)));
+} /* End of 'ivrt::path_tracer::DirectLight' function */
+
+/* Estimate radiance along ray function.
+ * ARGUMENTS:
+ *   - scene:
+ *       scene &Scene;
+ *   - camera ray:
+ *       ray R;
+ *   - started pixel sample generator:
+ *       sampler &Smp;
+ *   - camera ray differentials (followed through specular bounces only):
+ *       ray_diff Diff;
+ * RETURNS: (vec3) radiance estimation.
+ */
+ivrt::vec3 ivrt::path_tracer::Radiance( scene &Scene, ray R, sampler &Smp, ray_diff Diff )
+{
+  vec3 L(0), Beta(1);
+  const envi *Media = &Air;
+  BOOL IsSpecular = TRUE;
+  DBL BsdfPdf = 1;
+  INT NLights = (INT)Scene.Lights.size();
+
+  IVRT_STAT(TraceCalls);
+  for (INT depth = 0; ; depth++)
+  {
+    intr I;
+
+    IVRT_STAT(Bounces);
+    BOOL IsHit = Scene.Intersection(R, &I, depth == 0);
+    DBL tmin = IsHit ? I.T : HUGE_VAL, t, pdf, EmitPdf = 0;
+    vec3 Le, EmitLe;
+    light *Emit = nullptr;
+
+    /* Light surfaces are opaque emitters, their light is weighted against light sampling */
+    for (auto Lgt : Scene.Lights)
+      if (!Lgt->IsDelta() && Lgt->HitLight(R, &t, &Le, &pdf) && t < tmin)
+        tmin = t, Emit = Lgt, EmitLe = Le, EmitPdf = pdf;
+    if (Emit != nullptr)
+    {
+      L += Beta * EmitLe * (IsSpecular ? 1 : PowerHeuristic(BsdfPdf, EmitPdf / NLights));
+      break;
+    }
+    if (!IsHit)
+    {
+      L += Beta * Scene.Background;
+      break;
+    }
+    if (depth >= MaxDepth)
+      break;
+
+    if (!I.IsNorm)
+      I.Shp->GetNormal(&I);
+    if (!I.IsPos)
+      I.P = R(I.T);
+
+    BOOL IsEnter = (I.N & R.Dir) < 0;
+    bsdf B;
+
+    /* Every vertex takes the same sample dimensions whatever happens */
+    DBL ul, lu, lv, u, u1, u2, uf, ur;
+
+    ul = Smp.Get1D();
+    Smp.Get2D(&lu, &lv);
+    u = Smp.Get1D();
+    Smp.Get2D(&u1, &u2);
+    uf = Smp.Get1D();
+    ur = Smp.Get1D();
+
+    if (!IsEnter)
+      I.N = -I.N;
+    ray_diff HitDiff = Diff.Transfer(R, I.T, I.N);
+
+    Scene.Albedo(&I, HitDiff);
+    MakeBsdf(R.Dir, &I, IsEnter, &B);
+    if (B.IsSmooth())
+      L += Beta * DirectLight(Scene, I.P, B, ul, lu, lv, R.Time);
+
+    /* Choose one lobe and continue path */
+    vec3 Dir, T, Bt;
+
+    if (u < B.Pd + B.Ps)
+    {
+      DBL
+        c = u < B.Pd ? sqrt(1 - u1) : pow(u1, 1 / (B.Ph + 1)),
+        s = sqrt(mth::Max(0.0, 1 - c * c)),
+        phi = 2 * PI * u2;
+      vec3 Axis = u < B.Pd ? B.N : B.Refl;
+
+      Basis(Axis, &T, &Bt);
+      Dir = Axis * c + T * (s * cos(phi)) + Bt * (s * sin(phi));
+
+      vec3 f = EvalBsdf(B, Dir, &BsdfPdf);
+
+      if (BsdfPdf <= 0)
+        break;
+      Beta = Beta * f * ((I.N & Dir) / BsdfPdf);
+      IsSpecular = FALSE;
+      Diff = ray_diff();
+    }
+    else if (u < B.Pd + B.Ps + B.Pr)
+    {
+      Dir = B.Refl;
+      Beta = Beta * (B.Kr / B.Pr);
+      IsSpecular = TRUE;
+      Diff = HitDiff.Reflect(R, I.N);
+    }
+    else if (B.Pt > 0)
+    {
+      /* Snell's law and Fresnel term (Schlick approximation) choose reflection or refraction */
+      DBL
+        cosi = -(I.N & R.Dir),
+        n1 = Media->RefractionCoef,
+        n2 = B.Inner->RefractionCoef,
+        eta = n1 / n2,
+        k = 1 - eta * eta * (1 - cosi * cosi),
+        fresnel = 1;
+      BOOL IsRefr = FALSE;
+
+      if (k > 0)
+      {
+        DBL
+          cost = sqrt(k),
+          r0 = (n1 - n2) / (n1 + n2),
+          c = 1 - (n1 > n2 ? cost : cosi);
+
+        r0 *= r0;
+        fresnel = r0 + (1 - r0) * c * c * c * c * c;
+        if (uf >= fresnel)
+        {
+          Dir = R.Dir * eta + I.N * (eta * cosi - cost);
+          Media = B.Inner;
+          IsRefr = TRUE;
+        }
+        else
+          Dir = B.Refl;
+      }
+      else
+        Dir = B.Refl;
+      Diff = IsRefr ? HitDiff.Refract(R, I.N, Dir, eta) : HitDiff.Reflect(R, I.N);
+      Beta = Beta * (B.Kt / B.Pt);
+      IsSpecular = TRUE;
+    }
+    else
+      break;
+    R = ray(I.P + Dir * Threshold, Dir, R.Time);
+
+    /* Russian roulette */
+    if (depth + 1 >= RouletteDepth)
+    {
+      DBL q = mth::Min(mth::Max(Beta[0], mth::Max(Beta[1], Beta[2])), 0.95);
+
+      if (ur >= q)
+        break;
+      Beta = Beta / q;
+    }
+  }
+  return L;
+} /* End of 'ivrt::path_tracer::Radiance' function */
+
+/* Render frame part function.
+ * ARGUMENTS:
+ *   - scene to render:
+ *       scene &Scene;
+ *   - camera:
+ *       camera &Cam;
+ *   - frame to draw to:
+ *       frame &Frame;
+ *   - pixels rectangle:
+ *       INT X0, Y0, X1, Y1;
+ * RETURNS: None.
+ */
+VOID ivrt::path_tracer::Render( scene &Scene, camera &Cam, frame &Frame, INT X0, INT Y0, INT X1, INT Y1 )
+{
+  INT spp = mth::Max(SamplesPerPixel, 1);
+  sampler Smp(Sampler, Seed);
+  ray_gen Gen = CamEnd != nullptr ? ray_gen(Cam, *CamEnd) : ray_gen(Cam);
+
+  for (INT y = Y0; y < Y1; y++)
+    for (INT x = X0; x < X1; x++)
+    {
+      vec3 Color(0);
+      IVRT_STATS_ONLY(UINT64 Cost = stats::Local().Cost();)
+      BOOL IsSharp = !Gen.IsLens();
+      ray_diff D = Gen.Diff(x + 0.5, y + 0.5).Scale(1 / sqrt(spp));
+
+      /* Lens is not sampled if pixel center hit is in focus */
+      if (!IsSharp)
+      {
+        ray R = Gen.Get(x + 0.5, y + 0.5);
+        intr I;
+
+        IsSharp = Scene.Intersection(R, &I, TRUE) && Gen.IsInFocus(Gen.Depth(R(I.T)));
+      }
+      for (INT s = 0; s < spp; s++)
+      {
+        DBL jx, jy, lu = 0.5, lv = 0.5, t = 0;
+
+        Smp.Start(x, y, s);
+        Smp.Get2D(&jx, &jy);
+        if (!IsSharp)
+          Smp.Get2D(&lu, &lv);
+        if (CamEnd != nullptr)
+          t = Smp.Get1D();
+        Color += Radiance(Scene, Gen.Get(x + jx, y + jy, lu, lv, t), Smp, D);
+      }
+      Frame.PutPixel(x, y, frame::ToRGB(Color / spp));
+      IVRT_STATS_ONLY(stats::Get().PutCost(x, y, stats::Local().Cost() - Cost);)
+    }
+} /* End of 'ivrt::path_tracer::Render' function */
+
+/* END OF 'path.cpp' FILE */
@@ -0,0 +1,160 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : path.h
+ * PURPOSE     : Raytracing project.
+ *               Monte Carlo path tracer declaration module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 07.08.2021
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __path_h_
+#define __path_h_
+
+#include "../rt_def.h"
+#include "../frame/frame.h"
+
+/* Project namespace */
+namespace ivrt
+{
+  /* Monte Carlo path tracer class.
+   * Surface material is treated as mix of lobes: Lambert diffuse (Kd),
+   * normalized Phong glossy (Ks, Ph), ideal mirror (Kr) and Fresnel
+   * dielectric (Kt). Direct light is estimated both by light and by BSDF
+   * sampling and combined by multiple importance sampling (power heuristic).
+   * Ambient 'Ka' term is not used: indirect light and background do its job. */
+  class path_tracer
+  {
+  private:
+    /* Surface scattering lobes of one hit */
+    struct bsdf
+    {
+      vec3 N, Refl;              // oriented normal and mirror direction
+      vec3 Kd, Ks;               // scaled diffuse and glossy albedo
+      DBL Ph;                    // glossy exponent
+      DBL Kr, Kt;                // scaled mirror and transmission weights
+      DBL Pd, Ps, Pr, Pt;        // lobes selection probabilities
+      const envi *Inner;         // medium behind surface
+
+      /* Check if bsdf has non-delta lobes function.
+       * ARGUMENTS: None.
+       * RETURNS: (BOOL) TRUE if light sampling is useful.
+       */
+      BOOL IsSmooth( VOID ) const
+      {
+        return Pd + Ps > 0;
+      } /* End of 'IsSmooth' function */
+    }; /* End of 'bsdf' structure */
+
+    /* Build bsdf for intersection function.
+     * ARGUMENTS:
+     *   - incoming ray direction:
+     *       const vec3 &Dir;
+     *   - intersection (normal is already oriented towards ray):
+     *       intr *I;
+     *   - is ray entering the shape flag:
+     *       BOOL IsEnter;
+     *   - result bsdf:
+     *       bsdf *B;
+     * RETURNS: None.
+     */
+    static VOID MakeBsdf( const vec3 &Dir, intr *I, BOOL IsEnter, bsdf *B );
+
+    /* Evaluate non-delta lobes function.
+     * ARGUMENTS:
+     *   - surface bsdf:
+     *       const bsdf &B;
+     *   - outgoing direction:
+     *       const vec3 &Wi;
+     *   - solid angle density of sampling 'Wi' by lobes sampling (for output):
+     *       DBL *Pdf;
+     * RETURNS: (vec3) bsdf value.
+     */
+    static vec3 EvalBsdf( const bsdf &B, const vec3 &Wi, DBL *Pdf );
+
+    /* Build orthonormal basis around direction function.
+     * ARGUMENTS:
+     *   - basis normal:
+     *      vec3 N;
+     *   - result tangent vectors:
+     *      vec3 *T, *B;
+     * RETURNS: None.
+     */
+    static VOID Basis( vec3 N, vec3 *T, vec3 *B );
+
+    /* Power heuristic MIS weight function.
+     * ARGUMENTS:
+     *   - density of used and other strategy:
+     *      DBL Pf, Pg;
+     * RETURNS: (DBL) weight of used strategy sample.
+     */
+    static DBL PowerHeuristic( DBL Pf, DBL Pg )
+    {
+      return Pf * Pf / (Pf * Pf + Pg * Pg);
+    } /* End of 'PowerHeuristic' function */
+
+    /* Estimate direct light by sampling one light function.
+     * ARGUMENTS:
+     *   - scene:
+     *       scene &Scene;
+     *   - shaded point:
+     *       const vec3 &P;
+     *   - surface bsdf:
+     *       const bsdf &B;
+     *   - light choice and light surface samples in [0, 1):
+     *       DBL Ul, U, V;
+     *   - ray time in shutter interval:
+     *       DBL Time;
+     * RETURNS: (vec3) reflected radiance.
+     */
+    vec3 DirectLight( scene &Scene, const vec3 &P, const bsdf &B, DBL Ul, DBL U, DBL V, DBL Time );
+
+  public:
+    INT
+      SamplesPerPixel = 16, // paths per pixel budget
+      MaxDepth = 8,         // maximal path length
+      RouletteDepth = 3;    // path length russian roulette starts from
+    mth::sampler_type Sampler = mth::SAMPLER_SOBOL; // pixel samples sequence
+    UINT Seed = 0;                                  // frame samples seed
+    const camera *CamEnd = nullptr;                 // camera at shutter close (nullptr - no motion blur)
+
+    /* Estimate radiance along ray function.
+     * ARGUMENTS:
+     *   - scene:
+     *       scene &Scene;
+     *   - camera ray:
+     *       ray R;
+     *   - started pixel sample generator:
+     *       sampler &Smp;
+     *   - camera ray differentials (followed through specular bounces only):
+     *       ray_diff Diff;
+     * RETURNS: (vec3) radiance estimation.
+     */
+    vec3 Radiance( scene &Scene, ray R, sampler &Smp, ray_diff Diff = ray_diff() );
+
+    /* Render frame part function.
+     * ARGUMENTS:
+     *   - scene to render:
+     *       scene &Scene;
+     *   - camera:
+     *       camera &Cam;
+     *   - frame to draw to:
+     *       frame &Frame;
+     *   - pixels rectangle:
+     *       INT X0, Y0, X1, Y1;
+     * RETURNS: None.
+     */
+    VOID Render( scene &Scene, camera &Cam, frame &Frame, INT X0, INT Y0, INT X1, INT Y1 );
+  }; /* End of 'path_tracer' class */
+} /* end of 'ivrt' namespace */
+
+#endif /* __path_h_ */
+
+/* END OF 'path.h' FILE */
@@ -17,21 +17,68 @@
 
 #include "rt.h"
 
+/* Prepare scene for frame rendering function.
+ * ARGUMENTS: 
+ *   - frame camera:
+ *      const camera &Cam;
+ *   - cull by camera frustum flag (off if camera moves during frame):
+ *      BOOL IsCull;
+ * RETURNS: None.
+ */
+VOID ivrt::scene::Update( const camera &Cam, BOOL IsCull )
+{
+  if (!IsBuilt)
+  {
+    IVRT_PROFILE("BVH build");
+
+    Bounded.clear();
+    Unbounded.clear();
+    for (auto Shp : Shapes)
+      (Shp->IsBounded() ? Bounded : Unbounded).push_back(Shp);
+    All.Build(Bounded);
+    IsBuilt = TRUE;
+  }
+
+  Textures.Frame();
+  if (!(IsCulled = IsCull))
+    return;
+
+  IVRT_PROFILE("Frustum cull");
+  frustum F = Cam.GetFrustum();
+  std::vector<shape *> vis;
+
+  for (auto Shp : Bounded)
+    if (F.IsVisible(Shp->Bounds()))
+      vis.push_back(Shp);
+  Visible.Build(vis);
+} /* End of 'ivrt::scene::Update' function */
+
 /* Find intersection function.
  * ARGUMENTS: 
  *   - input ray:
  *      const ray &R;
  *   - intersection point on ray:
  *      intr *Intr;
+ *   - camera ray flag (only shapes inside camera frustum are tested):
+ *      BOOL IsPrimary;
  * RETURNS: (BOOL) TRUE if success, FALSE otherwise.
  */
-BOOL ivrt::scene::Intersection( const ray &R, intr *Intr )
+BOOL ivrt::scene::Intersection( const ray &R, intr *Intr, BOOL IsPrimary )
 {
-  intr intersection, closest_intersection;
+  intr closest_intersection;
+  const std::vector<shape *> &Linear = IsBuilt ? Unbounded : Shapes;
 
-  for (INT i = 0; i < Shapes.size(); i++)
+  IVRT_STAT(Rays);
+  if (IsPrimary)
+    IVRT_STAT(PrimaryRays);
+  if (IsBuilt)
+    (IsPrimary && IsCulled ? Visible : All).Intersection(R, &closest_intersection);
+  for (INT i = 0; i < Linear.size(); i++)
   {
-    if ((Shapes[i]->Intersection(R, &intersection)) && 
+    intr intersection;
+
+    IVRT_STAT(ShapeTests);
+    if ((Linear[i]->Intersection(R, &intersection)) && 
          ((closest_intersection.Shp == nullptr) || (closest_intersection.T > intersection.T)))
       closest_intersection = intersection;
   }
@@ -50,17 +97,112 @@ BOOL ivrt::scene::Intersection( const ray &R, intr *Intr )
  */
 BOOL ivrt::scene::IsIntersected( const ray &R )
 {
-  intr intersection, closest_intersection;
+  const std::vector<shape *> &Linear = IsBuilt ? Unbounded : Shapes;
 
-  for (INT i = 0; i < Shapes.size(); i++)
+  IVRT_STAT(Rays);
+  if (IsBuilt && All.IsIntersected(R))
+    return TRUE;
+  for (INT i = 0; i < Linear.size(); i++)
   {
-    if (Shapes[i]->IsIntersected(R)) 
+    IVRT_STAT(ShapeTests);
+    if (Linear[i]->IsIntersected(R)) 
       return TRUE;
   }
 
-  return closest_intersection.Shp != nullptr;
+  return FALSE;
 } /* End of 'ivrt::scene::IsIntersected' function */
 
+/* Check if light sample is occluded function.
+ * ARGUMENTS: 
+ *   - shaded point:
+ *      const vec3 &P;
+ *   - light sample info:
+ *      const light_info &L;
+ *   - ray time in shutter interval:
+ *      DBL Time;
+ * RETURNS: (BOOL) TRUE if occluded, FALSE otherwise.
+ */
+BOOL ivrt::scene::IsShadowed( const vec3 &P, const light_info &L, DBL Time )
+{
+  intr I;
+
+  IVRT_STAT(ShadowRays);
+  return Intersection(ray(P + L.L * Threshold, L.L, Time), &I) && I.T + Threshold < L.Dist;
+} /* End of 'ivrt::scene::IsShadowed' function */
+
+/* Get visible fraction of light function.
+ * Area lights are sampled by scrambled (0, 2)-sequence points, so every
+ * power of two prefix is stratified over light surface. First 'ShadowPilot'
+ * samples decide if point lies in penumbra, only there whole budget is spent.
+ * ARGUMENTS: 
+ *   - shaded point:
+ *      const vec3 &P;
+ *   - light source:
+ *      light *Lgt;
+ *   - light center info:
+ *      const light_info &L;
+ *   - ray time in shutter interval:
+ *      DBL Time;
+ * RETURNS: (DBL) visible fraction in [0, 1].
+ */
+DBL ivrt::scene::Visibility( const vec3 &P, light *Lgt, const light_info &L, DBL Time )
+{
+  if (Lgt->Samples <= 1)
+    return IsShadowed(P, L, Time) ? 0 : 1;
+
+  UINT
+    ScrambleU = mth::Rng().Next(),
+    ScrambleV = mth::Rng().Next();
+  INT i, n = Lgt->Samples, pilot = mth::Min(mth::Max(ShadowPilot, 1), n), lit = 0;
+  light_info li;
+
+  for (i = 0; i < pilot; i++)
+  {
+    Lgt->Sample(P, mth::VanDerCorput(i, ScrambleU), mth::Sobol2(i, ScrambleV), &li);
+    lit += !IsShadowed(P, li, Time);
+  }
+  if (lit == 0 || lit == pilot)
+    return (DBL)lit / pilot;
+  for (; i < n; i++)
+  {
+    Lgt->Sample(P, mth::VanDerCorput(i, ScrambleU), mth::Sobol2(i, ScrambleV), &li);
+    lit += !IsShadowed(P, li, Time);
+  }
+  return (DBL)lit / n;
+} /* End of 'ivrt::scene::Visibility' function */
+
+/* Get light contribution to point without occlusion function.
+ * ARGUMENTS: 
+ *   - intersection point (normal faces the viewer):
+ *       intr *Inter;
+ *   - reflected view direction:
+ *       vec3 &R;
+ *   - light source:
+ *       light *Lgt;
+ *   - light center info (for output):
+ *       light_info *L;
+ *   - light contribution (for output):
+ *       vec3 *Color;
+ * RETURNS: (BOOL) TRUE if light contributes to point, FALSE otherwise.
+ */
+BOOL ivrt::scene::LightShade( intr *Inter, vec3 &R, light *Lgt, light_info *L, vec3 *Color )
+{
+  vec3 Diffuse(0), Specular(0);
+  DBL
+    att = Lgt->Shadow(Inter->P, L),
+    nl = Inter->N & L->L,
+    rl = R & L->L;
+
+  if (nl <= Threshold && rl <= Threshold)
+    return FALSE;
+  if (nl > Threshold)
+    Diffuse = L->Color * Inter->Shp->mtl.Kd * Inter->Color * nl;
+  if (rl > Threshold)
+    Specular = L->Color * pow(rl, Inter->Shp->mtl.Ph);
+  *Color = (Diffuse + Specular) * att;
+  return TRUE;
+} /* End of 'ivrt::scene::LightShade' function */
+
 /* Get color of factor function.
  * ARGUMENTS: 
  *   - input ray:
@@ -73,54 +215,124 @@ BOOL ivrt::scene::IsIntersected( const ray &R )
  *       light_info *L;
  *   - weight of lighting:
  *       DBL Weight;
+ *   - ray time in shutter interval:
+ *       DBL Time;
+ *   - ray differentials transferred to intersection:
+ *       const ray_diff &Diff;
  * RETURNS: (vec3 ) result color.
  */
-ivrt::vec3 ivrt::scene::Shade( vec3 &Dir, const envi &Media, intr *Inter, DBL Weight )
+ivrt::vec3 ivrt::scene::Shade( vec3 &Dir, const envi &Media, intr *Inter, DBL Weight, DBL Time, const ray_diff &Diff )
 {
+  IVRT_STAT(ShadeCalls);
   DBL vn = Inter->N & Dir;
   if (vn > 0)
     vn = -vn, Inter->N = -Inter->N;
 
-  vec3 Diffuse = vec3(0), Specular = vec3(0), Ambient = vec3(0.1), Color(0);
+  vec3 Ambient = Inter->Shp->mtl.Ka * Albedo(Inter, Diff), Color(0);
   //vec3 R = Dir - Inter->N * (2 * (Dir & Inter->N));
   vec3 R = Inter->N.Reflect(Dir);
   for (auto OneLight : Lights)
   {
-    intr I;
-
     light_info li;
-      
-    DBL att = OneLight->Shadow(Inter->P, &li);
-    vec3 
-      L = li.L,
-      V = Dir;
-    Ambient = Inter->Shp->mtl.Ka;
-    //vec3 N = Inter->N * (-V & Inter->N);
-    //vec3 R = V - N * 2 * (V & N);
-    //vec3 R = N.Reflect(V);
-    DBL nl = Inter->N & L;
-    if (nl > Threshold)
-      Diffuse = Diffuse + li.Color * Inter->Shp->mtl.Kd * att * nl;
-    DBL rl = R & L;
-
-    if (rl > Threshold)
-      Specular = Specular + li.Color * pow(rl, Inter->Shp->mtl.Ph);
-
-    if (Intersection(ray(Inter->P + L * Threshold, L), &I) && (I.T + Threshold > li.Dist))
-      Color += (Diffuse + Specular) * att * 0.10;
-    else
-      Color += (Diffuse + Specular) * att;
-    /*
-    if (!Inter->add[4])
-      Color = Inter->Shp->mtl.Ka + Inter->Shp->mtl.Kd * Diffuse + Inter->Shp->mtl.Ks * Specular;
-    else
-      Color  = GetKa(Inter->P + R * Threshold) + Inter->Shp->mtl.Kd * Diffuse + Inter->Shp->mtl.Ks * Specular;
-    */
+    vec3 LightColor;
+
+    if (LightShade(Inter, R, OneLight, &li, &LightColor))
+      Color += LightColor * (ShadowCoef + (1 - ShadowCoef) * Visibility(Inter->P, OneLight, li, Time));
   }
   return mth::vec3<DBL>::ClampV((Ambient + Color) * Weight);
 } /* End of 'ivrt::scene::Shade' function */
 
+/* Decide if secondary ray is worth tracing function.
+ * Rays lighter than 'MinWeight' are dropped, rays lighter than
+ * 'RouletteWeight' survive with probability proportional to their weight
+ * and are boosted back to 'RouletteWeight', so estimate stays unbiased
+ * while reflection/transmission tree is pruned.
+ * ARGUMENTS: 
+ *   - ray weight (boosted if ray survived russian roulette):
+ *       DBL *Weight;
+ * RETURNS: (BOOL) TRUE if ray should be traced, FALSE otherwise.
+ */
+BOOL ivrt::scene::Survive( DBL *Weight )
+{
+  if (*Weight >= RouletteWeight)
+    return TRUE;
+  if (*Weight < MinWeight || mth::Rnd1F() * RouletteWeight >= *Weight)
+    return FALSE;
+  *Weight = RouletteWeight;
+  return TRUE;
+} /* End of 'ivrt::scene::Survive' function */
+
+/* Spawn secondary rays function.
+ * ARGUMENTS: 
+ *   - incoming ray:
+ *       const ray &R;
+ *   - incoming ray environment:
+ *       const envi &Media;
+ *   - intersection point (normal faces the ray):
+ *       intr *Intr;
+ *   - is ray entering the shape flag:
+ *       BOOL IsEnter;
+ *   - incoming ray weight and depth:
+ *       DBL Weight; INT RecLevel;
+ *   - spawned rays (for output, at least 2 entries):
+ *       trace_task *Tasks;
+ *   - incoming ray differentials transferred to intersection:
+ *       const ray_diff &Diff;
+ * RETURNS: (INT) number of spawned rays.
+ */
+INT ivrt::scene::Scatter( const ray &R, const envi &Media, intr *Intr, BOOL IsEnter,
+                          DBL Weight, INT RecLevel, trace_task *Tasks, const ray_diff &Diff )
+{
+  if (RecLevel + 1 >= MaxRecLevel)
+    return 0;
+
+  /* Snell's law and Fresnel term (Schlick approximation) */
+  const surface &Mtl = Intr->Shp->mtl;
+  const envi &NewMedia = IsEnter ? Mtl.Env : Air;
+  vec3 Dir = R.Dir, refrdir(0);
+  INT n = 0;
+  DBL
+    cosi = -(Intr->N & Dir),
+    n1 = Media.RefractionCoef,
+    n2 = NewMedia.RefractionCoef,
+    eta = n1 / n2,
+    k = 1 - eta * eta * (1 - cosi * cosi),
+    fresnel = 1;
+
+  if (Mtl.Kt > 0 && k > 0)
+  {
+    DBL
+      cost = sqrt(k),
+      r0 = (n1 - n2) / (n1 + n2),
+      c = 1 - (n1 > n2 ? cost : cosi);
+
+    r0 *= r0;
+    fresnel = r0 + (1 - r0) * c * c * c * c * c;
+    refrdir = Dir * eta + Intr->N * (eta * cosi - cost);
+  }
+
+  /* Total internal reflection goes to reflected ray */
+  DBL
+    wr = Weight * (Mtl.Kr + Mtl.Kt * fresnel),
+    wt = Weight * Mtl.Kt * (1 - fresnel);
+
+  if (fresnel < 1 && Survive(&wt))
+    Tasks[n++] = trace_task(ray(Intr->P + refrdir * Threshold, refrdir, R.Time), &NewMedia, wt, RecLevel + 1,
+                            Diff.Refract(R, Intr->N, refrdir, eta));
+  if (Survive(&wr))
+  {
+    vec3 reflraydir = Intr->N.Reflect(Dir);
+
+    Tasks[n++] = trace_task(ray(Intr->P + reflraydir * Threshold, reflraydir, R.Time), &Media, wr, RecLevel + 1,
+                            Diff.Reflect(R, Intr->N));
+  }
+  return n;
+} /* End of 'ivrt::scene::Scatter' function */
+
 /* Trace ray function.
+ * Secondary rays are not traced recursively, but put to small fixed stack
+ * of pending rays. Color of ray tree is sum of weighted node colors, so
+ * order of evaluation doesn't matter.
  * ARGUMENTS: 
  *   - input ray:
  *       const ray &R;
@@ -130,61 +342,57 @@ ivrt::vec3 ivrt::scene::Shade( vec3 &Dir, const envi &Media, intr *Inter, DBL We
  *       DBL Weight;
  *   - Current recursion level:
  *       INT RecLevel; 
+ *   - ray differentials (no texture filtering if unknown):
+ *       const ray_diff &Diff;
  * RETURNS: (vec3 ) result color.
  */
-ivrt::vec3 ivrt::scene::Trace( ray &R, const envi &Media, DBL Weight, INT RecLevel )
+ivrt::vec3 ivrt::scene::Trace( ray &R, const envi &Media, DBL Weight, INT RecLevel, const ray_diff &Diff )
 {
-  vec3 color = Background;
+  trace_task Stack[MaxTraceStack];
+  INT Top = 0;
+  vec3 color(0);
 
-  if (RecLevel < MaxRecLevel)
+  IVRT_STAT(TraceCalls);
+  if (RecLevel >= MaxRecLevel)
+    return Background;
+  Stack[Top++] = trace_task(R, &Media, Weight, RecLevel, Diff);
+  while (Top > 0)
   {
+    trace_task Task = Stack[--Top];
     intr Intr;
-    if (Intersection(R, &Intr))
+
+    IVRT_STAT(Bounces);
+    if (!Intersection(Task.R, &Intr, Task.RecLevel == 0))
     {
-      if (!Intr.IsNorm)
-        Intr.Shp->GetNormal(&Intr);
-      //if (!Intr.IsPos)
-      //  Intr.P = R(Intr.T);
-      color = Shade(R.Dir, Media, &Intr, Weight);
-      /*
-      DBL fogcoef = exp(-0.007 * Intr.T);
-      DBL interpfog = 0;
-      
-      if (Intr.T < FogStart)
-        interpfog = 1;
-      else if (Intr.T > FogEnd)
-        interpfog = 0;
-      else 
-        interpfog = (Intr.T - FogStart) / (FogEnd - FogStart);
-
-      color = color * fogcoef + FogColor * (1 - fogcoef);
-      */
-      vec3 reflraydir = Intr.N.Reflect(R.Dir);
-
-      //DBL wt = Weight * Intr.Shp->mtl.Kr;
-      //if (wt > Threshold)
-        //color += Trace(ray(Intr.Shd.P + R.oooo
-        // Dir * Threshold, R.Dir), Media, wr) * Shd.mtl.Krefl;
-      ray NewR(Intr.P + reflraydir * Threshold, reflraydir);
-
-      Weight *= Intr.Shp->mtl.Kr;
-      if (Weight > 0.1)
-        color += Trace(NewR, Media, Weight, ++RecLevel);
-      
-      //DBL rc = Weight * Intr.Shp->mtl.Kt;
-      
-      //if (rc > Threshold)
-      //{
-      //  vec3 v = R.Dir;
-
-      //  DBL cosa = -v & Intr.N;
-      //  DBL ETAratio = /* Intr.Shp-> */Media.RefractionCoef / Glass.RefractionCoef;
-      //  
-      //  //vec3 T = ETAratio * (v - Intr.N);
-      //}
+      color += Background * Task.Weight;
+      continue;
     }
+    if (!Intr.IsNorm)
+      Intr.Shp->GetNormal(&Intr);
+    if (!Intr.IsPos)
+      Intr.P = Task.R(Intr.T);
+
+    BOOL IsEnter = (Intr.N & Task.R.Dir) < 0;
+    ray_diff HitDiff = Task.Diff.Transfer(Task.R, Intr.T, Intr.N);
+
+    color += Shade(Task.R.Dir, *Task.Media, &Intr, Task.Weight, Task.R.Time, HitDiff);
+    /*
+    DBL fogcoef = exp(-0.007 * Intr.T);
+    DBL interpfog = 0;
+    
+    if (Intr.T < FogStart)
+      interpfog = 1;
+    else if (Intr.T > FogEnd)
+      interpfog = 0;
+    else 
+      interpfog = (Intr.T - FogStart) / (FogEnd - FogStart);
+
+    color = color * fogcoef + FogColor * (1 - fogcoef);
+    */
+    if (Top + 2 <= MaxTraceStack)
+      Top += Scatter(Task.R, *Task.Media, &Intr, IsEnter, Task.Weight, Task.RecLevel, Stack + Top, HitDiff);
   }
   return color;
-}
+} /* End of 'ivrt::scene::Trace' function */
 
-/* END OF 'rt.cpp' FILE */
\ No newline at end of file
+/* END OF 'rt.cpp' FILE */
@@ -24,6 +24,12 @@
 #include "shapes/plane.h"
 #include "shapes/box.h"
 #include "shapes/triangle.h"
+#include "shapes/triangle8.h"
+#include "shapes/mesh.h"
+#include "shapes/qmesh.h"
+#include "shapes/quadric.h"
+#include "shapes/csg.h"
+#include "shapes/instance.h"
 
 #endif /* __rt_h_ */
 
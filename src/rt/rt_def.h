@@ -21,15 +21,21 @@
 #include "../def.h"
 
 #include "lights/light.h"
+#include "bvh/bvh.h"
+#include "stats/stats.h"
+#include "stats/profiler.h"
+#include "textures/texture.h"
+#include "textures/procedural.h"
 
 /* Project namespace */
 namespace ivrt
 {
-  const DBL FogStart = 10;
-  const DBL FogEnd = 50;
-  const vec3 FogColor(0.1, 0.2, 0.5);
+  constexpr DBL FogStart = 10;
+  constexpr DBL FogEnd = 50;
+  constexpr vec3 FogColor(0.1, 0.2, 0.5);
 
-  const static DBL Threshold = 0.0001;
+  constexpr DBL Threshold = 0.0001;
+  constexpr DBL ShadowCoef = 0.1; // light fraction left in full shadow
   class shape;
   
   /* Common entry type */
@@ -46,25 +52,45 @@ namespace ivrt
   public:
     DBL T;            // Intersection dist 
     shape *Shp;       // Shape             
-    vec3 Color;       // Color 
+    vec3 Color;       // Surface texture color (white if untextured)
     vec3 N;           // Normal            
     BOOL IsPos;       // Flag eval pos     
     BOOL IsNorm;      // Flag eval normal  
     vec3 P;           // Position
+    DBL Time;         // Ray time (for moving shapes)
+    ENTRY_TYPE Entry; // Enter/leave state (for all intersections lists)
 
     BOOL add[5] = {0};
     INT I[5];         // Addon (INT)       
     DBL D[5];         // Addon (DOUBLE)    
 
     /* Intr class constructor */
-    intr( VOID ) : IsNorm(FALSE), IsPos(FALSE)
+    intr( VOID ) : T(0), Shp(nullptr), Color(1), IsNorm(FALSE), IsPos(FALSE), Time(0), Entry(STAY)
     {
     } /* End of 'intr' function */
-    intr( shape *NShp, DBL NewT ) : IsNorm(FALSE), Shp(NShp), T(NewT) 
+    intr( shape *NShp, DBL NewT, ENTRY_TYPE NEntry = STAY ) : T(NewT), Shp(NShp), Color(1), IsPos(FALSE), IsNorm(FALSE), Time(0), Entry(NEntry)
     {
     } /* End of 'intr' function */
   }; /* End of 'intr' class */
 
+  /* Environment class */
+  class envi
+  {
+  public:
+    DBL RefractionCoef; // index of refraction
+    DBL DecayCoef;
+    constexpr envi( DBL NRefractionCoef, DBL NDecayCoef ) noexcept : RefractionCoef(NRefractionCoef), DecayCoef(NDecayCoef)
+    {
+    }
+    constexpr envi( VOID ) noexcept : RefractionCoef(1), DecayCoef(1)
+    {
+    }
+
+  }; /* End of 'envi' class */
+  
+  constexpr envi Air(1, 1);
+  constexpr envi Glass(1.517, 1);
+
   /* Surface class */
   class surface
   {
@@ -72,48 +98,86 @@ namespace ivrt
     std::string Name; // material name
     vec3 Ka, Kd, Ks;  // ambient, diffuse, specular
     DBL Ph;           // Bui Tong Phong coefficient
-    DBL Kr, Kt;       // reflected, transmitted
-    surface( VOID ) : Ka(vec3(0.23125)), Kd(vec3(0.2775)), Ks(vec3(0.773911)), Kr(0.4), Kt(0.1), Ph(89.6)
+    DBL Kr, Kt;       // reflected, transmitted (only transparent materials set Kt)
+    envi Env;         // inner environment (for transmitted rays)
+    texture *Map = nullptr; // ambient and diffuse color map (owned by scene texture cache)
+    DBL MapScale = 1;       // texture coordinates scale (map repeats)
+    std::shared_ptr<const proc_texture> Proc; // procedural color (multiplies map color)
+    surface( VOID ) : Ka(vec3(0.23125)), Kd(vec3(0.2775)), Ks(vec3(0.773911)), Kr(0.4), Kt(0), Ph(89.6), Env(Glass)
     {
     }
-    surface( vec3 NKa, vec3 NKd, vec3 NKs, DBL NPh, DBL NKr, DBL NKt ) :
-      Ka(NKa), Kd(NKd), Ks(NKs), Kr(NKr), Kt(NKt), Ph(NPh)
+    surface( vec3 NKa, vec3 NKd, vec3 NKs, DBL NPh, DBL NKr, DBL NKt, envi NEnv = Glass ) :
+      Ka(NKa), Kd(NKd), Ks(NKs), Kr(NKr), Kt(NKt), Ph(NPh), Env(NEnv)
     {
     }
   }; /* End of 'surface' class */
 
-  /* All intersections list */
+  /* All intersections list.
+   * Fixed capacity buffer on stack: CSG evaluation builds lists for every
+   * node on every ray, so no heap allocations are made. Intersections are
+   * added in distance order; ones past capacity are dropped and list
+   * remembers distance from which it is incomplete. */
   struct intr_list 
   {
   public:
-    std::vector<intr> I_list; 
-  }; /* End of 'intr_list ' class */
+    static const INT Capacity = 16; // maximal number of intersections
+    intr I[Capacity];               // intersections
+    INT N = 0;                      // number of intersections
+    DBL Complete = HUGE_VAL;        // all intersections closer than this distance are kept
 
-  /* Environment class */
-  class envi
-  {
-  public:
-    DBL RefractionCoef;
-    DBL DecayCoef;
-    envi( DBL NRefractionCoef, DBL NDecayCoef ) : DecayCoef(NDecayCoef), RefractionCoef(NRefractionCoef)
-    {
-    }
-    envi( VOID ) : DecayCoef(1), RefractionCoef(1)
+    /* Add intersection function.
+     * ARGUMENTS:
+     *   - intersection:
+     *       const intr &In;
+     * RETURNS: (BOOL) TRUE if added, FALSE if list is full.
+     */
+    BOOL Add( const intr &In )
     {
-    }
-
-  }; /* End of 'envi' class */
-  
-  const envi Air(0.5, 1);
-  const envi Glass(1.517, 1);
+      if (N >= Capacity)
+      {
+        Complete = mth::Min(Complete, In.T);
+        return FALSE;
+      }
+      I[N++] = In;
+      return TRUE;
+    } /* End of 'Add' function */
+  }; /* End of 'intr_list ' class */
 
 
   /* Shape class */
   class shape
   {
+  protected:
+    /* Bounding box, set by derived class constructors (infinite if unknown) */
+    aabb Box = aabb(vec3(-HUGE_VAL), vec3(HUGE_VAL));
+
   public:
     surface mtl;
 
+    /* Shape destructor */
+    virtual ~shape( VOID )
+    {
+    } /* End of '~shape' function */
+
+    /* Get bounding box function.
+     * ARGUMENTS: None.
+     * RETURNS: (const aabb &) bounding box.
+     */
+    const aabb & Bounds( VOID ) const
+    {
+      return Box;
+    } /* End of 'Bounds' function */
+
+    /* Check if shape is bounded function.
+     * ARGUMENTS: None.
+     * RETURNS: (BOOL) TRUE if bounding box is finite.
+     */
+    BOOL IsBounded( VOID ) const
+    {
+      return fabs(Box.Min[0]) < HUGE_VAL && fabs(Box.Min[1]) < HUGE_VAL && fabs(Box.Min[2]) < HUGE_VAL &&
+             fabs(Box.Max[0]) < HUGE_VAL && fabs(Box.Max[1]) < HUGE_VAL && fabs(Box.Max[2]) < HUGE_VAL;
+    } /* End of 'IsBounded' function */
+
     /* Find intersection function.
      * ARGUMENTS: 
      *   - ray:
@@ -147,6 +211,40 @@ namespace ivrt
     {
     } /* End of 'GetNormal' function */
 
+    /* Get texture coordinates function.
+     * Default mapping is planar projection of point to XZ plane.
+     * ARGUMENTS:
+     *   - intersection with evaluated position:
+     *      const intr *Intr;
+     * RETURNS: (vec2) texture coordinates.
+     */
+    virtual vec2 GetTexCoord( const intr *Intr )
+    {
+      return vec2(Intr->P[0], Intr->P[2]);
+    } /* End of 'GetTexCoord' function */
+
+    /* Get texture coordinates derivatives function.
+     * Default is finite difference of 'GetTexCoord' at shifted points.
+     * ARGUMENTS:
+     *   - intersection with evaluated position:
+     *      const intr *Intr;
+     *   - hit point derivatives along frame X and Y:
+     *      const vec3 &DPdx, &DPdy;
+     *   - texture coordinates derivatives (for output):
+     *      vec2 *DUVdx, *DUVdy;
+     * RETURNS: None.
+     */
+    virtual VOID GetTexCoordDiff( const intr *Intr, const vec3 &DPdx, const vec3 &DPdy, vec2 *DUVdx, vec2 *DUVdy )
+    {
+      intr I = *Intr;
+      vec2 uv = GetTexCoord(Intr);
+
+      I.P = Intr->P + DPdx;
+      *DUVdx = GetTexCoord(&I) - uv;
+      I.P = Intr->P + DPdy;
+      *DUVdy = GetTexCoord(&I) - uv;
+    } /* End of 'GetTexCoordDiff' function */
+
     /* Check if point is inside of the shape.
      * ARGUMENTS:
      *   - Reference ray to intersect:
@@ -160,13 +258,15 @@ namespace ivrt
       return FALSE;
     } /* End of 'IsInside' function */
 
-    /* Find num of intersections with current shape.
+    /* Find all intersections with current shape function.
+     * Intersections are added in ascending distance order and marked
+     * ENTER/LEAVE, so solids can be combined by CSG nodes.
      * ARGUMENTS:
      *   - Reference ray to intersect:
      *         ray &R;
      *   - Reference to stock of intersections:
      *         intr_list &IList;
-     * RETURNS: None.
+     * RETURNS: (INT) number of added intersections.
      */
     virtual INT AllIntersect( const ray &R, intr_list &IList )
     {
@@ -176,6 +276,30 @@ namespace ivrt
   }; /* End of 'shape' class */
 
 
+  /* Pending secondary ray class */
+  class trace_task
+  {
+  public:
+    ray R;             // ray to be traced
+    const envi *Media; // environment ray goes through
+    DBL Weight;        // ray weight
+    INT RecLevel;      // ray tree depth
+    ray_diff Diff;     // ray differentials (footprint)
+
+    /* Trace task default constructor */
+    trace_task( VOID ) : Media(&Air), Weight(0), RecLevel(0)
+    {
+    } /* End of 'trace_task' function */
+
+    /* Trace task constructor */
+    trace_task( const ray &NR, const envi *NMedia, DBL NWeight, INT NRecLevel, const ray_diff &NDiff = ray_diff() ) :
+      R(NR), Media(NMedia), Weight(NWeight), RecLevel(NRecLevel), Diff(NDiff)
+    {
+    } /* End of 'trace_task' function */
+  }; /* End of 'trace_task' class */
+
+  const INT MaxTraceStack = 32; // pending secondary rays stack size
+
   /* Common shape_info class */
   class shape_info
   {
@@ -205,13 +329,27 @@ namespace ivrt
   /* Scene class */
   class scene
   {
+    friend class wavefront;
+    friend class path_tracer;
   private:
-    std::vector<shape *> Shapes;
+    std::vector<shape *> Shapes;    // all shapes (owned)
+    std::vector<shape *> Bounded;   // shapes with finite bounds
+    std::vector<shape *> Unbounded; // shapes with infinite bounds (planes etc.)
+    bvh All;                        // hierarchy of bounded shapes
+    bvh Visible;                    // hierarchy of bounded shapes inside camera frustum
+    BOOL IsBuilt = FALSE;           // hierarchies are up to date flag
+    BOOL IsCulled = FALSE;          // primary rays use frustum culled hierarchy flag
     std::vector<light *> Lights;
     vec3 AmbientColor, Background = vec3(0.1);
     INT RecLevel = 0, MaxRecLevel = 3;
+    INT ShadowPilot = 4; // shadow rays traced before deciding if point is in penumbra
+    DBL
+      MinWeight = 0.01,     // secondary rays with less weight are never traced
+      RouletteWeight = 0.1; // secondary rays with less weight play russian roulette
  
   public:
+    texture_cache Textures; // shared image textures (surfaces maps)
+
     /* Scene destructor */
     ~scene( VOID )
     {
@@ -223,15 +361,30 @@ namespace ivrt
       Lights.clear();
     }
 
+    /* Prepare scene for frame rendering function.
+     * Rebuilds hierarchy if shapes were added and culls shapes outside
+     * camera frustum from primary rays candidates. Must be called before
+     * rendering threads start; without it all shapes are tested linearly.
+     * ARGUMENTS: 
+     *   - frame camera:
+     *      const camera &Cam;
+     *   - cull by camera frustum flag (off if camera moves during frame):
+     *      BOOL IsCull;
+     * RETURNS: None.
+     */
+    VOID Update( const camera &Cam, BOOL IsCull = TRUE );
+
     /* Find intersection function.
      * ARGUMENTS: 
      *   - ray:
      *      const ray &R;
      *   - intersection point on ray:
      *      intr *Intr;
+     *   - camera ray flag (only shapes inside camera frustum are tested):
+     *      BOOL IsPrimary;
      * RETURNS: (BOOL) TRUE if success, FALSE otherwise.
      */
-    BOOL Intersection( const ray &R, intr *Intr );
+    BOOL Intersection( const ray &R, intr *Intr, BOOL IsPrimary = FALSE );
 
     /* Find intersection function.
      * ARGUMENTS: 
@@ -243,6 +396,32 @@ namespace ivrt
      */
     BOOL IsIntersected( const ray &R );
 
+    /* Check if light sample is occluded function.
+     * ARGUMENTS: 
+     *   - shaded point:
+     *      const vec3 &P;
+     *   - light sample info:
+     *      const light_info &L;
+     *   - ray time in shutter interval:
+     *      DBL Time;
+     * RETURNS: (BOOL) TRUE if occluded, FALSE otherwise.
+     */
+    BOOL IsShadowed( const vec3 &P, const light_info &L, DBL Time = 0 );
+
+    /* Get visible fraction of light function.
+     * ARGUMENTS: 
+     *   - shaded point:
+     *      const vec3 &P;
+     *   - light source:
+     *      light *Lgt;
+     *   - light center info:
+     *      const light_info &L;
+     *   - ray time in shutter interval:
+     *      DBL Time;
+     * RETURNS: (DBL) visible fraction in [0, 1].
+     */
+    DBL Visibility( const vec3 &P, light *Lgt, const light_info &L, DBL Time = 0 );
+
    /* Add new shape of scene to stock function.
     * ARGUMENTS: 
     *   - Shape to be add:
@@ -252,6 +431,7 @@ namespace ivrt
     scene & operator<<( shape *NewShape )
     {
       Shapes.push_back(NewShape);
+      IsBuilt = FALSE;
 
       return *this;
     } /* End of 'operator<<' function */
@@ -269,6 +449,50 @@ namespace ivrt
       return *this;
     } /* End of 'operator<<' function */
 
+    /* Evaluate surface texture color at intersection function.
+     * ARGUMENTS: 
+     *   - intersection point (position is evaluated, color is set):
+     *       intr *Inter;
+     *   - ray differentials transferred to intersection (map level choice):
+     *       const ray_diff &Diff;
+     *   - evaluate procedural color flag (FALSE if caller batches it):
+     *       BOOL IsProc;
+     * RETURNS: (vec3) texture color (white if surface has no map).
+     */
+    vec3 Albedo( intr *Inter, const ray_diff &Diff = ray_diff(), BOOL IsProc = TRUE )
+    {
+      const surface &Mtl = Inter->Shp->mtl;
+      vec2 dx(0), dy(0);
+
+      Inter->Color = vec3(1);
+      if (Mtl.Map != nullptr)
+      {
+        if (Diff.IsValid)
+          Inter->Shp->GetTexCoordDiff(Inter, Diff.DOdx, Diff.DOdy, &dx, &dy);
+        Inter->Color =
+          Mtl.Map->Sample(Inter->Shp->GetTexCoord(Inter) * Mtl.MapScale, dx * Mtl.MapScale, dy * Mtl.MapScale);
+      }
+      if (IsProc && Mtl.Proc != nullptr)
+        Inter->Color = Inter->Color * Mtl.Proc->Eval(Inter->P, Diff.Footprint());
+      return Inter->Color;
+    } /* End of 'Albedo' function */
+
+    /* Get light contribution to point without occlusion function.
+     * ARGUMENTS: 
+     *   - intersection point (normal faces the viewer):
+     *       intr *Inter;
+     *   - reflected view direction:
+     *       vec3 &R;
+     *   - light source:
+     *       light *Lgt;
+     *   - light center info (for output):
+     *       light_info *L;
+     *   - light contribution (for output):
+     *       vec3 *Color;
+     * RETURNS: (BOOL) TRUE if light contributes to point, FALSE otherwise.
+     */
+    BOOL LightShade( intr *Inter, vec3 &R, light *Lgt, light_info *L, vec3 *Color );
+
     /* Get color of factor function.
      * ARGUMENTS: 
      *   - Ray direction:
@@ -279,11 +503,46 @@ namespace ivrt
      *       intr *Intersection;
      *   - weight of lighting:
      *       DBL Weight;
+     *   - ray time in shutter interval:
+     *       DBL Time;
+     *   - ray differentials transferred to intersection:
+     *       const ray_diff &Diff;
      * RETURNS: (vec3 ) result color.
      */
-    vec3 Shade( vec3 &Dir, const envi &Media, intr *Intersection, DBL Weight );
+    vec3 Shade( vec3 &Dir, const envi &Media, intr *Intersection, DBL Weight, DBL Time = 0,
+                const ray_diff &Diff = ray_diff() );
     
+   /* Decide if secondary ray is worth tracing function.
+    * ARGUMENTS: 
+    *   - ray weight (boosted if ray survived russian roulette):
+    *       DBL *Weight;
+    * RETURNS: (BOOL) TRUE if ray should be traced, FALSE otherwise.
+    */
+    BOOL Survive( DBL *Weight );
+
+   /* Spawn secondary rays function.
+    * ARGUMENTS: 
+    *   - incoming ray:
+    *       const ray &R;
+    *   - incoming ray environment:
+    *       const envi &Media;
+    *   - intersection point (normal faces the ray):
+    *       intr *Intr;
+    *   - is ray entering the shape flag:
+    *       BOOL IsEnter;
+    *   - incoming ray weight and depth:
+    *       DBL Weight; INT RecLevel;
+    *   - spawned rays (for output, at least 2 entries):
+    *       trace_task *Tasks;
+    *   - incoming ray differentials transferred to intersection:
+    *       const ray_diff &Diff;
+    * RETURNS: (INT) number of spawned rays.
+    */
+    INT Scatter( const ray &R, const envi &Media, intr *Intr, BOOL IsEnter,
+                 DBL Weight, INT RecLevel, trace_task *Tasks, const ray_diff &Diff = ray_diff() );
+
    /* Trace ray function.
+    * Ray tree is walked iteratively by small fixed stack of pending rays.
     * ARGUMENTS: 
     *   - input ray:
     *       const ray &R;
@@ -291,20 +550,11 @@ namespace ivrt
     *       const envi &Media;
     *   - weight of lighting:
     *       DBL Weight;
+    *   - ray differentials (no texture filtering if unknown):
+    *       const ray_diff &Diff;
     * RETURNS: (vec3 ) result color.
     */
-    vec3 Trace( ray &R, const envi &Media, DBL Weight, INT RecLevel );
-    
-   /* Get Ka by position function.
-    * ARGUMENTS: 
-    *   - input position:
-    *       const vec3 &P;
-    * RETURNS: (vec3 ) result value.
-    */
-    vec3 GetKa( const vec3 &P )
-    {
-      return vec3(((INT)(P[0]) ^ (INT)(P[1]) ^ (INT)(P[2])) & 1);
-    }
+    vec3 Trace( ray &R, const envi &Media, DBL Weight, INT RecLevel, const ray_diff &Diff = ray_diff() );
 
   }; /* End of 'scene' class */
  
@@ -8,7 +8,7 @@
  *               Box class declaration module.
  * PROGRAMMER  : CGSG-SummerCamp'2021.
  *               Ivan Dmitriev
- * LAST UPDATE : 02.08.2021
+ * LAST UPDATE : 08.08.2021
  * NOTE        : Module namespace 'ivrt'.
  * 
  * No pabox of this file may be changed without agreement of
@@ -20,8 +20,6 @@
 
 #include "../rt_def.h"
 
-#define THRESHOLD 0.0001
-
 /* Project namespace */
 namespace ivrt
 {
@@ -29,67 +27,63 @@ namespace ivrt
   class box : public shape
   {
   private:
-    vec3 Min, Max; // Maximum and minimum box boreders
+    aabb B; // box borders
+
+    /* Face normals table: -X, +X, -Y, +Y, -Z, +Z */
+    static constexpr vec3 Normals[6] =
+    {
+      vec3(-1, 0, 0), vec3(1, 0, 0),
+      vec3(0, -1, 0), vec3(0, 1, 0),
+      vec3(0, 0, -1), vec3(0, 0, 1)
+    };
+
+    /* Get index of axis where value is reached function.
+     * ARGUMENTS:
+     *   - per axis values:
+     *       const vec3 &V;
+     *   - reached value:
+     *       DBL T;
+     * RETURNS: (INT) axis index.
+     */
+    static INT Axis( const vec3 &V, DBL T )
+    {
+      return V[0] == T ? 0 : V[1] == T ? 1 : 2;
+    } /* End of 'Axis' function */
+
+    /* Get face normal at entry or exit point function.
+     * ARGUMENTS:
+     *   - prepared ray:
+     *       const inv_ray &IR;
+     *   - ray direction:
+     *       const vec3 &Dir;
+     *   - entry or exit distance:
+     *       DBL T;
+     *   - exit point flag:
+     *       BOOL IsExit;
+     * RETURNS: (vec3) outer face normal.
+     */
+    vec3 FaceNormal( const inv_ray &IR, const vec3 &Dir, DBL T, BOOL IsExit ) const
+    {
+      vec3
+        t0 = (B.Min - IR.Org) * IR.InvDir,
+        t1 = (B.Max - IR.Org) * IR.InvDir;
+      INT axis;
+
+      if (IsExit)
+      {
+        axis = Axis(vec3::Max(t0, t1), T);
+        return Normals[2 * axis + (Dir[axis] > 0)];
+      }
+      axis = Axis(vec3::Min(t0, t1), T);
+      return Normals[2 * axis + (Dir[axis] < 0)];
+    } /* End of 'FaceNormal' function */
+
   public:
-    box( vec3 NewMin, vec3 NewMax ) : Min(NewMin), Max(NewMax) 
+    box( const vec3 &NewMin, const vec3 &NewMax ) : B(NewMin, NewMax)
     {
+      Box = aabb(NewMin - Threshold, NewMax + Threshold);
     }
-     /* Find intersection on box function.
-      * ARGUMENTS: 
-      *   - input ray:
-      *      const ray &R;
-      *   - intersection point on ray:
-      *      intr *Intr;
-      * RETURNS: (BOOL) TRUE if success, FALSE otherwise.
-      */
-    //BOOL Intersection( const ray &R, intr *Intr ) override
-    //{
-    //    vec3 norm_arr[] = 
-    //    {
-    //      vec3(-1.0, 0.0, 0.0), vec3(1.0, 0.0, 0.0), 
-    //      vec3(0.0, -1.0,  0.0), vec3(0.0, 1.0, 0.0), 
-    //      vec3(0.0,  0.0, -1.0), vec3(0.0, 0.0, 1.0)
-    //    };
 
-    //    FLT txMin = (Min[0] - R.Org[0]) / R.Dir[0]; 
-    //    FLT txMax = (Max[0] - R.Org[0]) / R.Dir[0]; 
- 
-    //    if (txMin > txMax) 
-    //      mth::Swap(&txMin, &txMax); 
- 
-    //    FLT tyMin = (Min[1] - R.Org[1]) / R.Dir[1]; 
-    //    FLT tyMax = (Max[1] - R.Org[1]) / R.Dir[1]; 
- 
-    //    if (tyMin > tyMax) 
-    //      mth::Swap(&tyMin, &tyMax); 
- 
-    //    if ((txMin > tyMax) || (tyMin > txMax)) 
-    //      return FALSE;
- 
-    //    if (tyMin > txMin) 
-    //        txMin = tyMin; 
- 
-    //    if (tyMax < txMax) 
-    //        txMax = tyMax; 
- 
-    //    FLT tzMin = (Min[2] - R.Org[2]) / R.Dir[2]; 
-    //    FLT tzMax = (Max[2] - R.Org[2]) / R.Dir[2]; 
- 
-    //    if (tzMin > tzMax) 
-    //      mth::Swap(&tzMin, &tzMax); 
- 
-    //    if ((txMin > tzMax) || (tzMin > txMax)) 
-    //        return FALSE; 
- 
-    //    if (tzMin > txMin) 
-    //        txMin = tzMin; 
- 
-    //    if (tzMax < txMax) 
-    //      txMax = tzMax; 
-    //    Intr->T = txMin;
-    //    return TRUE; 
-    //} /* End of 'Intersection' function */
-    
      /* Find intersection on box function.
       * ARGUMENTS: 
       *   - input ray:
@@ -100,115 +94,17 @@ namespace ivrt
       */
     BOOL Intersection( const ray &R, intr *Intr ) override
     {
-      DBL tnear = 0, tfar = HUGE_VAL;
-      vec3 Normals[6] =
-      {
-        vec3(-1, 0, 0),
-        vec3(1, 0, 0),
-        vec3(0, -1, 0),
-        vec3(0, 1, 0),
-        vec3(0, 0, -1),
-        vec3(0, 0, 1),
-      };
-      INT NormNum = -1;
-
-      // X axis
-      if (abs(R.Dir[0]) < Threshold)
-      {
-        if (R.Org[0] < Min[0] || R.Org[0] > Max[0])
-          return FALSE;
-      }
-      else
-      {
-        DBL t0 = (Min[0] - R.Org[0]) / R.Dir[0];
-        DBL t1 = (Max[0] - R.Org[0]) / R.Dir[0];
-        DBL tmp;
-        INT ind = 0;
-
-        if (t0 > t1)
-        {
-          COM_SWAP(t0, t1, tmp);
-          ind = 1;
-        }
-        if (t0 > tnear)
-        {
-          tnear = t0;
-          NormNum = ind;
-        }
-        if (t1 < tfar)
-          tfar = t1;
-        if (tnear > tfar)
-          return FALSE;
-        if (tfar < 0)
-          return FALSE;
-      }
-
-      // Y axis
-      if (abs(R.Dir[0]) < Threshold)
-      {
-        if (R.Org[1] < Min[1] || R.Org[1] > Max[1])
-          return FALSE;
-      }
-      else
-      {
-        DBL t0 = (Min[1] - R.Org[1]) / R.Dir[1];
-        DBL t1 = (Max[1] - R.Org[1]) / R.Dir[1];
-        DBL tmp;
-        INT ind = 2;
-
-        if (t0 > t1)
-        {
-          COM_SWAP(t0, t1, tmp);
-          ind = 3;
-        }
-        if (t0 > tnear)
-        {
-          tnear = t0;
-          NormNum = ind;
-        }
-        if (t1 < tfar)
-          tfar = t1;
-        if (tnear > tfar)
-          return FALSE;
-        if (tfar < 0)
-          return FALSE;
-      }
-
-      // Z axis
-      if (abs(R.Dir[2]) < Threshold)
-      {
-        if (R.Org[2] < Min[2] || R.Org[2] > Max[2])
-          return FALSE;
-      }
-      else
-      {
-        DBL t0 = (Min[2] - R.Org[2]) / R.Dir[2];
-        DBL t1 = (Max[2] - R.Org[2]) / R.Dir[2];
-        DBL tmp;
-        INT ind = 4;
+      inv_ray ir(R);
+      DBL tnear, tfar, t;
 
-        if (t0 > t1)
-        {
-          COM_SWAP(t0, t1, tmp);
-          ind = 5;
-        }
-        if (t0 > tnear)
-        {
-          tnear = t0;
-          NormNum = ind;
-        }
-        if (t1 < tfar)
-          tfar = t1;
-        if (tnear > tfar)
-          return FALSE;
-        if (tfar < 0)
-          return FALSE;
-      }
+      if (!B.Intersect(ir, HUGE_VAL, &tnear, &tfar) || tfar <= Threshold)
+        return FALSE;
 
+      /* Entry face, or exit face for rays started inside */
+      t = tnear > Threshold ? tnear : tfar;
+      Intr->N = FaceNormal(ir, R.Dir, t, t == tfar);
       Intr->Shp = this;
-      Intr->T = tnear;
-      if (NormNum != -1)
-        Intr->N = Normals[NormNum];
+      Intr->T = t;
       for (INT i = 0; i < 5; i++)
         Intr->add[i] = 0;
 
@@ -223,56 +119,52 @@ namespace ivrt
      */
     BOOL IsIntersected( const ray &Ray ) override
     {
-      INT Ind = 1, tind = 0;
-      DBL tnear = -HUGE_VAL, tfar = HUGE_VAL, t0, t1, tmp;
-
-      // X axis
-      if (fabs(Ray.Dir[0]) < Threshold)
-        if (Min[0] > Ray.Org[0] || Ray.Org[0] > Max[0])
-          return FALSE;
-      
-      tnear = (Min[0] - Ray.Org[0]) / Ray.Dir[0];
-      tfar = (Max[0] - Ray.Org[0]) / Ray.Dir[0];
-      
-      if (tnear > tfar)
-        COM_SWAP(tnear, tfar, tmp), Ind = 0;
+      DBL tnear, tfar;
 
-      // Y axis
-      if (fabs(Ray.Dir[1]) < Threshold)
-        if (Min[1] > Ray.Org[1] || Ray.Org[1] > Max[1])
-          return FALSE;
-      
-      t0 = (Min[1] - Ray.Org[1]) / Ray.Dir[1];
-      t1 = (Max[1] - Ray.Org[1]) / Ray.Dir[1];
-      tind = 3;
-      if (t0 > t1)
-        COM_SWAP(t0, t1, tmp), tind = 2;
-      if (t0 > tnear)
-        tnear = t0, Ind = tind;
-      if (t1 < tfar)
-        tfar = t1;
-      if (tnear > tfar || tfar < 0)
-        return FALSE;
+      return B.Intersect(inv_ray(Ray), HUGE_VAL, &tnear, &tfar) && tfar > Threshold;
+    } /* End of 'IsIntersected' function */
 
-      // Z axis
-      if (fabs(Ray.Dir[2]) < Threshold)
-        if (Min[2] > Ray.Org[2] || Ray.Org[2] > Max[2])
-          return FALSE;
-      
-      t0 = (Min[2] - Ray.Org[2]) / Ray.Dir[2];
-      t1 = (Max[2] - Ray.Org[2]) / Ray.Dir[2];
-      tind = 5;
-      if (t0 > t1)
-        COM_SWAP(t0, t1, tmp), tind = 4;
-      if (t0 > tnear)
-        tnear = t0, Ind = tind;
-      if (t1 < tfar)
-        tfar = t1;
-      if (tnear > tfar || tfar < 0)
-        return FALSE;
+    /* Check if point is inside of the shape.
+     * ARGUMENTS:
+     *   - point:
+     *       const vec3 &P;
+     * RETURNS: (BOOL) TRUE if point is inside.
+     */
+    BOOL IsInside( const vec3 &P ) override
+    {
+      return P[0] > B.Min[0] && P[1] > B.Min[1] && P[2] > B.Min[2] &&
+             P[0] < B.Max[0] && P[1] < B.Max[1] && P[2] < B.Max[2];
+    } /* End of 'IsInside' function */
+
+    /* Find all intersections function.
+     * ARGUMENTS:
+     *   - ray:
+     *       const ray &R;
+     *   - intersections list to be extended:
+     *       intr_list &IList;
+     * RETURNS: (INT) number of found intersections.
+     */
+    INT AllIntersect( const ray &R, intr_list &IList ) override
+    {
+      inv_ray ir(R);
+      DBL t[2];
+      INT n = 0;
+
+      if (!B.Intersect(ir, HUGE_VAL, &t[0], &t[1]))
+        return 0;
+      for (INT i = 0; i < 2; i++)
+        if (t[i] > Threshold)
+        {
+          intr I(this, t[i], i == 0 ? ENTER : LEAVE);
 
-      return TRUE;
-    } /* End of 'IsIntersected' function */
+          I.N = FaceNormal(ir, R.Dir, t[i], i == 1);
+          I.IsNorm = TRUE;
+          I.P = R(t[i]);
+          I.IsPos = TRUE;
+          n += IList.Add(I);
+        }
+      return n;
+    } /* End of 'AllIntersect' function */
   }; /* End of 'box' class */
 } /* end of 'ivrt' namespace */
 
@@ -0,0 +1,233 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : csg.h
+ * PURPOSE     : Raytracing project.
+ *               Constructive solid geometry class declaration module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __csg_h_
+#define __csg_h_
+
+#include "../rt_def.h"
+
+/* Project namespace */
+namespace ivrt
+{
+  /* CSG operation type */
+  enum CSG_OP
+  {
+    CSG_UNION,        // points inside any operand
+    CSG_INTERSECTION, // points inside both operands
+    CSG_DIFFERENCE    // points inside first operand and outside second one
+  }; /* End of 'CSG_OP' enum */
+
+  /* Constructive solid geometry node class.
+   * Operands intervals come from their 'AllIntersect' lists; both lists are
+   * merged in distance order while tracking if ray is inside each operand,
+   * and every point where the combined inside state changes is a surface
+   * point of the node. Hits keep operand shapes, so every surface part is
+   * shaded with its operand material. Operands may be CSG nodes themselves.
+   * If operand list overflows, only its complete part is merged and closest
+   * hit search goes on from the point where it ends. */
+  class csg : public shape
+  {
+  private:
+    shape *A, *B; // operands (owned)
+    CSG_OP Op;    // operation
+
+    /* Combine operands inside states function.
+     * ARGUMENTS:
+     *   - is point inside first and second operands flags:
+     *       BOOL InA, InB;
+     * RETURNS: (BOOL) TRUE if point is inside node.
+     */
+    BOOL Combine( BOOL InA, BOOL InB ) const
+    {
+      switch (Op)
+      {
+      case CSG_UNION:
+        return InA || InB;
+      case CSG_INTERSECTION:
+        return InA && InB;
+      default:
+        return InA && !InB;
+      }
+    } /* End of 'Combine' function */
+
+    /* Get inside state before first intersection function.
+     * ARGUMENTS:
+     *   - operand:
+     *       shape *Shp;
+     *   - operand intersections list:
+     *       const intr_list &L;
+     *   - ray:
+     *       const ray &R;
+     * RETURNS: (BOOL) TRUE if ray origin is inside operand.
+     */
+    static BOOL StartInside( shape *Shp, const intr_list &L, const ray &R )
+    {
+      if (L.N > 0 && L.I[0].Entry != STAY)
+        return L.I[0].Entry == LEAVE;
+      return Shp->IsInside(R.Org);
+    } /* End of 'StartInside' function */
+
+  public:
+    /* Class constructor.
+     * ARGUMENTS:
+     *   - operands (node takes ownership):
+     *       shape *NA, *NB;
+     *   - operation:
+     *       CSG_OP NOp;
+     */
+    csg( shape *NA, shape *NB, CSG_OP NOp ) : A(NA), B(NB), Op(NOp)
+    {
+      /* Node is bounded by the part of space its operation can keep */
+      if (Op == CSG_UNION)
+        Box = aabb(A->Bounds()).Grow(B->Bounds());
+      else if (Op == CSG_INTERSECTION)
+        Box = aabb(vec3::Max(A->Bounds().Min, B->Bounds().Min), vec3::Min(A->Bounds().Max, B->Bounds().Max));
+      else
+        Box = A->Bounds();
+    } /* End of 'csg' function */
+
+    /* Class destructor */
+    ~csg( VOID ) override
+    {
+      delete A;
+      delete B;
+    } /* End of '~csg' function */
+
+    /* Find all intersections function.
+     * ARGUMENTS:
+     *   - ray:
+     *       const ray &R;
+     *   - intersections list to be extended:
+     *       intr_list &IList;
+     * RETURNS: (INT) number of found intersections.
+     */
+    INT AllIntersect( const ray &R, intr_list &IList ) override
+    {
+      intr_list la, lb;
+      INT ia = 0, ib = 0, n = 0;
+      BOOL in_a, in_b, in;
+      DBL complete;
+
+      A->AllIntersect(R, la);
+      B->AllIntersect(R, lb);
+      in_a = StartInside(A, la, R);
+      in_b = StartInside(B, lb, R);
+      in = Combine(in_a, in_b);
+      /* Inside states are known only while both lists are complete */
+      complete = mth::Min(la.Complete, lb.Complete);
+      IList.Complete = mth::Min(IList.Complete, complete);
+
+      while (ia < la.N || ib < lb.N)
+      {
+        BOOL from_a = ib >= lb.N || (ia < la.N && la.I[ia].T <= lb.I[ib].T), now;
+        intr I = from_a ? la.I[ia++] : lb.I[ib++];
+
+        if (I.T >= complete)
+          break;
+
+        if (from_a)
+          in_a = I.Entry == STAY ? !in_a : I.Entry == ENTER;
+        else
+          in_b = I.Entry == STAY ? !in_b : I.Entry == ENTER;
+        if ((now = Combine(in_a, in_b)) == in)
+          continue;
+        in = now;
+
+        if (!I.IsPos)
+          I.P = R(I.T), I.IsPos = TRUE;
+        if (!I.IsNorm)
+          I.Shp->GetNormal(&I), I.IsNorm = TRUE;
+        /* Second operand surface bounds difference from inside */
+        if (!from_a && Op == CSG_DIFFERENCE)
+          I.N = -I.N;
+        I.Entry = in ? ENTER : LEAVE;
+        n += IList.Add(I);
+      }
+      return n;
+    } /* End of 'AllIntersect' function */
+
+    /* Find intersection function.
+     * ARGUMENTS:
+     *   - ray:
+     *      const ray &R;
+     *   - intersection point on ray:
+     *      intr *Intr;
+     * RETURNS: (BOOL) TRUE if success, FALSE otherwise.
+     */
+    BOOL Intersection( const ray &R, intr *Intr ) override
+    {
+      ray r = R;
+      DBL t0 = 0;
+
+      while (TRUE)
+      {
+        intr_list l;
+
+        if (AllIntersect(r, l) > 0)
+        {
+          *Intr = l.I[0];
+          Intr->T += t0;
+          return TRUE;
+        }
+        /* Overflowed list without hits: continue from its complete part end */
+        if (l.Complete == HUGE_VAL)
+          return FALSE;
+        t0 += l.Complete;
+        r = ray(R(t0), R.Dir, R.Time);
+      }
+    } /* End of 'Intersection' function */
+
+    /* Check if ray intersects object function.
+     * ARGUMENTS:
+     *   - input ray:
+     *      const ray &R;
+     * RETURNS: (BOOL) TRUE if success, FALSE otherwise.
+     */
+    BOOL IsIntersected( const ray &R ) override
+    {
+      intr I;
+
+      return Intersection(R, &I);
+    } /* End of 'IsIntersected' function */
+
+    /* Get normal function.
+     * ARGUMENTS:
+     *   - intersection point on ray:
+     *      intr *Intr;
+     * RETURNS: NONE.
+     */
+    VOID GetNormal( intr *Intr ) override
+    {
+      /* Normals are evaluated by operands in 'AllIntersect' */
+    } /* End of 'GetNormal' function */
+
+    /* Check if point is inside of the shape.
+     * ARGUMENTS:
+     *   - point:
+     *       const vec3 &P;
+     * RETURNS: (BOOL) TRUE if point is inside.
+     */
+    BOOL IsInside( const vec3 &P ) override
+    {
+      return Combine(A->IsInside(P), B->IsInside(P));
+    } /* End of 'IsInside' function */
+  }; /* End of 'csg' class */
+} /* end of 'ivrt' namespace */
+
+#endif /* __csg_h_ */
+
+/* END OF 'csg.h' FILE */
@@ -0,0 +1,272 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : instance.h
+ * PURPOSE     : Raytracing project.
+ *               Transformed (and moving) shape instance class declaration module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __instance_h_
+#define __instance_h_
+
+#include "../rt_def.h"
+
+/* Project namespace */
+namespace ivrt
+{
+  /* Shape instance class.
+   * Shape is placed to world by object to world transform, which may change
+   * from shutter open (time 0) to shutter close (time 1) transform. Rays
+   * are moved to shape space with transform of their time, found points and
+   * normals go back to world. Hits refer to instance (with material of inner
+   * shape), so texture coordinates are evaluated at shape space point. */
+  class instance : public shape
+  {
+  private:
+    shape *Shp;           // instanced shape (owned)
+    matr Start, End;      // object to world transforms at shutter open and close
+    matr StartInv;        // world to object transform at shutter open
+    BOOL IsMoving;        // transforms differ flag
+
+    /* Get world to object transform function.
+     * ARGUMENTS:
+     *   - time in [0, 1]:
+     *       DBL Time;
+     * RETURNS: (matr) world to object transform at time.
+     */
+    matr ToObject( DBL Time ) const
+    {
+      return IsMoving ? matr::Lerp(Start, End, Time).Inversing() : StartInv;
+    } /* End of 'ToObject' function */
+
+    /* Move ray to shape space function.
+     * ARGUMENTS:
+     *   - world ray:
+     *       const ray &R;
+     *   - object to world transform at ray time to be stored:
+     *       matr *M;
+     *   - world to object distance scale to be stored:
+     *       DBL *Scale;
+     * RETURNS: (ray) shape space ray.
+     */
+    ray ToShape( const ray &R, matr *M, DBL *Scale ) const
+    {
+      matr Inv;
+
+      if (IsMoving)
+        *M = matr::Lerp(Start, End, R.Time), Inv = M->Inversing();
+      else
+        *M = Start, Inv = StartInv;
+
+      vec3 Dir = Inv.TransformVector(R.Dir);
+
+      *Scale = !Dir;
+      return ray(Inv.TransformPoint(R.Org), Dir, R.Time);
+    } /* End of 'ToShape' function */
+
+    /* Move intersection to world function.
+     * ARGUMENTS:
+     *   - shape space ray:
+     *       const ray &R;
+     *   - object to world transform at ray time:
+     *       const matr &M;
+     *   - world to object distance scale:
+     *       DBL Scale;
+     *   - intersection to be moved:
+     *       intr *I;
+     * RETURNS: None.
+     */
+    VOID ToWorld( const ray &R, const matr &M, DBL Scale, intr *I )
+    {
+      if (!I->IsPos)
+        I->P = R(I->T), I->IsPos = TRUE;
+      if (!I->IsNorm)
+        I->Shp->GetNormal(I), I->IsNorm = TRUE;
+      I->P = M.TransformPoint(I->P);
+      I->N = M.TransformNormal(I->N).Normalizing();
+      I->T /= Scale;
+      I->Time = R.Time;
+      I->Shp = this;
+    } /* End of 'ToWorld' function */
+
+  public:
+    /* Class constructor.
+     * ARGUMENTS:
+     *   - shape (instance takes ownership):
+     *       shape *NShp;
+     *   - object to world transforms at shutter open and close:
+     *       const matr &NStart, &NEnd;
+     */
+    instance( shape *NShp, const matr &NStart, const matr &NEnd ) :
+      Shp(NShp), Start(NStart), End(NEnd), StartInv(NStart.Inversing()), IsMoving(FALSE)
+    {
+      mtl = Shp->mtl;
+      for (INT i = 0; i < 4 && !IsMoving; i++)
+        for (INT j = 0; j < 4 && !IsMoving; j++)
+          IsMoving = ((const DBL *)Start)[i * 4 + j] != ((const DBL *)End)[i * 4 + j];
+
+      /* Points move linearly in time, so box of start and end corners bounds whole motion */
+      if (Shp->IsBounded())
+      {
+        const aabb &B = Shp->Bounds();
+
+        Box = aabb(vec3(HUGE_VAL), vec3(-HUGE_VAL));
+        for (INT i = 0; i < 8; i++)
+        {
+          vec3 C(i & 1 ? B.Max[0] : B.Min[0], i & 2 ? B.Max[1] : B.Min[1], i & 4 ? B.Max[2] : B.Min[2]);
+
+          Box.Grow(Start.TransformPoint(C));
+          Box.Grow(End.TransformPoint(C));
+        }
+      }
+    } /* End of 'instance' function */
+
+    /* Class constructor (not moving instance).
+     * ARGUMENTS:
+     *   - shape (instance takes ownership):
+     *       shape *NShp;
+     *   - object to world transform:
+     *       const matr &M;
+     */
+    instance( shape *NShp, const matr &M ) : instance(NShp, M, M)
+    {
+    } /* End of 'instance' function */
+
+    /* Class destructor */
+    ~instance( VOID ) override
+    {
+      delete Shp;
+    } /* End of '~instance' function */
+
+    /* Find intersection function.
+     * ARGUMENTS:
+     *   - ray:
+     *      const ray &R;
+     *   - intersection point on ray:
+     *      intr *Intr;
+     * RETURNS: (BOOL) TRUE if success, FALSE otherwise.
+     */
+    BOOL Intersection( const ray &R, intr *Intr ) override
+    {
+      matr M;
+      DBL s;
+      ray r = ToShape(R, &M, &s);
+
+      if (!Shp->Intersection(r, Intr))
+        return FALSE;
+      ToWorld(r, M, s, Intr);
+      return TRUE;
+    } /* End of 'Intersection' function */
+
+    /* Check if ray intersects object function.
+     * ARGUMENTS:
+     *   - input ray:
+     *      const ray &R;
+     * RETURNS: (BOOL) TRUE if success, FALSE otherwise.
+     */
+    BOOL IsIntersected( const ray &R ) override
+    {
+      matr M;
+      DBL s;
+
+      return Shp->IsIntersected(ToShape(R, &M, &s));
+    } /* End of 'IsIntersected' function */
+
+    /* Find all intersections function.
+     * ARGUMENTS:
+     *   - ray:
+     *       const ray &R;
+     *   - intersections list to be extended:
+     *       intr_list &IList;
+     * RETURNS: (INT) number of found intersections.
+     */
+    INT AllIntersect( const ray &R, intr_list &IList ) override
+    {
+      matr M;
+      DBL s;
+      ray r = ToShape(R, &M, &s);
+      intr_list l;
+      INT n = 0;
+
+      Shp->AllIntersect(r, l);
+      IList.Complete = mth::Min(IList.Complete, l.Complete / s);
+      for (INT i = 0; i < l.N; i++)
+      {
+        ToWorld(r, M, s, &l.I[i]);
+        n += IList.Add(l.I[i]);
+      }
+      return n;
+    } /* End of 'AllIntersect' function */
+
+    /* Get normal function.
+     * ARGUMENTS:
+     *   - intersection point on ray:
+     *      intr *Intr;
+     * RETURNS: NONE.
+     */
+    VOID GetNormal( intr *Intr ) override
+    {
+      /* Normals are evaluated by instanced shape and moved to world on intersection */
+    } /* End of 'GetNormal' function */
+
+    /* Get texture coordinates function.
+     * Inner shape maps its own space point.
+     * ARGUMENTS:
+     *   - intersection with evaluated position:
+     *      const intr *Intr;
+     * RETURNS: (vec2) texture coordinates.
+     */
+    vec2 GetTexCoord( const intr *Intr ) override
+    {
+      intr I = *Intr;
+
+      I.P = ToObject(Intr->Time).TransformPoint(Intr->P);
+      I.Shp = Shp;
+      return Shp->GetTexCoord(&I);
+    } /* End of 'GetTexCoord' function */
+
+    /* Get texture coordinates derivatives function.
+     * ARGUMENTS:
+     *   - intersection with evaluated position:
+     *      const intr *Intr;
+     *   - hit point derivatives along frame X and Y:
+     *      const vec3 &DPdx, &DPdy;
+     *   - texture coordinates derivatives (for output):
+     *      vec2 *DUVdx, *DUVdy;
+     * RETURNS: None.
+     */
+    VOID GetTexCoordDiff( const intr *Intr, const vec3 &DPdx, const vec3 &DPdy, vec2 *DUVdx, vec2 *DUVdy ) override
+    {
+      matr Inv = ToObject(Intr->Time);
+      intr I = *Intr;
+
+      I.P = Inv.TransformPoint(Intr->P);
+      I.Shp = Shp;
+      Shp->GetTexCoordDiff(&I, Inv.TransformVector(DPdx), Inv.TransformVector(DPdy), DUVdx, DUVdy);
+    } /* End of 'GetTexCoordDiff' function */
+
+    /* Check if point is inside of the shape (at shutter open).
+     * ARGUMENTS:
+     *   - point:
+     *       const vec3 &P;
+     * RETURNS: (BOOL) TRUE if point is inside.
+     */
+    BOOL IsInside( const vec3 &P ) override
+    {
+      return Shp->IsInside(StartInv.TransformPoint(P));
+    } /* End of 'IsInside' function */
+  }; /* End of 'instance' class */
+} /* end of 'ivrt' namespace */
+
+#endif /* __instance_h_ */
+
+/* END OF 'instance.h' FILE */
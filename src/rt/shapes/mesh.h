@@ -0,0 +1,231 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : mesh.h
+ * PURPOSE     : Ray tracing project.
+ *               Ray tracing module.
+ *               Smooth shaded triangle meshes module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitiriev.
+ * LAST UPDATE : 08.08.2021.
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __mesh_h_
+#define __mesh_h_
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "triangle.h"
+
+/* Project name space */
+namespace ivrt
+{
+  /* Triangle mesh data class.
+   * Positions, normals and texture coordinates are kept in own arrays with
+   * own index streams (three indices per triangle), as in OBJ files: shared
+   * positions on UV seams or hard edges are not duplicated. Normal and
+   * texture index streams are empty if mesh has no such attribute. */
+  class mesh
+  {
+  public:
+    std::vector<vec3> P;  // vertex positions
+    std::vector<vec3> N;  // vertex normals
+    std::vector<vec2> UV; // vertex texture coordinates
+    std::vector<INT>
+      PInd,               // positions indices
+      NInd,               // normals indices (empty if no normals)
+      UVInd;              // texture coordinates indices (empty if no UVs)
+
+    /* Get triangles number function.
+     * ARGUMENTS: None.
+     * RETURNS: (INT) number of triangles.
+     */
+    INT Count( VOID ) const
+    {
+      return (INT)PInd.size() / 3;
+    } /* End of 'Count' function */
+
+    /* Compute smooth vertex normals function.
+     * Every position gets area weighted average of its faces normals, so
+     * existing normals are replaced and normal indices become positions
+     * ones. Faces and vertices are split between threads, vertex faces are
+     * listed beforehand, so no thread writes shared data.
+     * ARGUMENTS:
+     *   - number of threads (0 - hardware threads):
+     *       INT Threads;
+     * RETURNS: None.
+     */
+    VOID SmoothNormals( INT Threads = 0 )
+    {
+      INT nf = Count(), nv = (INT)P.size();
+      std::vector<vec3> FaceN(nf);
+      std::vector<INT> Start(nv + 1, 0), Faces(nf * 3);
+
+      if (Threads <= 0)
+        Threads = mth::Max((INT)std::thread::hardware_concurrency(), 1);
+
+      /* Vertex faces lists (counting sort of corners by vertex) */
+      for (INT i = 0; i < nf * 3; i++)
+        Start[PInd[i] + 1]++;
+      for (INT v = 0; v < nv; v++)
+        Start[v + 1] += Start[v];
+      {
+        std::vector<INT> Pos(Start.begin(), Start.end() - 1);
+
+        for (INT i = 0; i < nf * 3; i++)
+          Faces[Pos[PInd[i]]++] = i / 3;
+      }
+
+      /* Not normalized cross products are area weighted normals */
+      ParallelFor(nf, Threads,
+        [&]( INT f )
+        {
+          const vec3 &P0 = P[PInd[f * 3]], &P1 = P[PInd[f * 3 + 1]], &P2 = P[PInd[f * 3 + 2]];
+
+          FaceN[f] = (P1 - P0) % (P2 - P0);
+        });
+      N.resize(nv);
+      ParallelFor(nv, Threads,
+        [&]( INT v )
+        {
+          vec3 s(0);
+
+          for (INT i = Start[v]; i < Start[v + 1]; i++)
+            s += FaceN[Faces[i]];
+          N[v] = s.Length2() > 0 ? s.Normalizing() : vec3(0, 1, 0);
+        });
+      NInd = PInd;
+    } /* End of 'SmoothNormals' function */
+
+  private:
+    /* Run function for all indices on threads function.
+     * ARGUMENTS:
+     *   - number of indices:
+     *       INT Num;
+     *   - number of threads:
+     *       INT Threads;
+     *   - function to run for each index:
+     *       const Func &F;
+     * RETURNS: None.
+     */
+    template<typename Func>
+      static VOID ParallelFor( INT Num, INT Threads, const Func &F )
+      {
+        std::vector<std::thread> Th;
+        INT Chunk = (Num + Threads - 1) / Threads;
+
+        for (INT i = 0; i < Num; i += Chunk)
+          Th.emplace_back(
+            [&F, i, Chunk, Num]( VOID )
+            {
+              for (INT j = i, e = mth::Min(i + Chunk, Num); j < e; j++)
+                F(j);
+            });
+        for (auto &T : Th)
+          T.join();
+      } /* End of 'ParallelFor' function */
+  }; /* End of 'mesh' class */
+
+  /* Mesh triangle class.
+   * Intersection is the flat triangle one; normals and texture coordinates
+   * are interpolated from mesh vertices by hit barycentric coordinates. */
+  class mesh_triangle : public triangle
+  {
+  private:
+    std::shared_ptr<const mesh> Mesh; // owning mesh
+    INT Index;                        // first index of triangle in mesh index streams
+
+  public:
+    /* Class constructor.
+     * ARGUMENTS:
+     *   - mesh:
+     *       const std::shared_ptr<const mesh> &NMesh;
+     *   - triangle number:
+     *       INT Num;
+     */
+    mesh_triangle( const std::shared_ptr<const mesh> &NMesh, INT Num ) :
+      triangle(NMesh->P[NMesh->PInd[Num * 3]], NMesh->P[NMesh->PInd[Num * 3 + 1]], NMesh->P[NMesh->PInd[Num * 3 + 2]]),
+      Mesh(NMesh), Index(Num * 3)
+    {
+    } /* End of 'mesh_triangle' function */
+
+    /* Get noramal function.
+     * ARGUMENTS:
+     *   - pointer to intersection results class:
+     *       intr *I;
+     * RETURNS: None.
+     */
+    VOID GetNormal( intr *I ) override
+    {
+      if (Mesh->NInd.empty())
+      {
+        I->N = N;
+        return;
+      }
+
+      const INT *n = &Mesh->NInd[Index];
+      vec3 s = Mesh->N[n[0]] * (1 - I->D[0] - I->D[1]) + Mesh->N[n[1]] * I->D[0] + Mesh->N[n[2]] * I->D[1];
+      DBL len = !s;
+
+      I->N = len > 0 ? s / len : N;
+    } /* End of 'GetNormal' function */
+
+    /* Get texture coordinates function.
+     * ARGUMENTS:
+     *   - intersection:
+     *       const intr *I;
+     * RETURNS: (vec2) interpolated vertex texture coordinates (barycentric if mesh has none).
+     */
+    vec2 GetTexCoord( const intr *I ) override
+    {
+      if (Mesh->UVInd.empty())
+        return triangle::GetTexCoord(I);
+
+      const INT *t = &Mesh->UVInd[Index];
+
+      return Mesh->UV[t[0]] * (1 - I->D[0] - I->D[1]) + Mesh->UV[t[1]] * I->D[0] + Mesh->UV[t[2]] * I->D[1];
+    } /* End of 'GetTexCoord' function */
+
+    /* Get texture coordinates derivatives function.
+     * Vertex texture coordinates are linear in barycentric ones.
+     * ARGUMENTS:
+     *   - intersection:
+     *       const intr *I;
+     *   - hit point derivatives along frame X and Y:
+     *       const vec3 &DPdx, &DPdy;
+     *   - texture coordinates derivatives (for output):
+     *       vec2 *DUVdx, *DUVdy;
+     * RETURNS: None.
+     */
+    VOID GetTexCoordDiff( const intr *I, const vec3 &DPdx, const vec3 &DPdy, vec2 *DUVdx, vec2 *DUVdy ) override
+    {
+      vec2 dx, dy;
+
+      triangle::GetTexCoordDiff(I, DPdx, DPdy, &dx, &dy);
+      if (Mesh->UVInd.empty())
+      {
+        *DUVdx = dx;
+        *DUVdy = dy;
+        return;
+      }
+
+      const INT *t = &Mesh->UVInd[Index];
+      vec2 e1 = Mesh->UV[t[1]] - Mesh->UV[t[0]], e2 = Mesh->UV[t[2]] - Mesh->UV[t[0]];
+
+      *DUVdx = e1 * dx[0] + e2 * dx[1];
+      *DUVdy = e1 * dy[0] + e2 * dy[1];
+    } /* End of 'GetTexCoordDiff' function */
+  }; /* End of 'mesh_triangle' class */
+} /* End of 'ivrt' namespace */
+
+#endif /* __mesh_h_ */
+
+/* END OF 'mesh.h' FILE */
@@ -47,7 +47,7 @@ namespace ivrt
       if (fabs(nd) < Threshold)
         return FALSE;
       vec3 v = R.Org;
-      Intr->T = -(Norm & v + D) / nd;
+      Intr->T = -((Norm & v) + D) / nd;
       //Intr->N = Norm;
       if (Intr->T < 0)
         return FALSE;
@@ -71,6 +71,21 @@ namespace ivrt
     {
       Intr->N = Norm;
     } /* End of 'GetNormal' function */
+
+    /* Get texture coordinates function.
+     * ARGUMENTS:
+     *   - intersection with evaluated position:
+     *      const intr *Intr;
+     * RETURNS: (vec2) point coordinates in plane basis.
+     */
+    vec2 GetTexCoord( const intr *Intr ) override
+    {
+      vec3
+        T = (Norm % (fabs(Norm[0]) > 0.9 ? vec3(0, 1, 0) : vec3(1, 0, 0))).Normalizing(),
+        B = Norm % T;
+
+      return vec2(Intr->P & T, Intr->P & B);
+    } /* End of 'GetTexCoord' function */
     /* Check if ray intersects object function.
      * ARGUMENTS: 
      *   - input ray:
@@ -84,7 +99,7 @@ namespace ivrt
       if (fabs(nd) < Threshold)
         return FALSE;
       vec3 v = R.Org;
-      res = -(Norm & v + D) / nd;
+      res = -((Norm & v) + D) / nd;
       if (res < 0)
         return FALSE;
       return TRUE;
@@ -98,18 +113,35 @@ namespace ivrt
      * RETURNS:
      *   (INT) number of intersections.
      */
-    INT AllIntersect( const ray &R, intr_list &IList )
+    INT AllIntersect( const ray &R, intr_list &IList ) override
     {
-      DBL Treshold = 1e-4;
-      DBL divider = Norm & R.Dir;
-      if (COM_ABS(divider) <= Treshold)
+      DBL nd = Norm & R.Dir, t;
+
+      if (fabs(nd) < Threshold)
         return 0;
-      DBL T = (D - (Norm & R.Org)) / divider;
-      if (T < Treshold)
+      t = -((Norm & R.Org) + D) / nd;
+      if (t < Threshold)
         return 0;
-      IList.I_list.push_back(intr(this, (D - (Norm & R.Org)) / divider));
-      return 1;
+
+      /* Plane bounds half-space behind its normal */
+      intr I(this, t, nd < 0 ? ENTER : LEAVE);
+
+      I.P = R(t);
+      I.IsPos = TRUE;
+      I.add[4] = 1;
+      return IList.Add(I);
     } /* End of 'AllIntersect' function */
+
+    /* Check if point is inside of the shape.
+     * ARGUMENTS:
+     *   - point:
+     *       const vec3 &P;
+     * RETURNS: (BOOL) TRUE if point is behind plane.
+     */
+    BOOL IsInside( const vec3 &P ) override
+    {
+      return (Norm & P) + D < 0;
+    } /* End of 'IsInside' function */
   }; /* End of 'plane' class */
 } /* end of 'ivrt' namespace */
 
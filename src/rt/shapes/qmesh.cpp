@@ -0,0 +1,558 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : qmesh.cpp
+ * PURPOSE     : Ray tracing project.
+ *               Ray tracing module.
+ *               Quantized triangle meshes implementation module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitiriev.
+ * LAST UPDATE : 08.08.2021.
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#include <algorithm>
+#include <climits>
+#include <unordered_map>
+
+#include "qmesh.h"
+
+/* Traversal stack size.
+ * Expanded node of depth D leaves at most 7 entries per upper level and
+ * pushes 8, so 7 * D + 8 entries are enough ('Build' asserts this bound;
+ * median splits keep D below 32 for any triangles count). */
+static const INT QMeshStackSize = 256;
+
+/* Encode unit normal function.
+ * ARGUMENTS:
+ *   - normal:
+ *       const vec3 &N;
+ * RETURNS: (DWORD) two 16-bit octahedral coordinates.
+ */
+DWORD ivrt::qmesh::EncodeNormal( const vec3 &N )
+{
+  DBL l = fabs(N[0]) + fabs(N[1]) + fabs(N[2]), x = 0, y = 0;
+
+  if (l > 0)
+  {
+    x = N[0] / l, y = N[1] / l;
+    /* Lower hemisphere is folded over octahedron diagonals */
+    if (N[2] < 0)
+    {
+      DBL tx = (1 - fabs(y)) * (x >= 0 ? 1 : -1);
+
+      y = (1 - fabs(x)) * (y >= 0 ? 1 : -1);
+      x = tx;
+    }
+  }
+  return (DWORD)lround((x * 0.5 + 0.5) * 65535) | (DWORD)lround((y * 0.5 + 0.5) * 65535) << 16;
+} /* End of 'ivrt::qmesh::EncodeNormal' function */
+
+/* Decode unit normal function.
+ * ARGUMENTS:
+ *   - two 16-bit octahedral coordinates:
+ *       DWORD C;
+ * RETURNS: (vec3) normal (not normalized).
+ */
+ivrt::vec3 ivrt::qmesh::DecodeNormal( DWORD C )
+{
+  DBL
+    x = (C & 0xFFFF) / 65535.0 * 2 - 1,
+    y = (C >> 16 & 0xFFFF) / 65535.0 * 2 - 1,
+    z = 1 - fabs(x) - fabs(y);
+
+  if (z < 0)
+  {
+    DBL tx = (1 - fabs(y)) * (x >= 0 ? 1 : -1);
+
+    y = (1 - fabs(x)) * (y >= 0 ? 1 : -1);
+    x = tx;
+  }
+  return vec3(x, y, z);
+} /* End of 'ivrt::qmesh::DecodeNormal' function */
+
+/* Build subtree function.
+ * Splits are the same as in 'bvh::Build'; first groups small enough
+ * become clusters with all their subtrees.
+ * ARGUMENTS:
+ *   - triangles order (subtree range is sorted):
+ *       std::vector<INT> &Order;
+ *   - triangles centers:
+ *       const std::vector<vec3> &Centers;
+ *   - triangles range in order:
+ *       INT First, Count;
+ *   - subtree cluster (-1 if subtree is above clusters):
+ *       INT Cluster;
+ *   - children triangles ranges (for boxes, by node):
+ *       std::vector<INT> &Ranges;
+ *   - subtree root depth:
+ *       INT Depth;
+ * RETURNS: (INT) subtree root node index.
+ */
+INT ivrt::qmesh::Build( std::vector<INT> &Order, const std::vector<vec3> &Centers, INT First, INT Count, INT Cluster,
+                        std::vector<INT> &Ranges, INT Depth )
+{
+  INT groups[8][2] = {{First, Count}}, ng = 1, idx = (INT)Nodes.size();
+
+  assert(7 * Depth + 8 <= QMeshStackSize);
+  Nodes.push_back(qnode());
+  Ranges.resize(Nodes.size() * 16);
+  while (ng < 8)
+  {
+    INT g = 0;
+
+    for (INT i = 1; i < ng; i++)
+      if (groups[i][1] > groups[g][1])
+        g = i;
+    if (groups[g][1] <= LeafSize)
+      break;
+
+    INT f = groups[g][0], c = groups[g][1], axis;
+    aabb centers;
+
+    for (INT i = f; i < f + c; i++)
+      centers.Grow(Centers[Order[i]]);
+    axis = centers.LongestAxis();
+    std::nth_element(Order.begin() + f, Order.begin() + f + c / 2, Order.begin() + f + c,
+      [axis, &Centers]( INT A, INT B )
+      {
+        return Centers[A][axis] < Centers[B][axis];
+      });
+    groups[g][1] = c / 2;
+    groups[ng][0] = f + c / 2;
+    groups[ng++][1] = c - c / 2;
+  }
+
+  for (INT i = 0; i < ng; i++)
+  {
+    INT f = groups[i][0], c = groups[i][1], cl = Cluster, child;
+
+    if (cl < 0 && c <= ClusterSize)
+    {
+      cluster C = {{0, 0, 0}, {0, 0}, 0, 0, f, c};
+
+      cl = (INT)Clusters.size();
+      /* Leaf entries keep cluster index in 20 bits */
+      assert(cl < 1 << 20);
+      Clusters.push_back(C);
+    }
+    if (c <= LeafSize)
+      child = ~(cl << 11 | (f - Clusters[cl].FirstTri) << 3 | (c - 1));
+    else
+      child = Build(Order, Centers, f, c, cl, Ranges, Depth + 1);
+    /* Node reference is taken only now: children building moves nodes */
+    Nodes[idx].Child[i] = child;
+    Ranges[idx * 16 + i * 2] = f;
+    Ranges[idx * 16 + i * 2 + 1] = c;
+  }
+  Nodes[idx].Used = (BYTE)((1 << ng) - 1);
+  return idx;
+} /* End of 'ivrt::qmesh::Build' function */
+
+/* Class constructor.
+ * ARGUMENTS:
+ *   - source mesh (may be freed after construction):
+ *       const mesh &M;
+ */
+ivrt::qmesh::qmesh( const mesh &M ) : Org(0), Step(1), UVOrg(0), UVStep(1)
+{
+  INT nt = M.Count();
+  std::vector<INT> Order(nt), Ranges;
+  std::vector<vec3> Centers(nt);
+  std::vector<aabb> TriBoxes(nt);
+  BOOL IsNorm = !M.NInd.empty(), IsUV = !M.UVInd.empty();
+
+  Box = aabb();
+  if (nt == 0)
+    return;
+
+  /* Hierarchy topology and clusters over source positions */
+  for (INT t = 0; t < nt; t++)
+  {
+    Order[t] = t;
+    Centers[t] = (M.P[M.PInd[t * 3]] + M.P[M.PInd[t * 3 + 1]] + M.P[M.PInd[t * 3 + 2]]) * (1.0 / 3);
+  }
+  Build(Order, Centers, 0, nt, -1, Ranges, 0);
+
+  /* Mesh grid: largest cluster spans 16 bits, whole mesh spans 30 bits */
+  aabb All;
+  vec3 ext(0);
+
+  for (auto &C : Clusters)
+  {
+    aabb B;
+
+    for (INT i = C.FirstTri * 3; i < (C.FirstTri + C.NumTris) * 3; i++)
+      B.Grow(M.P[M.PInd[Order[i / 3] * 3 + i % 3]]);
+    All.Grow(B);
+    ext = vec3::Max(ext, B.Max - B.Min);
+  }
+  Org = All.Min;
+  for (INT k = 0; k < 3; k++)
+  {
+    Step[k] = mth::Max(ext[k] / 65000, (All.Max[k] - All.Min[k]) / (1 << 30));
+    if (Step[k] <= 0)
+      Step[k] = 1;
+  }
+
+  /* Texture coordinates grid is chosen the same way */
+  if (IsUV)
+  {
+    vec2 Lo(HUGE_VAL), Hi(-HUGE_VAL), UVExt(0);
+
+    for (auto &C : Clusters)
+    {
+      vec2 CLo(HUGE_VAL), CHi(-HUGE_VAL);
+
+      for (INT i = C.FirstTri * 3; i < (C.FirstTri + C.NumTris) * 3; i++)
+      {
+        const vec2 &T = M.UV[M.UVInd[Order[i / 3] * 3 + i % 3]];
+
+        for (INT k = 0; k < 2; k++)
+          CLo[k] = mth::Min(CLo[k], T[k]), CHi[k] = mth::Max(CHi[k], T[k]);
+      }
+      for (INT k = 0; k < 2; k++)
+      {
+        Lo[k] = mth::Min(Lo[k], CLo[k]), Hi[k] = mth::Max(Hi[k], CHi[k]);
+        UVExt[k] = mth::Max(UVExt[k], CHi[k] - CLo[k]);
+      }
+    }
+    UVOrg = Lo;
+    for (INT k = 0; k < 2; k++)
+    {
+      UVStep[k] = mth::Max(UVExt[k] / 65000, (Hi[k] - Lo[k]) / (1 << 30));
+      if (UVStep[k] <= 0)
+        UVStep[k] = 1;
+    }
+    UVTris.resize(nt * 3);
+  }
+
+  /* Cluster vertices (unique position and normal pairs) and texture coordinates */
+  std::unordered_map<INT64, INT> Local, LocalUV;
+  std::vector<INT> Grid, GridUV;
+
+  Tris.resize(nt * 3);
+  for (auto &C : Clusters)
+  {
+    Local.clear();
+    Grid.clear();
+    LocalUV.clear();
+    GridUV.clear();
+    C.FirstVert = (INT)Verts.size() / 3;
+    C.FirstUV = (INT)UVs.size();
+    C.Base[0] = C.Base[1] = C.Base[2] = INT_MAX;
+    C.UVBase[0] = C.UVBase[1] = IsUV ? INT_MAX : 0;
+    for (INT i = C.FirstTri * 3; i < (C.FirstTri + C.NumTris) * 3; i++)
+    {
+      INT
+        src = Order[i / 3] * 3 + i % 3,
+        p = M.PInd[src],
+        n = IsNorm ? M.NInd[src] : 0;
+
+      if (IsUV)
+      {
+        INT uv = M.UVInd[src];
+        auto ItUV = LocalUV.find(uv);
+
+        if (ItUV != LocalUV.end())
+          UVTris[i] = (WORD)ItUV->second;
+        else
+        {
+          UVTris[i] = (WORD)(GridUV.size() / 2);
+          LocalUV[uv] = (INT)GridUV.size() / 2;
+          for (INT k = 0; k < 2; k++)
+          {
+            GridUV.push_back((INT)llround((M.UV[uv][k] - UVOrg[k]) / UVStep[k]));
+            C.UVBase[k] = mth::Min(C.UVBase[k], GridUV.back());
+          }
+        }
+      }
+
+      auto It = Local.find((INT64)p << 32 | (UINT)n);
+
+      if (It != Local.end())
+      {
+        Tris[i] = (WORD)It->second;
+        continue;
+      }
+      Tris[i] = (WORD)(Grid.size() / 3);
+      Local[(INT64)p << 32 | (UINT)n] = (INT)Grid.size() / 3;
+      for (INT k = 0; k < 3; k++)
+      {
+        Grid.push_back((INT)llround((M.P[p][k] - Org[k]) / Step[k]));
+        C.Base[k] = mth::Min(C.Base[k], Grid.back());
+      }
+      if (IsNorm)
+        Normals.push_back(EncodeNormal(M.N[n]));
+    }
+    for (size_t i = 0; i < Grid.size(); i++)
+      Verts.push_back((WORD)(Grid[i] - C.Base[i % 3]));
+    for (size_t i = 0; i < GridUV.size(); i += 2)
+      UVs.push_back((DWORD)(GridUV[i] - C.UVBase[0]) | (DWORD)(GridUV[i + 1] - C.UVBase[1]) << 16);
+  }
+
+  /* Nodes boxes are built over decoded triangles, so they bound what is intersected */
+  for (auto &C : Clusters)
+    for (INT t = C.FirstTri; t < C.FirstTri + C.NumTris; t++)
+    {
+      vec3 P[3];
+
+      Triangle(C, t, P);
+      TriBoxes[t].Grow(P[0]).Grow(P[1]).Grow(P[2]);
+      Box.Grow(TriBoxes[t]);
+    }
+  for (INT n = 0; n < (INT)Nodes.size(); n++)
+  {
+    qnode &N = Nodes[n];
+    aabb lanes[8], all;
+
+    for (INT i = 0; i < 8; i++)
+      if (N.Used & (1 << i))
+      {
+        for (INT t = Ranges[n * 16 + i * 2]; t < Ranges[n * 16 + i * 2] + Ranges[n * 16 + i * 2 + 1]; t++)
+          lanes[i].Grow(TriBoxes[t]);
+        all.Grow(lanes[i]);
+      }
+    for (INT k = 0; k < 3; k++)
+    {
+      /* Frame is widened a bit, so outward rounded bytes always fit */
+      DBL e = mth::Max(all.Max[k] - all.Min[k], mth::Max(fabs(all.Min[k]), fabs(all.Max[k])) * 1e-6 + 1e-30);
+      FLT o = mth::aabb8::RoundDown(all.Min[k] - e * 1e-4), s = mth::aabb8::RoundUp(e * 1.0003 / 255);
+
+      N.Org[k] = o;
+      N.Step[k] = s;
+      for (INT i = 0; i < 8; i++)
+      {
+        INT
+          lo = mth::Min(mth::Max((INT)floor((lanes[i].Min[k] - o) / s), 0), 255),
+          hi = mth::Min(mth::Max((INT)ceil((lanes[i].Max[k] - o) / s), 0), 255);
+
+        if (!(N.Used & (1 << i)))
+          lo = 255, hi = 0;
+        else
+        {
+          /* Decoded corners are checked with float arithmetic of traversal and some slack */
+          while (lo > 0 && (DBL)(FLT)(o + (FLT)lo * s) > lanes[i].Min[k] - s * 0.01)
+            lo--;
+          while (hi < 255 && (DBL)(FLT)(o + (FLT)hi * s) < lanes[i].Max[k] + s * 0.01)
+            hi++;
+        }
+        N.Lo[k][i] = (BYTE)lo;
+        N.Hi[k][i] = (BYTE)hi;
+      }
+    }
+  }
+} /* End of 'ivrt::qmesh::qmesh' function */
+
+/* Find intersection function.
+ * Hit children are pushed farthest first, as in 'bvh::Intersection'.
+ * ARGUMENTS:
+ *   - ray:
+ *       const ray &R;
+ *   - intersection (cluster and triangle are kept in I[0] and I[1]):
+ *       intr *Intr;
+ * RETURNS: (BOOL) TRUE if intersected, FALSE otherwise.
+ */
+BOOL ivrt::qmesh::Intersection( const ray &R, intr *Intr )
+{
+  if (Nodes.empty())
+    return FALSE;
+
+  tri_ray tr(R);
+  mth::inv_ray8 ir((inv_ray(R)));
+  INT stack[QMeshStackSize], top = 0, hit = -1, hitc = -1;
+  FLT dist[QMeshStackSize];
+  DBL best = HUGE_VAL, bu = 0, bv = 0;
+
+  stack[top] = 0, dist[top++] = 0;
+  while (top > 0)
+  {
+    INT n = stack[--top];
+
+    if (dist[top] > best)
+      continue;
+
+    /* Leaf entry: ~(cluster << 11 | first cluster triangle << 3 | count - 1) */
+    if (n < 0)
+    {
+      INT r = ~n, c = r >> 11, t = Clusters[c].FirstTri + (r >> 3 & 255);
+
+      for (INT k = t; k <= t + (r & 7); k++)
+      {
+        vec3 P[3];
+        DBL d, u, v;
+
+        IVRT_STAT(ShapeTests);
+        Triangle(Clusters[c], k, P);
+        if (tr.Intersect(P[0], P[1], P[2], best, &d, &u, &v))
+          best = d, bu = u, bv = v, hit = k, hitc = c;
+      }
+      continue;
+    }
+
+    const qnode &N = Nodes[n];
+    mth::flt8 tn;
+    INT mask = Boxes(N).Intersect(ir, mth::aabb8::RoundUp(best), &tn) & N.Used, order[8], no = 0;
+
+    IVRT_STAT(NodeVisits);
+    for (INT i = 0; i < 8; i++)
+      if (mask & (1 << i))
+      {
+        INT j = no++;
+
+        for (; j > 0 && tn[order[j - 1]] < tn[i]; j--)
+          order[j] = order[j - 1];
+        order[j] = i;
+      }
+    for (INT j = 0; j < no; j++)
+    {
+      stack[top] = N.Child[order[j]];
+      dist[top++] = tn[order[j]];
+    }
+  }
+  if (hit < 0)
+    return FALSE;
+  Intr->Shp = this;
+  Intr->T = best;
+  /* Barycentric coordinates of second and third vertices */
+  Intr->D[0] = bu;
+  Intr->D[1] = bv;
+  Intr->I[0] = hitc;
+  Intr->I[1] = hit;
+  for (INT i = 0; i < 5; i++)
+    Intr->add[i] = 0;
+  return TRUE;
+} /* End of 'ivrt::qmesh::Intersection' function */
+
+/* Check if ray intersects mesh function.
+ * ARGUMENTS:
+ *   - ray:
+ *       const ray &R;
+ * RETURNS: (BOOL) TRUE if intersected, FALSE otherwise.
+ */
+BOOL ivrt::qmesh::IsIntersected( const ray &R )
+{
+  if (Nodes.empty())
+    return FALSE;
+
+  tri_ray tr(R);
+  mth::inv_ray8 ir((inv_ray(R)));
+  INT stack[QMeshStackSize], top = 0;
+
+  stack[top++] = 0;
+  while (top > 0)
+  {
+    INT n = stack[--top];
+
+    if (n < 0)
+    {
+      INT r = ~n, c = r >> 11, t = Clusters[c].FirstTri + (r >> 3 & 255);
+
+      for (INT k = t; k <= t + (r & 7); k++)
+      {
+        vec3 P[3];
+        DBL d, u, v;
+
+        IVRT_STAT(ShapeTests);
+        Triangle(Clusters[c], k, P);
+        if (tr.Intersect(P[0], P[1], P[2], HUGE_VAL, &d, &u, &v))
+          return TRUE;
+      }
+      continue;
+    }
+
+    const qnode &N = Nodes[n];
+    INT mask = Boxes(N).Intersect(ir, std::numeric_limits<FLT>::infinity()) & N.Used;
+
+    IVRT_STAT(NodeVisits);
+    for (INT i = 0; i < 8; i++)
+      if (mask & (1 << i))
+        stack[top++] = N.Child[i];
+  }
+  return FALSE;
+} /* End of 'ivrt::qmesh::IsIntersected' function */
+
+/* Get noramal function.
+ * ARGUMENTS:
+ *   - pointer to intersection results class:
+ *       intr *I;
+ * RETURNS: None.
+ */
+VOID ivrt::qmesh::GetNormal( intr *I )
+{
+  const cluster &C = Clusters[I->I[0]];
+  const WORD *t = &Tris[I->I[1] * 3];
+
+  if (Normals.empty())
+  {
+    vec3 P[3];
+
+    Triangle(C, I->I[1], P);
+    I->N = ((P[1] - P[0]) % (P[2] - P[0])).Normalizing();
+    return;
+  }
+  I->N = (DecodeNormal(Normals[C.FirstVert + t[0]]) * (1 - I->D[0] - I->D[1]) +
+          DecodeNormal(Normals[C.FirstVert + t[1]]) * I->D[0] +
+          DecodeNormal(Normals[C.FirstVert + t[2]]) * I->D[1]).Normalizing();
+} /* End of 'ivrt::qmesh::GetNormal' function */
+
+/* Get texture coordinates function.
+ * ARGUMENTS:
+ *   - intersection:
+ *       const intr *I;
+ * RETURNS: (vec2) interpolated vertex texture coordinates (barycentric if mesh has none).
+ */
+ivrt::vec2 ivrt::qmesh::GetTexCoord( const intr *I )
+{
+  vec2 UV[3];
+
+  if (UVTris.empty())
+    return vec2(I->D[0], I->D[1]);
+  TriangleUV(Clusters[I->I[0]], I->I[1], UV);
+  return UV[0] * (1 - I->D[0] - I->D[1]) + UV[1] * I->D[0] + UV[2] * I->D[1];
+} /* End of 'ivrt::qmesh::GetTexCoord' function */
+
+/* Get texture coordinates derivatives function.
+ * Barycentric coordinates are linear on triangle plane, vertex texture
+ * coordinates are linear in barycentric ones.
+ * ARGUMENTS:
+ *   - intersection:
+ *       const intr *I;
+ *   - hit point derivatives along frame X and Y:
+ *       const vec3 &DPdx, &DPdy;
+ *   - texture coordinates derivatives (for output):
+ *       vec2 *DUVdx, *DUVdy;
+ * RETURNS: None.
+ */
+VOID ivrt::qmesh::GetTexCoordDiff( const intr *I, const vec3 &DPdx, const vec3 &DPdy, vec2 *DUVdx, vec2 *DUVdy )
+{
+  vec3 P[3];
+
+  Triangle(Clusters[I->I[0]], I->I[1], P);
+
+  vec3 e1 = P[1] - P[0], e2 = P[2] - P[0], n = e1 % e2;
+  DBL a = n & n;
+
+  if (a == 0)
+  {
+    *DUVdx = *DUVdy = vec2(0);
+    return;
+  }
+  *DUVdx = vec2(((DPdx % e2) & n) / a, ((e1 % DPdx) & n) / a);
+  *DUVdy = vec2(((DPdy % e2) & n) / a, ((e1 % DPdy) & n) / a);
+  if (UVTris.empty())
+    return;
+
+  vec2 UV[3], dx = *DUVdx, dy = *DUVdy;
+
+  TriangleUV(Clusters[I->I[0]], I->I[1], UV);
+  *DUVdx = (UV[1] - UV[0]) * dx[0] + (UV[2] - UV[0]) * dx[1];
+  *DUVdy = (UV[1] - UV[0]) * dy[0] + (UV[2] - UV[0]) * dy[1];
+} /* End of 'ivrt::qmesh::GetTexCoordDiff' function */
+
+/* END OF 'qmesh.cpp' FILE */
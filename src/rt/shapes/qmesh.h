@@ -0,0 +1,254 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : qmesh.h
+ * PURPOSE     : Ray tracing project.
+ *               Ray tracing module.
+ *               Quantized triangle meshes module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitiriev.
+ * LAST UPDATE : 08.08.2021.
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __qmesh_h_
+#define __qmesh_h_
+
+#include <vector>
+
+#include "mesh.h"
+
+/* Project name space */
+namespace ivrt
+{
+  /* Quantized mesh class (compressed storage for very large models).
+   * Mesh is one shape with own eight-wide hierarchy over its triangles.
+   * Subtrees of up to 'ClusterSize' triangles are clusters: their vertices
+   * keep 16-bit offsets from cluster corner on mesh-wide grid, triangles
+   * keep 16-bit cluster vertex indices. Grid step fits largest cluster in
+   * 16 bits; since it is shared, vertex of neighbour clusters decodes to
+   * the same point and mesh stays watertight. Texture coordinates are
+   * kept the same way on own 2D grid with own cluster index stream, so
+   * UV seams don't split position vertices. Nodes keep children boxes
+   * as bytes in node box frame, rounded outwards. Everything is decoded
+   * on the fly during traversal. */
+  class qmesh : public shape
+  {
+  private:
+    /* Quantized hierarchy node */
+    struct qnode
+    {
+      FLT Org[3], Step[3]; // children boxes frame (box coordinate = Org + byte * Step)
+      BYTE Lo[3][8], Hi[3][8]; // children boxes corners by axes
+      INT Child[8];        // child node index or ~(cluster << 11 | first cluster triangle << 3 | count - 1)
+      BYTE Used;           // used children lanes mask
+    }; /* End of 'qnode' structure */
+
+    /* Vertices and triangles cluster */
+    struct cluster
+    {
+      INT Base[3];         // cluster corner on mesh grid
+      INT UVBase[2];       // cluster texture coordinates corner on mesh texture grid
+      INT FirstVert;       // first cluster vertex in 'Verts'
+      INT FirstUV;         // first cluster texture coordinates in 'UVs'
+      INT FirstTri;        // first cluster triangle in 'Tris'
+      INT NumTris;         // number of cluster triangles
+    }; /* End of 'cluster' structure */
+
+    vec3 Org, Step;                 // mesh grid origin and steps
+    vec2 UVOrg, UVStep;             // mesh texture coordinates grid origin and steps
+    std::vector<qnode> Nodes;       // hierarchy nodes (root is first)
+    std::vector<cluster> Clusters;  // clusters
+    std::vector<WORD> Verts;        // vertices grid offsets from cluster corner (3 per vertex)
+    std::vector<WORD> Tris;         // triangles cluster vertex indices (3 per triangle)
+    std::vector<DWORD> Normals;     // vertices octahedral normals (empty if mesh has no normals)
+    std::vector<DWORD> UVs;         // texture coordinates grid offsets from cluster corner (16 bits each)
+    std::vector<WORD> UVTris;       // triangles cluster texture coordinates indices (empty if mesh has no UVs)
+
+    /* Decode vertex position function.
+     * ARGUMENTS:
+     *   - cluster:
+     *       const cluster &C;
+     *   - cluster vertex index:
+     *       INT V;
+     * RETURNS: (vec3) position.
+     */
+    vec3 Vertex( const cluster &C, INT V ) const
+    {
+      const WORD *q = &Verts[(C.FirstVert + V) * 3];
+
+      return vec3(Org[0] + (C.Base[0] + q[0]) * Step[0],
+                  Org[1] + (C.Base[1] + q[1]) * Step[1],
+                  Org[2] + (C.Base[2] + q[2]) * Step[2]);
+    } /* End of 'Vertex' function */
+
+    /* Decode triangle vertices function.
+     * ARGUMENTS:
+     *   - cluster:
+     *       const cluster &C;
+     *   - triangle number (in mesh):
+     *       INT T;
+     *   - vertices (for output):
+     *       vec3 *P;
+     * RETURNS: None.
+     */
+    VOID Triangle( const cluster &C, INT T, vec3 *P ) const
+    {
+      for (INT i = 0; i < 3; i++)
+        P[i] = Vertex(C, Tris[T * 3 + i]);
+    } /* End of 'Triangle' function */
+
+    /* Decode triangle texture coordinates function.
+     * ARGUMENTS:
+     *   - cluster:
+     *       const cluster &C;
+     *   - triangle number (in mesh):
+     *       INT T;
+     *   - texture coordinates (for output):
+     *       vec2 *UV;
+     * RETURNS: None.
+     */
+    VOID TriangleUV( const cluster &C, INT T, vec2 *UV ) const
+    {
+      for (INT i = 0; i < 3; i++)
+      {
+        DWORD q = UVs[C.FirstUV + UVTris[T * 3 + i]];
+
+        UV[i] = vec2(UVOrg[0] + (C.UVBase[0] + (INT)(q & 0xFFFF)) * UVStep[0],
+                     UVOrg[1] + (C.UVBase[1] + (INT)(q >> 16)) * UVStep[1]);
+      }
+    } /* End of 'TriangleUV' function */
+
+    /* Decode node children boxes function.
+     * ARGUMENTS:
+     *   - node:
+     *       const qnode &N;
+     * RETURNS: (mth::aabb8) children boxes (unused lanes are not masked).
+     */
+    static mth::aabb8 Boxes( const qnode &N )
+    {
+      mth::aabb8 B;
+      mth::flt8 *Min[3] = {&B.Min.X, &B.Min.Y, &B.Min.Z}, *Max[3] = {&B.Max.X, &B.Max.Y, &B.Max.Z};
+
+      for (INT k = 0; k < 3; k++)
+      {
+        mth::flt8 o(N.Org[k]), s(N.Step[k]);
+
+        *Min[k] = o + mth::flt8::LoadBytes(N.Lo[k]) * s;
+        *Max[k] = o + mth::flt8::LoadBytes(N.Hi[k]) * s;
+      }
+      return B;
+    } /* End of 'Boxes' function */
+
+    /* Encode unit normal function.
+     * ARGUMENTS:
+     *   - normal:
+     *       const vec3 &N;
+     * RETURNS: (DWORD) two 16-bit octahedral coordinates.
+     */
+    static DWORD EncodeNormal( const vec3 &N );
+
+    /* Decode unit normal function.
+     * ARGUMENTS:
+     *   - two 16-bit octahedral coordinates:
+     *       DWORD C;
+     * RETURNS: (vec3) normal (not normalized).
+     */
+    static vec3 DecodeNormal( DWORD C );
+
+    /* Build subtree function.
+     * ARGUMENTS:
+     *   - triangles order (subtree range is sorted):
+     *       std::vector<INT> &Order;
+     *   - triangles centers:
+     *       const std::vector<vec3> &Centers;
+     *   - triangles range in order:
+     *       INT First, Count;
+     *   - subtree cluster (-1 if subtree is above clusters):
+     *       INT Cluster;
+     *   - children triangles ranges (for boxes, by node):
+     *       std::vector<INT> &Ranges;
+     *   - subtree root depth:
+     *       INT Depth;
+     * RETURNS: (INT) subtree root node index.
+     */
+    INT Build( std::vector<INT> &Order, const std::vector<vec3> &Centers, INT First, INT Count, INT Cluster,
+               std::vector<INT> &Ranges, INT Depth );
+
+  public:
+    static const INT LeafSize = 8;      // maximal number of triangles in leaf
+    static const INT ClusterSize = 256; // maximal number of triangles in cluster
+
+    /* Class constructor.
+     * ARGUMENTS:
+     *   - source mesh (may be freed after construction):
+     *       const mesh &M;
+     */
+    qmesh( const mesh &M );
+
+    /* Get storage size function.
+     * ARGUMENTS: None.
+     * RETURNS: (size_t) size of vertices, triangles, clusters and nodes in bytes.
+     */
+    size_t Size( VOID ) const
+    {
+      return Nodes.size() * sizeof(qnode) + Clusters.size() * sizeof(cluster) +
+             (Verts.size() + Tris.size() + UVTris.size()) * sizeof(WORD) + (Normals.size() + UVs.size()) * sizeof(DWORD);
+    } /* End of 'Size' function */
+
+    /* Find intersection function.
+     * ARGUMENTS:
+     *   - ray:
+     *       const ray &R;
+     *   - intersection (cluster and triangle are kept in I[0] and I[1]):
+     *       intr *Intr;
+     * RETURNS: (BOOL) TRUE if intersected, FALSE otherwise.
+     */
+    BOOL Intersection( const ray &R, intr *Intr ) override;
+
+    /* Check if ray intersects mesh function.
+     * ARGUMENTS:
+     *   - ray:
+     *       const ray &R;
+     * RETURNS: (BOOL) TRUE if intersected, FALSE otherwise.
+     */
+    BOOL IsIntersected( const ray &R ) override;
+
+    /* Get noramal function.
+     * ARGUMENTS:
+     *   - pointer to intersection results class:
+     *       intr *I;
+     * RETURNS: None.
+     */
+    VOID GetNormal( intr *I ) override;
+
+    /* Get texture coordinates function.
+     * ARGUMENTS:
+     *   - intersection:
+     *       const intr *I;
+     * RETURNS: (vec2) interpolated vertex texture coordinates (barycentric if mesh has none).
+     */
+    vec2 GetTexCoord( const intr *I ) override;
+
+    /* Get texture coordinates derivatives function.
+     * ARGUMENTS:
+     *   - intersection:
+     *       const intr *I;
+     *   - hit point derivatives along frame X and Y:
+     *       const vec3 &DPdx, &DPdy;
+     *   - texture coordinates derivatives (for output):
+     *       vec2 *DUVdx, *DUVdy;
+     * RETURNS: None.
+     */
+    VOID GetTexCoordDiff( const intr *I, const vec3 &DPdx, const vec3 &DPdy, vec2 *DUVdx, vec2 *DUVdy ) override;
+  }; /* End of 'qmesh' class */
+} /* End of 'ivrt' namespace */
+
+#endif /* __qmesh_h_ */
+
+/* END OF 'qmesh.h' FILE */
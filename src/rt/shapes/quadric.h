@@ -1,216 +1,261 @@
-/***************************************************************
- * Copyright (C) 2015
- * Computer Graphics Support Group of 30 Phys-Math Lyceum
- ***************************************************************/
-/* FILE NAME   : quadric.H
- * PURPOSE     : Ray tracing project.
- *               Ray  tracing quadric module.
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : quadric.h
+ * PURPOSE     : Raytracing project.
+ *               Quadric surfaces class declaration module.
  * PROGRAMMER  : CGSG-SummerCamp'2021.
- *               Ivan Dmitriev.
- * LAST UPDATE : 04.08.2021.
- * NOTE        : None.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'ivrt'.
  *
  * No part of this file may be changed without agreement of
  * Computer Graphics Support Group of 30 Phys-Math Lyceum
  */
 
-#ifndef __QUADRIC_H_
-#define __QUADRIC_H_
+#ifndef __quadric_h_
+#define __quadric_h_
 
-#include "def.h"
+#include "../rt_def.h"
 
-/* Ray tracing work namespace */
+/* Project namespace */
 namespace ivrt
 {
-  /* Quadruc surface representation form */
+  /* Quadric surface class.
+   * Surface is Q(P) = A x^2 + 2B xy + 2C xz + 2D x + E y^2 + 2F yz + 2G y +
+   *                   H z^2 + 2I z + J = 0,
+   * inside is Q(P) < 0. Coefficients are kept as symmetric matrix rows, so
+   * the ray quadratic and the gradient are a few dot products. Surface is
+   * clipped by a box, which is also its bounding box (unbounded by default). */
   class quadric : public shape
   {
   private:
-    /* Quadric surface coefficent */
-    DBL A, B, C, D, E, F, G, H, I, J;
+    vec3 M0, M1, M2; // quadratic form matrix rows: (A, B, C), (B, E, F), (C, F, H)
+    vec3 L;          // linear part: (D, G, I)
+    DBL J;           // constant part
+    aabb Clip;       // clipping (and bounding) box
+    BOOL IsClipped;  // clipping box is finite
 
-  public:
-    /* Quadric surface constructor.
+    /* Evaluate linear map M * P + L function.
      * ARGUMENTS:
-     *   - coefficents:
-     *       DBL A, B, C, D, E, F, G, H, I, J;
-     *   - color:
-     *       const color &Color = color(1);
+     *   - point:
+     *       const vec3 &P;
+     * RETURNS: (vec3) half gradient at point.
      */
-    quadric( DBL A, DBL B, DBL C, DBL D, DBL E, DBL F, DBL G, DBL H, DBL I, DBL J,
-             const color &Color = color(1) ) :
-             shape(Color), A(A), B(B), C(C), D(D), E(E), F(F), G(G), H(H), I(I), J(J)
+    vec3 Grad( const vec3 &P ) const
     {
-    } /* End of 'quadric' function */
+      return vec3(M0 & P, M1 & P, M2 & P) + L;
+    } /* End of 'Grad' function */
 
-    /* Intersect find function.
+    /* Find ray and surface intersections function.
      * ARGUMENTS:
-     *   - ray to find intersect:
+     *   - ray:
      *       const ray &R;
-     *   - intersect pointer (for output):
-     *       intr *Intr;
-     * RETURNS:
-     *   (BOOL) has intersection.
+     *   - result distances (ascending, inside clipping box, beyond Threshold):
+     *       DBL *T;
+     * RETURNS: (INT) number of intersections (0..2).
      */
-    BOOL Intersect( const ray &R, intr *Intr )
+    INT Roots( const ray &R, DBL *T ) const
     {
-      DBL Treshold = 1e-4;
-      DBL Dx = R.Dir[0], Dy = R.Dir[1], Dz = R.Dir[2],
-          Ox = R.Org[0], Oy = R.Org[1], Oz = R.Org[2];
-
+      vec3 g = Grad(R.Org);
       DBL
-        a = A * Dx * Dx + 2 * B * Dx * Dy + 2 * C * Dx * Dz + E * Dy * Dy +
-            2 * F * Dy * Dz + H * Dz * Dz,
-        b = A * Ox * Dx + B * (Ox * Dy + Dx * Oy) + C * (Ox * Dz + Dx * Oz) +
-            D * Dx + E * Oy * Dy + F * (Oy * Dz + Dy * Oz) + G * Dy + H * Oz * Dz + I * Dz,
-        c = A * Ox * Ox + 2 * B * Ox * Oy + 2 * C * Ox * Oz + 2 * D * Ox + E * Oy * Oy +
-            2 * F * Oy * Oz + 2 * G * Oy + H * Oz * Oz + 2 * I * Oz + J,
-        d = b * b - a * c;
-
-      if (COM_ABS(a) < Treshold)
-        return FALSE;
-      if (d < Treshold)
-        return FALSE;
-      d = sqrt(d);
+        a = R.Dir & vec3(M0 & R.Dir, M1 & R.Dir, M2 & R.Dir),
+        b = R.Dir & g,
+        c = (R.Org & (g + L)) + J,
+        tn = -HUGE_VAL, tf = HUGE_VAL, t[2];
+      INT n = 0, k = 0;
 
-      DBL t1 = (-b + d) / a, t2 = (-b - d) / a;
-      if (a < 0)
+      if (fabs(a) < 1e-12)
       {
-        DBL tmp;
-        COM_SWAP(t1, t2, tmp);
+        /* Ray parallel to asymptotic direction: one root */
+        if (b == 0)
+          return 0;
+        t[n++] = -c / (2 * b);
       }
-      if (t2 > 0)
+      else
       {
-        Intr->Set(this, t2, TRUE);
-        return TRUE;
-      }
-      if (t1 > 0)
-      {
-        Intr->Set(this, t1, FALSE);
-        return TRUE;
+        DBL d = b * b - a * c, q;
+
+        if (d < 0)
+          return 0;
+        /* Numerically stable roots of a t^2 + 2b t + c */
+        q = -(b + (b < 0 ? -sqrt(d) : sqrt(d)));
+        t[0] = q / a;
+        t[1] = q != 0 ? c / q : t[0];
+        if (t[0] > t[1])
+          COM_SWAP(t[0], t[1], q);
+        n = 2;
       }
-      return FALSE;
-    } /* End of 'Intersect' function */
+      if (IsClipped && !Clip.Intersect(inv_ray(R), HUGE_VAL, &tn, &tf))
+        return 0;
+      for (INT i = 0; i < n; i++)
+        if (t[i] > Threshold && t[i] >= tn && t[i] <= tf)
+          T[k++] = t[i];
+      return k;
+    } /* End of 'Roots' function */
 
-    /* Check for intersection function.
+  public:
+    /* Class constructor.
      * ARGUMENTS:
-     *   - ray to check:
-     *       const ray &R;
-     * RETURNS:
-     *   (BOOL) has intersection.
+     *   - coefficients:
+     *       DBL A, B, C, D, E, F, G, H, I, J;
+     *   - material:
+     *       const surface &S;
+     *   - clipping box (infinite if omitted):
+     *       const aabb &NClip;
      */
-    BOOL IsIntersect( const ray &R )
+    quadric( DBL A, DBL B, DBL C, DBL D, DBL E, DBL F, DBL G, DBL H, DBL I, DBL NJ,
+             const surface &S = surface(), const aabb &NClip = aabb(vec3(-HUGE_VAL), vec3(HUGE_VAL)) ) :
+      M0(A, B, C), M1(B, E, F), M2(C, F, H), L(D, G, I), J(NJ), Clip(NClip),
+      IsClipped(fabs(NClip.Min[0]) < HUGE_VAL || fabs(NClip.Min[1]) < HUGE_VAL || fabs(NClip.Min[2]) < HUGE_VAL ||
+                fabs(NClip.Max[0]) < HUGE_VAL || fabs(NClip.Max[1]) < HUGE_VAL || fabs(NClip.Max[2]) < HUGE_VAL)
     {
-      DBL Treshold = 1e-4;
-      DBL Dx = R.Dir[0], Dy = R.Dir[1], Dz = R.Dir[2],
-          Ox = R.Org[0], Oy = R.Org[1], Oz = R.Org[2];
+      mtl = S;
+      Box = Clip;
+    } /* End of 'quadric' function */
 
-      DBL
-        a = A * Dx * Dx + 2 * B * Dx * Dy + 2 * C * Dx * Dz + E * Dy * Dy +
-            2 * F * Dy * Dz + H * Dz * Dz,
-        b = A * Ox * Dx + B * (Ox * Dy + Dx * Oy) + C * (Ox * Dz + Dx * Oz) +
-            D * Dx + E * Oy * Dy + F * (Oy * Dz + Dy * Oz) + G * Dy + H * Oz * Dz + I * Dz,
-        c = A * Ox * Ox + 2 * B * Ox * Oy + 2 * C * Ox * Oz + 2 * D * Ox + E * Oy * Oy +
-            2 * F * Oy * Oz + 2 * G * Oy + H * Oz * Oz + 2 * I * Oz + J,
-        d = b * b - a * c;
-
-      if (COM_ABS(a) < Treshold)
-        return FALSE;
-      if (d < Treshold)
+    /* Create ellipsoid function.
+     * ARGUMENTS:
+     *   - center:
+     *       const vec3 &C;
+     *   - semi-axes along X, Y, Z:
+     *       const vec3 &R;
+     *   - material:
+     *       const surface &S;
+     * RETURNS: (quadric *) created shape.
+     */
+    static quadric * Ellipsoid( const vec3 &C, const vec3 &R, const surface &S = surface() )
+    {
+      vec3 k(1 / (R[0] * R[0]), 1 / (R[1] * R[1]), 1 / (R[2] * R[2])), kc = k * C;
+
+      return new quadric(k[0], 0, 0, -kc[0], k[1], 0, -kc[1], k[2], -kc[2], (kc & C) - 1, S,
+                         aabb(C - R - Threshold, C + R + Threshold));
+    } /* End of 'Ellipsoid' function */
+
+    /* Create vertical cylinder function.
+     * ARGUMENTS:
+     *   - bottom center:
+     *       const vec3 &C;
+     *   - radius and height:
+     *       DBL R, H;
+     *   - material:
+     *       const surface &S;
+     * RETURNS: (quadric *) created shape (open tube, Y axis).
+     */
+    static quadric * Cylinder( const vec3 &C, DBL R, DBL H, const surface &S = surface() )
+    {
+      return new quadric(1, 0, 0, -C[0], 0, 0, 0, 1, -C[2], C[0] * C[0] + C[2] * C[2] - R * R, S,
+                         aabb(vec3(C[0] - R, C[1], C[2] - R) - Threshold, vec3(C[0] + R, C[1] + H, C[2] + R) + Threshold));
+    } /* End of 'Cylinder' function */
+
+    /* Create vertical cone function.
+     * ARGUMENTS:
+     *   - apex:
+     *       const vec3 &C;
+     *   - base radius and height (base is below apex):
+     *       DBL R, H;
+     *   - material:
+     *       const surface &S;
+     * RETURNS: (quadric *) created shape (open, Y axis).
+     */
+    static quadric * Cone( const vec3 &C, DBL R, DBL H, const surface &S = surface() )
+    {
+      DBL k2 = R * R / (H * H);
+
+      return new quadric(1, 0, 0, -C[0], -k2, 0, k2 * C[1], 1, -C[2],
+                         C[0] * C[0] + C[2] * C[2] - k2 * C[1] * C[1], S,
+                         aabb(vec3(C[0] - R, C[1] - H, C[2] - R) - Threshold, vec3(C[0] + R, C[1], C[2] + R) + Threshold));
+    } /* End of 'Cone' function */
+
+    /* Find intersection function.
+     * ARGUMENTS:
+     *   - ray:
+     *      const ray &R;
+     *   - intersection point on ray:
+     *      intr *Intr;
+     * RETURNS: (BOOL) TRUE if success, FALSE otherwise.
+     */
+    BOOL Intersection( const ray &R, intr *Intr ) override
+    {
+      DBL t[2];
+
+      if (Roots(R, t) == 0)
         return FALSE;
-      d = sqrt(d);
+      Intr->Shp = this;
+      Intr->T = t[0];
+      Intr->P = R(t[0]);
+      Intr->IsPos = TRUE;
+      for (INT i = 0; i < 5; i++)
+        Intr->add[i] = 0;
+      return TRUE;
+    } /* End of 'Intersection' function */
 
-      DBL t1 = (-b + d) / a, t2 = (-b - d) / a;
-      if (a < 0)
-      {
-        DBL tmp;
-        COM_SWAP(t1, t2, tmp);
-      }
-      return t2 > 0 || t1 > 0;
-    } /* End of 'IsIntersect' function */
+    /* Check if ray intersects object function.
+     * ARGUMENTS:
+     *   - input ray:
+     *      const ray &R;
+     * RETURNS: (BOOL) TRUE if success, FALSE otherwise.
+     */
+    BOOL IsIntersected( const ray &R ) override
+    {
+      DBL t[2];
+
+      return Roots(R, t) != 0;
+    } /* End of 'IsIntersected' function */
+
+    /* Get normal function.
+     * ARGUMENTS:
+     *   - intersection point on ray:
+     *      intr *Intr;
+     * RETURNS: NONE.
+     */
+    VOID GetNormal( intr *Intr ) override
+    {
+      Intr->N = Grad(Intr->P).Normalizing();
+    } /* End of 'GetNormal' function */
 
-    /* Check if point is inside function.
+    /* Check if point is inside of the shape.
      * ARGUMENTS:
-     *   - point to check:
-     *       const vec &P;
-     * RETURNS:
-     *   (BOOL) is inside.
+     *   - point:
+     *       const vec3 &P;
+     * RETURNS: (BOOL) TRUE if point is inside.
      */
-    BOOL IsInside( const vec &P )
+    BOOL IsInside( const vec3 &P ) override
     {
-      DBL Treshold = 1e-4, X = P[0], Y = P[1], Z = P[2];
-      return A * X * X + E * Y * Y + H * Z * Z + 2 * B * X * Y + 2 * C * X * Z +
-             2 * D * X + 2 * F * Y * Z + 2 * G * Y + 2 * I * Z + J > Treshold;
+      if (IsClipped && (P[0] < Clip.Min[0] || P[1] < Clip.Min[1] || P[2] < Clip.Min[2] ||
+                        P[0] > Clip.Max[0] || P[1] > Clip.Max[1] || P[2] > Clip.Max[2]))
+        return FALSE;
+      return (P & (Grad(P) + L)) + J < 0;
     } /* End of 'IsInside' function */
 
     /* Find all intersections function.
      * ARGUMENTS:
-     *   - ray to find intersections:
+     *   - ray:
      *       const ray &R;
-     *   - intersection list (for output):
+     *   - intersections list to be extended:
      *       intr_list &IList;
-     * RETURNS:
-     *  (INT) number of intersections.
+     * RETURNS: (INT) number of found intersections.
      */
-    INT AllIntersect( const ray &R, intr_list &IList )
+    INT AllIntersect( const ray &R, intr_list &IList ) override
     {
-      DBL Treshold = 1e-4;
-      DBL Dx = R.Dir[0], Dy = R.Dir[1], Dz = R.Dir[2],
-          Ox = R.Org[0], Oy = R.Org[1], Oz = R.Org[2];
-      INT count = 0;
-
-      DBL
-        a = A * Dx * Dx + 2 * B * Dx * Dy + 2 * C * Dx * Dz + E * Dy * Dy +
-            2 * F * Dy * Dz + H * Dz * Dz,
-        b = A * Ox * Dx + B * (Ox * Dy + Dx * Oy) + C * (Ox * Dz + Dx * Oz) +
-            D * Dx + E * Oy * Dy + F * (Oy * Dz + Dy * Oz) + G * Dy + H * Oz * Dz + I * Dz,
-        c = A * Ox * Ox + 2 * B * Ox * Oy + 2 * C * Ox * Oz + 2 * D * Ox + E * Oy * Oy +
-            2 * F * Oy * Oz + 2 * G * Oy + H * Oz * Oz + 2 * I * Oz + J,
-        d = b * b - a * c;
-
-      if (COM_ABS(a) < Treshold)
-        return 0;
-      if (d < Treshold)
-        return 0;
-      d = sqrt(d);
+      DBL t[2];
+      INT n = Roots(R, t);
 
-      DBL t1 = (-b + d) / a, t2 = (-b - d) / a;
-      if (a < 0)
-      {
-        DBL tmp;
-        COM_SWAP(t1, t2, tmp);
-      }
-      if (t2 > 0)
+      for (INT i = 0; i < n; i++)
       {
-        IList.push_back(intr(this, t2, TRUE)), count++;
-      }
-      if (t1 > 0)
-      {
-        IList.push_back(intr(this, t1, FALSE)), count++;
+        intr I(this, t[i], (Grad(R(t[i])) & R.Dir) < 0 ? ENTER : LEAVE);
+
+        I.P = R(t[i]);
+        I.IsPos = TRUE;
+        IList.Add(I);
       }
-      return count;
+      return n;
     } /* End of 'AllIntersect' function */
-
-    /* Normal get function.
-     * ARGUMENTS:
-     *   - intersection structure:
-     *       intr *Intr;
-     * RETURNS: None.
-     */
-    VOID GetNormal( intr *Intr )
-    {
-      if (!Intr->IsP || Intr->IsN)
-        return;
-      DBL X = Intr->P[0], Y = Intr->P[1], Z = Intr->P[2];
-      Intr->IsN = TRUE;
-      Intr->N = vec(2 * A * X + 2 * B * Y + 2 * C * Z + 2 * D,
-                    2 * B * X + 2 * C * Y + 2 * F * Z + 2 * G,
-                    2 * C * X + 2 * F * Y + 2 * H * Z + 2 * I);
-      Intr->N.Normalize();
-    } /* End of 'GetNormal' function */
   }; /* End of 'quadric' class */
 } /* end of 'ivrt' namespace */
 
-#endif /* __QUADRIC_H_ */
+#endif /* __quadric_h_ */
 
-/* END OF '' FILE */
+/* END OF 'quadric.h' FILE */
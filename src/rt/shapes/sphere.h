@@ -33,6 +33,7 @@ namespace ivrt
     sphere( vec3 C, DBL R, surface NS ) : Center(C), Radius(R), Radius2(R * R)
     {
       this->mtl = NS;
+      Box = aabb(C - (R + Threshold), C + (R + Threshold));
     }
     /* Find intersection on sphere function.
       * ARGUMENTS: 
@@ -87,6 +88,38 @@ namespace ivrt
       Intr->N = (Intr->P - Center).Normalizing();
     } /* End of 'GetNormal' function */
 
+    /* Get texture coordinates function.
+     * Sphere is mapped by longitude and latitude (poles along Y axis).
+     * ARGUMENTS:
+     *   - intersection with evaluated position:
+     *      const intr *Intr;
+     * RETURNS: (vec2) texture coordinates.
+     */
+    vec2 GetTexCoord( const intr *Intr ) override
+    {
+      vec3 d = (Intr->P - Center) * (1 / Radius);
+
+      return vec2(atan2(d[0], d[2]) / (2 * PI) + 0.5, acos(mth::Min(mth::Max(d[1], -1.0), 1.0)) / PI);
+    } /* End of 'GetTexCoord' function */
+
+    /* Get texture coordinates derivatives function.
+     * ARGUMENTS:
+     *   - intersection with evaluated position:
+     *      const intr *Intr;
+     *   - hit point derivatives along frame X and Y:
+     *      const vec3 &DPdx, &DPdy;
+     *   - texture coordinates derivatives (for output):
+     *      vec2 *DUVdx, *DUVdy;
+     * RETURNS: None.
+     */
+    VOID GetTexCoordDiff( const intr *Intr, const vec3 &DPdx, const vec3 &DPdy, vec2 *DUVdx, vec2 *DUVdy ) override
+    {
+      shape::GetTexCoordDiff(Intr, DPdx, DPdy, DUVdx, DUVdy);
+      /* Longitude differences across map seam are wrapped */
+      (*DUVdx)[0] -= floor((*DUVdx)[0] + 0.5);
+      (*DUVdy)[0] -= floor((*DUVdy)[0] + 0.5);
+    } /* End of 'GetTexCoordDiff' function */
+
     /* Check if ray intersects object function.
      * ARGUMENTS: 
      *   - input ray:
@@ -122,6 +155,37 @@ namespace ivrt
     {
       return (P.Distance2(Center) < Radius2);
     } /* End of 'IsInside' function */
+
+    /* Find all intersections function.
+     * ARGUMENTS:
+     *   - ray:
+     *       const ray &R;
+     *   - intersections list to be extended:
+     *       intr_list &IList;
+     * RETURNS: (INT) number of found intersections.
+     */
+    INT AllIntersect( const ray &R, intr_list &IList ) override
+    {
+      vec3 a = Center - R.Org;
+      DBL ok = a & R.Dir, h2 = Radius2 - ((a & a) - ok * ok), h, t[2];
+      INT n = 0;
+
+      if (h2 < 0)
+        return 0;
+      h = sqrt(h2);
+      t[0] = ok - h;
+      t[1] = ok + h;
+      for (INT i = 0; i < 2; i++)
+        if (t[i] > Threshold)
+        {
+          intr I(this, t[i], i == 0 ? ENTER : LEAVE);
+
+          I.P = R(t[i]);
+          I.IsPos = TRUE;
+          n += IList.Add(I);
+        }
+      return n;
+    } /* End of 'AllIntersect' function */
   }; /* End of 'sphere' class */
 } /* end of 'ivrt' namespace */
 
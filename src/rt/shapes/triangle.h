@@ -9,7 +9,7 @@
  *               Objects shapes module.
  * PROGRAMMER  : CGSG-SummerCamp'2021.
  *               Ivan Dmitiriev.
- * LAST UPDATE : 03.08.2021.
+ * LAST UPDATE : 08.08.2021.
  * NOTE        : Module namespace 'bort'.
  *
  * No part of this file may be changed without agreement of
@@ -24,37 +24,111 @@
 /* Project name space */
 namespace ivrt
 {
+  /* Watertight ray-triangle test setup class.
+   * Ray space is permuted and sheared so the ray direction becomes +Z
+   * (Woop, Benthin, Wald, 2013). Edge functions are then evaluated in 2D
+   * from vertex coordinates only, so a shared edge gives the same value
+   * for both adjacent triangles and rays never slip between them. */
+  class tri_ray
+  {
+  public:
+    vec3 Org;       // ray origin
+    INT Kx, Ky, Kz; // axes permutation (Kz - dominant direction axis)
+    DBL Sx, Sy, Sz; // shear coefficients
+
+    /* Class constructor.
+     * ARGUMENTS:
+     *   - ray:
+     *       const ray &R;
+     */
+    tri_ray( const ray &R ) : Org(R.Org)
+    {
+      DBL ax = fabs(R.Dir[0]), ay = fabs(R.Dir[1]), az = fabs(R.Dir[2]);
+      INT tmp;
+
+      Kz = ax > ay ? (ax > az ? 0 : 2) : (ay > az ? 1 : 2);
+      Kx = (Kz + 1) % 3;
+      Ky = (Kx + 1) % 3;
+      /* Keep triangles winding */
+      if (R.Dir[Kz] < 0)
+        COM_SWAP(Kx, Ky, tmp);
+      Sz = 1 / R.Dir[Kz];
+      Sx = R.Dir[Kx] * Sz;
+      Sy = R.Dir[Ky] * Sz;
+    } /* End of 'tri_ray' function */
+
+    /* Evaluate edge function function.
+     * Edge is evaluated in canonical vertices order, so both triangles
+     * sharing it get exactly opposite values even if compiler fuses
+     * products into FMA (fused expression is not antisymmetric).
+     * ARGUMENTS:
+     *   - edge vertices in ray space:
+     *       DBL Px, Py, Qx, Qy;
+     * RETURNS: (DBL) edge function value.
+     */
+    static DBL Edge( DBL Px, DBL Py, DBL Qx, DBL Qy )
+    {
+      if (Px > Qx || (Px == Qx && Py > Qy))
+        return -(Qx * Py - Qy * Px);
+      return Px * Qy - Py * Qx;
+    } /* End of 'Edge' function */
+
+    /* Intersect triangle function.
+     * ARGUMENTS:
+     *   - triangle vertices:
+     *       const vec3 &P0, &P1, &P2;
+     *   - maximal ray distance:
+     *       DBL TMax;
+     *   - result distance and barycentric coordinates of P1 and P2:
+     *       DBL *T, *U, *V;
+     * RETURNS: (BOOL) TRUE if intersected, FALSE otherwise.
+     */
+    BOOL Intersect( const vec3 &P0, const vec3 &P1, const vec3 &P2, DBL TMax, DBL *T, DBL *U, DBL *V ) const
+    {
+      vec3 A = P0 - Org, B = P1 - Org, C = P2 - Org;
+      DBL
+        ax = A[Kx] - Sx * A[Kz], ay = A[Ky] - Sy * A[Kz],
+        bx = B[Kx] - Sx * B[Kz], by = B[Ky] - Sy * B[Kz],
+        cx = C[Kx] - Sx * C[Kz], cy = C[Ky] - Sy * C[Kz],
+        e0 = Edge(cx, cy, bx, by),
+        e1 = Edge(ax, ay, cx, cy),
+        e2 = Edge(bx, by, ax, ay),
+        det, t;
+
+      /* Edges inclusive on both sides: all functions of one sign (or zero) */
+      if ((e0 < 0 || e1 < 0 || e2 < 0) && (e0 > 0 || e1 > 0 || e2 > 0))
+        return FALSE;
+      /* Ray in triangle plane or degenerate triangle */
+      if ((det = e0 + e1 + e2) == 0)
+        return FALSE;
+      t = (e0 * A[Kz] + e1 * B[Kz] + e2 * C[Kz]) * Sz / det;
+      if (t <= Threshold || t >= TMax)
+        return FALSE;
+      *T = t;
+      *U = e1 / det;
+      *V = e2 / det;
+      return TRUE;
+    } /* End of 'Intersect' function */
+  }; /* End of 'tri_ray' class */
+
   /* Triangle intersection class */
   class triangle : public shape
   {
   public:
-    vec3 N;      // Plane normal
-    DBL D;       // Plane coefficient
-    vec3 U1, V1; // triangle
-    DBL u0, v0;  // Triangle coefficients
-
+    vec3 P0, P1, P2; // Vertices
+    vec3 N;          // Plane normal
 
     /* Class constructor */
-    triangle( VOID ) : N(0, 1, 0), D(1), U1(0), V1(0), u0(0), v0(0)
+    triangle( VOID ) : P0(0), P1(1, 0, 0), P2(0, 0, 1), N(0, 1, 0)
     {
+      Box = aabb().Grow(P0).Grow(P1).Grow(P2);
     } /* End of 'triangle' function */
 
     /* Class constructor */
-    triangle( vec3 P0, vec3 P1, vec3 P2 )
+    triangle( const vec3 &NP0, const vec3 &NP1, const vec3 &NP2 ) :
+      P0(NP0), P1(NP1), P2(NP2), N(((NP1 - NP0) % (NP2 - NP0)).Normalizing())
     {
-      N = ((P1 - P0) % (P2 - P0)).Normalizing();
-      vec3 M0 = P0, P;
-      D = N[0] * M0[0] + N[1] * M0[1] + N[2] * M0[2];
-      P = vec3(D / N[0], D / N[1], D / N[2]);
-
-      vec3 r = P - P0, s1 = P1 - P0, s2 = P2 - P0;
-      DBL s12 = s1 & s1, s22 = s2 & s2;
-
-      U1 = ((s1 * s22) - (s2 * (s1 & s2))) / ((s12 * s22) - (s1 & s2) * (s1 & s2));
-      u0 = P0 & U1; 
-
-      V1 = ((s2 * s12) - (s1 * (s1 & s2))) / ((s12 * s22) - (s1 & s2) * (s1 & s2));
-      v0 = P0 & V1; 
+      Box = aabb().Grow(P0).Grow(P1).Grow(P2);
     } /* End of 'triangle' function */
 
     /* Is intersection exist function.
@@ -65,18 +139,9 @@ namespace ivrt
      */
     BOOL IsIntersected( const ray &R ) override
     {
-      DBL t = (D - (N & R.Org)) / (N & R.Dir);
-
-      if (t < Threshold)
-        return FALSE;
+      DBL t, u, v;
 
-      vec3 P = R(t);
-      
-      DBL u = (P & U1) - u0;
-      DBL v = (P & V1) - v0;
-      if (u >= Threshold && u <= 1 && v >= Threshold && v <= 1 && (u + v) <= 1)
-        return TRUE;
-      return FALSE;
+      return tri_ray(R).Intersect(P0, P1, P2, HUGE_VAL, &t, &u, &v);
     } // End of 'IsIntersected' function
 
     /* Find intersection between ray and plane function.
@@ -90,23 +155,18 @@ namespace ivrt
      */
     BOOL Intersection( const ray &R, intr *Intr ) override
     {
-      DBL Treshold = 0.00001; 
-      Intr->Shp = this;
+      DBL t, u, v;
 
-      Intr->T = (D - (N & R.Org)) / (N & R.Dir);
-      if (Intr->T < Treshold)
+      if (!tri_ray(R).Intersect(P0, P1, P2, HUGE_VAL, &t, &u, &v))
         return FALSE;
-
-      vec3 P = R(Intr->T);
-      
-      DBL u = (P & U1) - u0;
-      DBL v = (P & V1) - v0;
-      if (u >= Treshold && v >= Treshold && (u + v) <= 1)
-      {
-        Intr->Shp = this;
-        return TRUE;
-      }
-      return FALSE;
+      Intr->Shp = this;
+      Intr->T = t;
+      /* Barycentric coordinates of P1 and P2 */
+      Intr->D[0] = u;
+      Intr->D[1] = v;
+      for (INT i = 0; i < 5; i++)
+        Intr->add[i] = 0;
+      return TRUE;
     } /* End of 'Intersection' function */
 
     /* Get noramal function.
@@ -119,6 +179,42 @@ namespace ivrt
     {
       I->N = N;
     } /* End of 'GetNormal' function */
+
+    /* Get texture coordinates function.
+     * ARGUMENTS:
+     *   - intersection:
+     *       const intr *I;
+     * RETURNS: (vec2) barycentric coordinates of P1 and P2.
+     */
+    vec2 GetTexCoord( const intr *I ) override
+    {
+      return vec2(I->D[0], I->D[1]);
+    } /* End of 'GetTexCoord' function */
+
+    /* Get texture coordinates derivatives function.
+     * Barycentric coordinates are linear on triangle plane.
+     * ARGUMENTS:
+     *   - intersection:
+     *       const intr *I;
+     *   - hit point derivatives along frame X and Y:
+     *       const vec3 &DPdx, &DPdy;
+     *   - texture coordinates derivatives (for output):
+     *       vec2 *DUVdx, *DUVdy;
+     * RETURNS: None.
+     */
+    VOID GetTexCoordDiff( const intr *I, const vec3 &DPdx, const vec3 &DPdy, vec2 *DUVdx, vec2 *DUVdy ) override
+    {
+      vec3 e1 = P1 - P0, e2 = P2 - P0;
+      DBL a = (e1 % e2) & N;
+
+      if (a == 0)
+      {
+        *DUVdx = *DUVdy = vec2(0);
+        return;
+      }
+      *DUVdx = vec2(((DPdx % e2) & N) / a, ((e1 % DPdx) & N) / a);
+      *DUVdy = vec2(((DPdy % e2) & N) / a, ((e1 % DPdy) & N) / a);
+    } /* End of 'GetTexCoordDiff' function */
   }; /* End of 'triangle' class */
 } /* End of 'ivrt' namespace */
 
@@ -0,0 +1,156 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : triangle8.h
+ * PURPOSE     : Ray tracing project.
+ *               Ray tracing module.
+ *               Eight triangles packet module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitiriev.
+ * LAST UPDATE : 08.08.2021.
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __triangle8_h_
+#define __triangle8_h_
+
+#include <limits>
+
+#include "triangle.h"
+
+/* Project name space */
+namespace ivrt
+{
+  /* Eight triangles packet class (BVH leaf kernel).
+   * Vertices are stored as structure of float lanes and all triangles are
+   * tested against one ray at once with the same watertight kernel as
+   * 'tri_ray::Intersect', without per-triangle branches. Lanes whose edge
+   * function is within float rounding of zero are recomputed in double
+   * (products of floats are exact there), so adjacent triangles always
+   * agree on shared edges, even if multiply-subtract is fused. Unused lanes hold
+   * NaN vertices: every comparison on them fails, so they never give a hit
+   * (zero triangles may, once multiply-subtract is fused). */
+  class triangle8
+  {
+  private:
+    mth::vec3x8 P0, P1, P2; // vertices lanes
+
+    /* Get coordinate lanes by axis function.
+     * ARGUMENTS:
+     *   - vectors batch:
+     *       const mth::vec3x8 &V;
+     *   - axis index:
+     *       INT K;
+     * RETURNS: (const mth::flt8 &) coordinate lanes.
+     */
+    static const mth::flt8 & Axis( const mth::vec3x8 &V, INT K )
+    {
+      return K == 0 ? V.X : K == 1 ? V.Y : V.Z;
+    } /* End of 'Axis' function */
+
+    /* Get lane vertex in double precision function.
+     * ARGUMENTS:
+     *   - vertices lanes:
+     *       const mth::vec3x8 &P;
+     *   - lane index:
+     *       INT I;
+     * RETURNS: (vec3) vertex.
+     */
+    static vec3 Lane( const mth::vec3x8 &P, INT I )
+    {
+      return vec3(P.X[I], P.Y[I], P.Z[I]);
+    } /* End of 'Lane' function */
+
+  public:
+    INT Count; // number of triangles in packet
+
+    /* Class constructor.
+     * ARGUMENTS:
+     *   - triangles (up to 8):
+     *       const triangle * const *Tris;
+     *   - number of triangles:
+     *       INT N;
+     */
+    triangle8( const triangle * const *Tris, INT N ) : Count(mth::Min(N, 8))
+    {
+      FLT v[9][8];
+
+      for (INT k = 0; k < 9; k++)
+        for (INT i = Count; i < 8; i++)
+          v[k][i] = std::numeric_limits<FLT>::quiet_NaN();
+      for (INT i = 0; i < Count; i++)
+        for (INT k = 0; k < 3; k++)
+        {
+          v[k][i] = (FLT)Tris[i]->P0[k];
+          v[3 + k][i] = (FLT)Tris[i]->P1[k];
+          v[6 + k][i] = (FLT)Tris[i]->P2[k];
+        }
+      P0 = mth::vec3x8(mth::flt8::Load(v[0]), mth::flt8::Load(v[1]), mth::flt8::Load(v[2]));
+      P1 = mth::vec3x8(mth::flt8::Load(v[3]), mth::flt8::Load(v[4]), mth::flt8::Load(v[5]));
+      P2 = mth::vec3x8(mth::flt8::Load(v[6]), mth::flt8::Load(v[7]), mth::flt8::Load(v[8]));
+    } /* End of 'triangle8' function */
+
+    /* Find closest intersection in packet function.
+     * ARGUMENTS:
+     *   - prepared ray:
+     *       const tri_ray &R;
+     *   - maximal ray distance:
+     *       DBL TMax;
+     *   - result distance and barycentric coordinates of P1 and P2:
+     *       DBL *T, *U, *V;
+     * RETURNS: (INT) intersected triangle index or -1 if none.
+     */
+    INT Intersect( const tri_ray &R, DBL TMax, DBL *T, DBL *U, DBL *V ) const
+    {
+      mth::vec3x8 O(mth::vec3<FLT>((FLT)R.Org[0], (FLT)R.Org[1], (FLT)R.Org[2]));
+      mth::vec3x8 A = P0 - O, B = P1 - O, C = P2 - O;
+      mth::flt8
+        zero(0), sx((FLT)R.Sx), sy((FLT)R.Sy), sz((FLT)R.Sz),
+        az = Axis(A, R.Kz), bz = Axis(B, R.Kz), cz = Axis(C, R.Kz),
+        ax = Axis(A, R.Kx) - sx * az, ay = Axis(A, R.Ky) - sy * az,
+        bx = Axis(B, R.Kx) - sx * bz, by = Axis(B, R.Ky) - sy * bz,
+        cx = Axis(C, R.Kx) - sx * cz, cy = Axis(C, R.Ky) - sy * cz,
+        e0 = cx * by - cy * bx,
+        e1 = ax * cy - ay * cx,
+        e2 = bx * ay - by * ax,
+        eps((FLT)1.0 / (1 << 20)),
+        near =
+          (e0.Abs() <= eps * ((cx * by).Abs() + (cy * bx).Abs())) |
+          (e1.Abs() <= eps * ((ax * cy).Abs() + (ay * cx).Abs())) |
+          (e2.Abs() <= eps * ((bx * ay).Abs() + (by * ax).Abs())),
+        det = e0 + e1 + e2,
+        t = (e0 * az + e1 * bz + e2 * cz) * sz,
+        neg = det < zero,
+        adet = mth::flt8::Select(neg, zero - det, det),
+        at = mth::flt8::Select(neg, zero - t, t),
+        inside = (e0.Min(e1).Min(e2) >= zero) | (e0.Max(e1).Max(e2) <= zero),
+        hit = inside & (adet > zero) &
+              (at > adet * mth::flt8((FLT)Threshold)) & (at < adet * mth::flt8((FLT)TMax));
+      INT nmask = near.MoveMask(), mask = hit.MoveMask() & ~nmask, best = -1;
+      DBL tbest = TMax, t0, u0, v0;
+
+      for (INT i = 0; mask != 0; i++, mask >>= 1)
+        if ((mask & 1) && at[i] / adet[i] < tbest)
+        {
+          tbest = at[i] / adet[i], best = i;
+          *U = e1[i] / det[i];
+          *V = e2[i] / det[i];
+        }
+      for (INT i = 0; nmask != 0; i++, nmask >>= 1)
+        if ((nmask & 1) && R.Intersect(Lane(P0, i), Lane(P1, i), Lane(P2, i), tbest, &t0, &u0, &v0))
+          tbest = t0, best = i, *U = u0, *V = v0;
+      if (best != -1)
+        *T = tbest;
+      return best;
+    } /* End of 'Intersect' function */
+  }; /* End of 'triangle8' class */
+} /* End of 'ivrt' namespace */
+
+#endif /* __triangle8_h_ */
+
+/* END OF 'triangle8.h' FILE */
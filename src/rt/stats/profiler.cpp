@@ -0,0 +1,54 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : profiler.cpp
+ * PURPOSE     : Raytracing project.
+ *               Render phases timeline implementation module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#include <cstdio>
+
+#include "profiler.h"
+
+/* Write Chrome trace JSON file function.
+ * ARGUMENTS:
+ *   - file name:
+ *       const CHAR *FileName;
+ * RETURNS: (BOOL) TRUE if success, FALSE otherwise.
+ */
+BOOL ivrt::profiler::Write( const CHAR *FileName )
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+  const CHAR *Sep = "";
+  FILE *F;
+
+  if ((F = fopen(FileName, "w")) == nullptr)
+    return FALSE;
+  fprintf(F, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+  for (INT i = 0; i < NumOfThreads; i++, Sep = ",")
+    fprintf(F, "%s\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"thread %d\"}}",
+            Sep, i, i);
+  for (INT i = 0; i < NumOfWorkers; i++, Sep = ",")
+    fprintf(F, "%s\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"worker %d\"}}",
+            Sep, WorkerBase + i, i);
+  for (auto &E : Events)
+  {
+    fprintf(F, "%s\n  {\"name\": \"%s\", \"cat\": \"render\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+            Sep, E.Name, E.Thread, E.Start, E.Dur);
+    Sep = ",";
+  }
+  fprintf(F, "\n]}\n");
+  fclose(F);
+  return TRUE;
+} /* End of 'ivrt::profiler::Write' function */
+
+/* END OF 'profiler.cpp' FILE */
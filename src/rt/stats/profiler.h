@@ -0,0 +1,179 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : profiler.h
+ * PURPOSE     : Raytracing project.
+ *               Render phases timeline declaration module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __profiler_h_
+#define __profiler_h_
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "../../def.h"
+
+/* Scoped timeline marker (name must be string literal) */
+#define IVRT_PROFILE_CONCAT2(A, B) A##B
+#define IVRT_PROFILE_CONCAT(A, B) IVRT_PROFILE_CONCAT2(A, B)
+#define IVRT_PROFILE(Name) ivrt::profile_scope IVRT_PROFILE_CONCAT(ProfileScope, __LINE__)(Name)
+
+/* Project namespace */
+namespace ivrt
+{
+  /* Render phases timeline class.
+   * Collects complete events of coarse phases (scene and hierarchy build,
+   * tiles, file output) and writes them as Chrome trace JSON, which opens
+   * in chrome://tracing and Perfetto UI. Recording is off until enabled.
+   * Render workers are new threads every frame, so they set own worker
+   * number and keep the same timeline row across frames. */
+  class profiler
+  {
+  private:
+    /* Timeline event */
+    struct event
+    {
+      const CHAR *Name; // phase name (static string)
+      INT Thread;       // thread number
+      DBL Start, Dur;   // start time and duration in microseconds
+    }; /* End of 'event' structure */
+
+    std::mutex Mutex;                                // events lock
+    std::vector<event> Events;                       // recorded events
+    std::chrono::steady_clock::time_point Origin =
+      std::chrono::steady_clock::now();              // timeline start
+    std::atomic<INT> NumOfThreads {0};               // numbered (not worker) threads
+    std::atomic<INT> NumOfWorkers {0};               // maximal worker number plus one
+
+    /* Get current thread number storage function.
+     * ARGUMENTS: None.
+     * RETURNS: (INT &) thread number (-1 if not assigned yet).
+     */
+    static INT & ThreadId( VOID )
+    {
+      static thread_local INT Id = -1;
+
+      return Id;
+    } /* End of 'ThreadId' function */
+
+  public:
+    static const INT MaxEvents = 1 << 20; // events over this number are dropped
+    static const INT WorkerBase = 1000;   // first worker thread number
+    BOOL IsEnabled = FALSE;               // recording flag
+
+    /* Get process profiler function.
+     * ARGUMENTS: None.
+     * RETURNS: (profiler &) profiler.
+     */
+    static profiler & Get( VOID )
+    {
+      static profiler Profiler;
+
+      return Profiler;
+    } /* End of 'Get' function */
+
+    /* Get time from timeline start function.
+     * ARGUMENTS: None.
+     * RETURNS: (DBL) time in microseconds.
+     */
+    DBL Now( VOID ) const
+    {
+      return std::chrono::duration<DBL, std::micro>(std::chrono::steady_clock::now() - Origin).count();
+    } /* End of 'Now' function */
+
+    /* Get current thread number function.
+     * ARGUMENTS: None.
+     * RETURNS: (INT) worker or small thread number (in order of first event).
+     */
+    INT Thread( VOID )
+    {
+      INT &Id = ThreadId();
+
+      if (Id == -1)
+        Id = NumOfThreads++;
+      return Id;
+    } /* End of 'Thread' function */
+
+    /* Mark current thread as render worker function.
+     * ARGUMENTS:
+     *   - worker number (same for every frame):
+     *       INT Num;
+     * RETURNS: None.
+     */
+    VOID SetWorker( INT Num )
+    {
+      INT n = NumOfWorkers;
+
+      ThreadId() = WorkerBase + Num;
+      while (n <= Num && !NumOfWorkers.compare_exchange_weak(n, Num + 1))
+        ;
+    } /* End of 'SetWorker' function */
+
+    /* Record complete event function.
+     * ARGUMENTS:
+     *   - phase name (static string):
+     *       const CHAR *Name;
+     *   - start time and duration in microseconds:
+     *       DBL Start, Dur;
+     * RETURNS: None.
+     */
+    VOID Add( const CHAR *Name, DBL Start, DBL Dur )
+    {
+      INT tid = Thread();
+      std::lock_guard<std::mutex> Lock(Mutex);
+
+      if (Events.size() < MaxEvents)
+        Events.push_back({Name, tid, Start, Dur});
+    } /* End of 'Add' function */
+
+    /* Write Chrome trace JSON file function.
+     * ARGUMENTS:
+     *   - file name:
+     *       const CHAR *FileName;
+     * RETURNS: (BOOL) TRUE if success, FALSE otherwise.
+     */
+    BOOL Write( const CHAR *FileName );
+  }; /* End of 'profiler' class */
+
+  /* Scoped timeline marker class */
+  class profile_scope
+  {
+  private:
+    const CHAR *Name; // phase name
+    DBL Start;        // start time (negative if recording is off)
+
+  public:
+    /* Class constructor.
+     * ARGUMENTS:
+     *   - phase name (static string):
+     *       const CHAR *NewName;
+     */
+    profile_scope( const CHAR *NewName ) :
+      Name(NewName), Start(profiler::Get().IsEnabled ? profiler::Get().Now() : -1)
+    {
+    } /* End of 'profile_scope' function */
+
+    /* Class destructor */
+    ~profile_scope( VOID )
+    {
+      if (Start >= 0)
+        profiler::Get().Add(Name, Start, profiler::Get().Now() - Start);
+    } /* End of '~profile_scope' function */
+  }; /* End of 'profile_scope' class */
+} /* end of 'ivrt' namespace */
+
+#endif /* __profiler_h_ */
+
+/* END OF 'profiler.h' FILE */
@@ -0,0 +1,157 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : stats.cpp
+ * PURPOSE     : Raytracing project.
+ *               Ray statistics implementation module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#include <cstdio>
+
+#include "stats.h"
+#include "../frame/frame.h"
+
+/* Start new frame function.
+ * ARGUMENTS:
+ *   - frame size in pixels:
+ *       INT NewW, NewH;
+ * RETURNS: None.
+ */
+VOID ivrt::stats::Start( INT NewW, INT NewH )
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+
+  Total = ray_counters();
+  Tiles.clear();
+  W = NewW;
+  H = NewH;
+  Heat.assign(W * H, 0);
+  Frame++;
+} /* End of 'ivrt::stats::Start' function */
+
+/* Merge current thread counters to frame function.
+ * ARGUMENTS:
+ *   - thread index:
+ *       INT Thread;
+ *   - rendered pixels rectangle:
+ *       INT X0, Y0, X1, Y1;
+ *   - render time in seconds:
+ *       DBL Time;
+ * RETURNS: None.
+ */
+VOID ivrt::stats::Merge( INT Thread, INT X0, INT Y0, INT X1, INT Y1, DBL Time )
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+
+  Total += Local();
+  Local() = ray_counters();
+  Tiles.push_back({Thread, X0, Y0, X1, Y1, Time});
+} /* End of 'ivrt::stats::Merge' function */
+
+/* Write frame report in JSON format function.
+ * ARGUMENTS:
+ *   - file name:
+ *       const CHAR *FileName;
+ * RETURNS: (BOOL) TRUE if success, FALSE otherwise.
+ */
+BOOL ivrt::stats::WriteJSON( const CHAR *FileName )
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+  FILE *F;
+  UINT64 HeatMax = 0, HeatSum = 0;
+
+  if ((F = fopen(FileName, "w")) == nullptr)
+    return FALSE;
+  for (UINT h : Heat)
+    HeatMax = mth::Max(HeatMax, (UINT64)h), HeatSum += h;
+  fprintf(F, "{\n  \"frame\": %d,\n  \"counters\": {\n", Frame);
+  fprintf(F, "    \"rays\": %llu,\n    \"primary_rays\": %llu,\n    \"shadow_rays\": %llu,\n"
+             "    \"secondary_rays\": %llu,\n    \"node_visits\": %llu,\n    \"shape_tests\": %llu,\n"
+             "    \"shade_calls\": %llu,\n    \"trace_calls\": %llu,\n    \"bounces\": %llu\n  },\n",
+          (unsigned long long)Total.Rays, (unsigned long long)Total.PrimaryRays, (unsigned long long)Total.ShadowRays,
+          (unsigned long long)(Total.Rays - Total.PrimaryRays - Total.ShadowRays),
+          (unsigned long long)Total.NodeVisits, (unsigned long long)Total.ShapeTests,
+          (unsigned long long)Total.ShadeCalls, (unsigned long long)Total.TraceCalls, (unsigned long long)Total.Bounces);
+  fprintf(F, "  \"heatmap\": {\"width\": %d, \"height\": %d, \"max\": %llu, \"mean\": %g},\n",
+          W, H, (unsigned long long)HeatMax, Heat.empty() ? 0.0 : (DBL)HeatSum / Heat.size());
+  fprintf(F, "  \"tiles\": [");
+  for (size_t i = 0; i < Tiles.size(); i++)
+    fprintf(F, "%s\n    {\"thread\": %d, \"x0\": %d, \"y0\": %d, \"x1\": %d, \"y1\": %d, \"seconds\": %g}",
+            i == 0 ? "" : ",", Tiles[i].Thread, Tiles[i].X0, Tiles[i].Y0, Tiles[i].X1, Tiles[i].Y1, Tiles[i].Time);
+  fprintf(F, "\n  ]\n}\n");
+  fclose(F);
+  return TRUE;
+} /* End of 'ivrt::stats::WriteJSON' function */
+
+/* Append frame counters line to CSV file function.
+ * ARGUMENTS:
+ *   - file name (header is written to new file):
+ *       const CHAR *FileName;
+ * RETURNS: (BOOL) TRUE if success, FALSE otherwise.
+ */
+BOOL ivrt::stats::WriteCSV( const CHAR *FileName )
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+  FILE *F;
+  BOOL IsNew;
+  DBL MaxTime = 0;
+
+  if ((F = fopen(FileName, "r")) != nullptr)
+    fclose(F);
+  IsNew = F == nullptr;
+  if ((F = fopen(FileName, "a")) == nullptr)
+    return FALSE;
+  for (auto &T : Tiles)
+    MaxTime = mth::Max(MaxTime, T.Time);
+  if (IsNew)
+    fprintf(F, "frame,rays,primary_rays,shadow_rays,secondary_rays,node_visits,shape_tests,"
+               "shade_calls,trace_calls,bounces,slowest_tile_seconds\n");
+  fprintf(F, "%d,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%g\n", Frame,
+          (unsigned long long)Total.Rays, (unsigned long long)Total.PrimaryRays, (unsigned long long)Total.ShadowRays,
+          (unsigned long long)(Total.Rays - Total.PrimaryRays - Total.ShadowRays),
+          (unsigned long long)Total.NodeVisits, (unsigned long long)Total.ShapeTests,
+          (unsigned long long)Total.ShadeCalls, (unsigned long long)Total.TraceCalls, (unsigned long long)Total.Bounces,
+          MaxTime);
+  fclose(F);
+  return TRUE;
+} /* End of 'ivrt::stats::WriteCSV' function */
+
+/* Write traversal cost heatmap image function.
+ * Cost is scaled by square root of its maximum and colored from blue
+ * (cheap) through green to red (expensive).
+ * ARGUMENTS:
+ *   - TGA file name:
+ *       const CHAR *FileName;
+ * RETURNS: (BOOL) TRUE if success, FALSE otherwise.
+ */
+BOOL ivrt::stats::WriteHeatmap( const CHAR *FileName )
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+  frame Img;
+  UINT HeatMax = 1;
+
+  if (W <= 0 || H <= 0)
+    return FALSE;
+  for (UINT h : Heat)
+    HeatMax = mth::Max(HeatMax, h);
+  Img.Resize(W, H);
+  for (INT y = 0; y < H; y++)
+    for (INT x = 0; x < W; x++)
+    {
+      DBL t = sqrt((DBL)Heat[y * W + x] / HeatMax);
+
+      Img.PutPixel(x, y, frame::ToRGB(vec3(t, 1 - fabs(2 * t - 1), 1 - t)));
+    }
+  return Img.SaveTGA(FileName);
+} /* End of 'ivrt::stats::WriteHeatmap' function */
+
+/* END OF 'stats.cpp' FILE */
@@ -0,0 +1,184 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : stats.h
+ * PURPOSE     : Raytracing project.
+ *               Ray statistics declaration module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __stats_h_
+#define __stats_h_
+
+#include <mutex>
+#include <vector>
+
+#include "../../def.h"
+
+/* Counters are compiled in only if 'IVRT_STATS' is defined (Debug configurations) */
+#ifdef IVRT_STATS
+#  define IVRT_STAT(Field) (++ivrt::stats::Local().Field)
+#  define IVRT_STAT_ADD(Field, N) (ivrt::stats::Local().Field += (N))
+#  define IVRT_STATS_ONLY(...) __VA_ARGS__
+#else
+#  define IVRT_STAT(Field) ((VOID)0)
+#  define IVRT_STAT_ADD(Field, N) ((VOID)0)
+#  define IVRT_STATS_ONLY(...)
+#endif /* IVRT_STATS */
+
+/* Project namespace */
+namespace ivrt
+{
+  /* Ray tracing counters of one thread (or merged frame) */
+  struct ray_counters
+  {
+    UINT64
+      Rays = 0,        // scene intersection queries (all kinds)
+      PrimaryRays = 0, // camera rays
+      ShadowRays = 0,  // light occlusion rays
+      NodeVisits = 0,  // hierarchy nodes visited
+      ShapeTests = 0,  // ray-shape intersection tests
+      ShadeCalls = 0,  // shaded hits
+      TraceCalls = 0,  // ray trees traced
+      Bounces = 0;     // ray tree nodes (traced tasks)
+
+    /* Add counters function.
+     * ARGUMENTS:
+     *   - counters to be added:
+     *       const ray_counters &C;
+     * RETURNS: (ray_counters &) self reference.
+     */
+    ray_counters & operator+=( const ray_counters &C )
+    {
+      Rays += C.Rays, PrimaryRays += C.PrimaryRays, ShadowRays += C.ShadowRays;
+      NodeVisits += C.NodeVisits, ShapeTests += C.ShapeTests;
+      ShadeCalls += C.ShadeCalls, TraceCalls += C.TraceCalls, Bounces += C.Bounces;
+      return *this;
+    } /* End of 'operator+=' function */
+
+    /* Obtain traversal cost function.
+     * ARGUMENTS: None.
+     * RETURNS: (UINT64) visited nodes and tested shapes number.
+     */
+    UINT64 Cost( VOID ) const
+    {
+      return NodeVisits + ShapeTests;
+    } /* End of 'Cost' function */
+  }; /* End of 'ray_counters' structure */
+
+  /* Frame ray statistics class.
+   * Hot paths bump counters of their thread only ('Local'), rendering
+   * threads merge them once when their part of frame is done, so there is
+   * no sharing between threads while tracing. */
+  class stats
+  {
+  private:
+    /* Rendered frame part timing */
+    struct tile_time
+    {
+      INT Thread;             // rendering thread index
+      INT X0, Y0, X1, Y1;     // pixels rectangle
+      DBL Time;               // render time in seconds
+    }; /* End of 'tile_time' structure */
+
+    std::mutex Mutex;             // merge lock
+    ray_counters Total;           // merged frame counters
+    std::vector<tile_time> Tiles; // frame parts timings
+    std::vector<UINT> Heat;       // per pixel traversal cost
+    INT W = 0, H = 0;             // heatmap size
+    INT Frame = 0;                // frame number
+
+  public:
+    /* Get process statistics function.
+     * ARGUMENTS: None.
+     * RETURNS: (stats &) statistics.
+     */
+    static stats & Get( VOID )
+    {
+      static stats Stats;
+
+      return Stats;
+    } /* End of 'Get' function */
+
+    /* Get current thread counters function.
+     * ARGUMENTS: None.
+     * RETURNS: (ray_counters &) thread counters.
+     */
+    static ray_counters & Local( VOID )
+    {
+      static thread_local ray_counters Counters;
+
+      return Counters;
+    } /* End of 'Local' function */
+
+    /* Start new frame function.
+     * ARGUMENTS:
+     *   - frame size in pixels:
+     *       INT NewW, NewH;
+     * RETURNS: None.
+     */
+    VOID Start( INT NewW, INT NewH );
+
+    /* Merge current thread counters to frame function.
+     * ARGUMENTS:
+     *   - thread index:
+     *       INT Thread;
+     *   - rendered pixels rectangle:
+     *       INT X0, Y0, X1, Y1;
+     *   - render time in seconds:
+     *       DBL Time;
+     * RETURNS: None.
+     */
+    VOID Merge( INT Thread, INT X0, INT Y0, INT X1, INT Y1, DBL Time );
+
+    /* Store pixel traversal cost function.
+     * ARGUMENTS:
+     *   - pixel coordinates:
+     *       INT X, Y;
+     *   - cost (visited nodes and tested shapes):
+     *       UINT64 Cost;
+     * RETURNS: None.
+     */
+    VOID PutCost( INT X, INT Y, UINT64 Cost )
+    {
+      if (X >= 0 && Y >= 0 && X < W && Y < H)
+        Heat[Y * W + X] = (UINT)mth::Min(Cost, (UINT64)0xFFFFFFFF);
+    } /* End of 'PutCost' function */
+
+    /* Write frame report in JSON format function.
+     * ARGUMENTS:
+     *   - file name:
+     *       const CHAR *FileName;
+     * RETURNS: (BOOL) TRUE if success, FALSE otherwise.
+     */
+    BOOL WriteJSON( const CHAR *FileName );
+
+    /* Append frame counters line to CSV file function.
+     * ARGUMENTS:
+     *   - file name (header is written to new file):
+     *       const CHAR *FileName;
+     * RETURNS: (BOOL) TRUE if success, FALSE otherwise.
+     */
+    BOOL WriteCSV( const CHAR *FileName );
+
+    /* Write traversal cost heatmap image function.
+     * ARGUMENTS:
+     *   - TGA file name:
+     *       const CHAR *FileName;
+     * RETURNS: (BOOL) TRUE if success, FALSE otherwise.
+     */
+    BOOL WriteHeatmap( const CHAR *FileName );
+  }; /* End of 'stats' class */
+} /* end of 'ivrt' namespace */
+
+#endif /* __stats_h_ */
+
+/* END OF 'stats.h' FILE */
@@ -0,0 +1,380 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : procedural.cpp
+ * PURPOSE     : Raytracing project.
+ *               Procedural textures node graphs implementation module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#include "procedural.h"
+
+/* Noise lattice permutation table class.
+ * Table is doubled, so hashes of neighbour cells never wrap. */
+class noise_perm
+{
+public:
+  INT P[512]; // permutation of 0..255 twice
+
+  /* Class constructor */
+  noise_perm( VOID )
+  {
+    UINT seed = 0x2021;
+
+    for (INT i = 0; i < 256; i++)
+      P[i] = i;
+    for (INT i = 255; i > 0; i--)
+    {
+      seed = seed * 1664525 + 1013904223;
+
+      INT j = (INT)((seed >> 8) % (UINT)(i + 1)), t = P[i];
+
+      P[i] = P[j], P[j] = t;
+    }
+    for (INT i = 0; i < 256; i++)
+      P[256 + i] = P[i];
+  } /* End of 'noise_perm' function */
+}; /* End of 'noise_perm' class */
+
+/* Noise lattice permutation table */
+static const noise_perm NoisePerm;
+
+/* Noise lattice gradients (cube edges middles, 4 repeated to make 16) */
+static const FLT NoiseGrad[16][3] =
+{
+  {1, 1, 0}, {-1, 1, 0}, {1, -1, 0}, {-1, -1, 0},
+  {1, 0, 1}, {-1, 0, 1}, {1, 0, -1}, {-1, 0, -1},
+  {0, 1, 1}, {0, -1, 1}, {0, 1, -1}, {0, -1, -1},
+  {1, 1, 0}, {0, -1, 1}, {-1, 1, 0}, {0, -1, -1}
+};
+
+/* Linear interpolation of eight values function.
+ * ARGUMENTS:
+ *   - values to interpolate between:
+ *       const mth::flt8 &A, &B;
+ *   - interpolation factors:
+ *       const mth::flt8 &T;
+ * RETURNS: (mth::flt8) interpolated values.
+ */
+static mth::flt8 Lerp8( const mth::flt8 &A, const mth::flt8 &B, const mth::flt8 &T )
+{
+  return A + (B - A) * T;
+} /* End of 'Lerp8' function */
+
+/* Clamp eight values to [0, 1] range function.
+ * ARGUMENTS:
+ *   - values:
+ *       const mth::flt8 &A;
+ * RETURNS: (mth::flt8) clamped values.
+ */
+static mth::flt8 Saturate8( const mth::flt8 &A )
+{
+  return A.Max(mth::flt8(0)).Min(mth::flt8(1));
+} /* End of 'Saturate8' function */
+
+/* Perlin noise fade curve of eight values function.
+ * ARGUMENTS:
+ *   - in cell coordinates:
+ *       const mth::flt8 &T;
+ * RETURNS: (mth::flt8) 6t^5 - 15t^4 + 10t^3 values.
+ */
+static mth::flt8 Fade8( const mth::flt8 &T )
+{
+  return T * T * T * (T * (T * mth::flt8(6) - mth::flt8(15)) + mth::flt8(10));
+} /* End of 'Fade8' function */
+
+/* Sine of eight values function.
+ * Argument is reduced to [-pi, pi] and parabola is refined once,
+ * absolute error is below 0.001 which is far under color quantization.
+ * ARGUMENTS:
+ *   - angles in radians:
+ *       const mth::flt8 &X;
+ * RETURNS: (mth::flt8) sines.
+ */
+static mth::flt8 Sin8( const mth::flt8 &X )
+{
+  const FLT Pi = 3.14159265358979f;
+  mth::flt8 y = X * mth::flt8(0.5f / Pi);
+
+  y = (y - (y + mth::flt8(0.5f)).Floor()) * mth::flt8(2 * Pi);
+
+  mth::flt8 s = y * mth::flt8(4 / Pi) - y * y.Abs() * mth::flt8(4 / (Pi * Pi));
+
+  return (s * s.Abs() - s) * mth::flt8(0.225f) + s;
+} /* End of 'Sin8' function */
+
+/* Perlin gradient noise of eight points function.
+ * Cell corners and their interpolation are computed in vector registers;
+ * lattice hashes need table lookups, so corner gradients are gathered per
+ * lane, which also keeps function running on plain AVX.
+ * ARGUMENTS:
+ *   - points:
+ *       const mth::vec3x8 &P;
+ * RETURNS: (mth::flt8) noise values in [-1, 1] range.
+ */
+static mth::flt8 Noise8( const mth::vec3x8 &P )
+{
+  mth::vec3x8 C(P.X.Floor(), P.Y.Floor(), P.Z.Floor()), T = P - C;
+  FLT cx[8], cy[8], cz[8], g[8][3][8];
+
+  C.X.Store(cx);
+  C.Y.Store(cy);
+  C.Z.Store(cz);
+  for (INT l = 0; l < 8; l++)
+  {
+    INT
+      x = (INT)cx[l] & 255,
+      y = (INT)cy[l] & 255,
+      z = (INT)cz[l] & 255;
+
+    for (INT k = 0; k < 8; k++)
+    {
+      const FLT *G = NoiseGrad[NoisePerm.P[NoisePerm.P[NoisePerm.P[x + (k & 1)] + y + (k >> 1 & 1)] + z + (k >> 2)] & 15];
+
+      g[k][0][l] = G[0];
+      g[k][1][l] = G[1];
+      g[k][2][l] = G[2];
+    }
+  }
+
+  mth::flt8 d[8], one(1);
+
+  for (INT k = 0; k < 8; k++)
+  {
+    mth::flt8
+      dx = k & 1 ? T.X - one : T.X,
+      dy = k & 2 ? T.Y - one : T.Y,
+      dz = k & 4 ? T.Z - one : T.Z;
+
+    d[k] = mth::flt8::Load(g[k][0]) * dx + mth::flt8::Load(g[k][1]) * dy + mth::flt8::Load(g[k][2]) * dz;
+  }
+
+  mth::flt8 u = Fade8(T.X), v = Fade8(T.Y), w = Fade8(T.Z);
+
+  return Lerp8(Lerp8(Lerp8(d[0], d[1], u), Lerp8(d[2], d[3], u), v),
+               Lerp8(Lerp8(d[4], d[5], u), Lerp8(d[6], d[7], u), v), w);
+} /* End of 'Noise8' function */
+
+/* Emit node and its inputs instructions function.
+ * ARGUMENTS:
+ *   - node:
+ *       const proc_ref &N;
+ *   - already emitted nodes registers:
+ *       std::map<const proc_node *, INT> &Regs;
+ * RETURNS: (INT) node result register (-1 if graph is broken).
+ */
+INT ivrt::proc_texture::Emit( const proc_ref &N, std::map<const proc_node *, INT> &Regs )
+{
+  static const INT InputsNum[] = {0, 0, 1, 1, 1, 2, 2, 1, 3, 2};
+
+  if (N == nullptr)
+    return -1;
+
+  auto It = Regs.find(N.get());
+
+  if (It != Regs.end())
+    return It->second;
+
+  instr I;
+
+  I.Op = N->Op;
+  I.Octaves = N->Octaves;
+  I.Freq = N->Op == PROC_POINT ? (FLT)N->Param[0] : 1;
+  for (INT i = 0; i < 3; i++)
+  {
+    I.Param[i] = (FLT)N->Param[i];
+    I.In[i] = -1;
+    if (i < InputsNum[N->Op] && (I.In[i] = Emit(N->In[i], Regs)) < 0)
+      return -1;
+  }
+  if (InputsNum[N->Op] > 0)
+    I.Freq = Code[I.In[0]].Freq;
+  if (Code.size() >= MaxRegs)
+    return -1;
+  Code.push_back(I);
+  return Regs[N.get()] = (INT)Code.size() - 1;
+} /* End of 'ivrt::proc_texture::Emit' function */
+
+/* Compile graph function.
+ * ARGUMENTS:
+ *   - graph root node:
+ *       const proc_ref &Root;
+ * RETURNS: (BOOL) TRUE if success, FALSE if graph lacks inputs or is too long.
+ */
+BOOL ivrt::proc_texture::Compile( const proc_ref &Root )
+{
+  std::map<const proc_node *, INT> Regs;
+
+  Code.clear();
+  if (Emit(Root, Regs) < 0)
+  {
+    Code.clear();
+    return FALSE;
+  }
+  return TRUE;
+} /* End of 'ivrt::proc_texture::Compile' function */
+
+/* Evaluate eight points function.
+ * ARGUMENTS:
+ *   - points:
+ *       const mth::vec3x8 &P;
+ *   - points footprints widths:
+ *       const mth::flt8 &Width;
+ *   - colors (for output):
+ *       mth::vec3x8 *Color;
+ * RETURNS: None.
+ */
+VOID ivrt::proc_texture::Eval8( const mth::vec3x8 &P, const mth::flt8 &Width, mth::vec3x8 *Color ) const
+{
+  mth::vec3x8 R[MaxRegs];
+  mth::flt8 one(1), half(0.5f);
+
+  if (Code.empty())
+  {
+    *Color = mth::vec3x8(mth::vec3<FLT>(1));
+    return;
+  }
+  for (INT i = 0; i < (INT)Code.size(); i++)
+  {
+    const instr &I = Code[i];
+    const mth::vec3x8 &A = R[I.In[0] < 0 ? i : I.In[0]];
+    mth::flt8 s;
+
+    switch (I.Op)
+    {
+    case PROC_POINT:
+      R[i] = P * mth::flt8(I.Param[0]);
+      continue;
+    case PROC_COLOR:
+      R[i] = mth::vec3x8(mth::vec3<FLT>(I.Param[0], I.Param[1], I.Param[2]));
+      continue;
+    case PROC_CHECKER:
+      {
+        /* Cells finer than footprint fade to their average */
+        mth::flt8
+          c = A.X.Floor() + A.Y.Floor() + A.Z.Floor(),
+          t = (Width * mth::flt8(I.Freq)).Min(one);
+
+        c = c - (c * half).Floor() * mth::flt8(2);
+        s = c * (one - t) + half * t;
+      }
+      break;
+    case PROC_NOISE:
+      s = half + half * Noise8(A) * Saturate8(mth::flt8(2) - Width * mth::flt8(4 * I.Freq));
+      break;
+    case PROC_FBM:
+      {
+        /* Octaves finer than footprint fade out (to average), all faded octaves stop loop */
+        mth::flt8 sum(0);
+        FLT f = 1, amp = 0.5f;
+
+        for (INT o = 0; o < I.Octaves; o++, f *= 2, amp *= 0.5f)
+        {
+          mth::flt8 w = Saturate8(mth::flt8(2) - Width * mth::flt8(4 * I.Freq * f));
+
+          if ((w > mth::flt8(0)).MoveMask() == 0)
+            break;
+          sum = sum + Noise8(A * mth::flt8(f)) * w * mth::flt8(amp);
+        }
+        s = Saturate8(half + sum);
+      }
+      break;
+    case PROC_MARBLE:
+      s = half + half * Sin8(A.X * mth::flt8(I.Param[0]) + R[I.In[1]].X * mth::flt8(I.Param[1]));
+      break;
+    case PROC_WOOD:
+      s = (A.X * A.X + A.Z * A.Z).Sqrt() * mth::flt8(I.Param[0]) + R[I.In[1]].X * mth::flt8(I.Param[1]);
+      s = s - s.Floor();
+      break;
+    case PROC_GRADIENT:
+      s = Saturate8(I.Param[0] < 0.5f ? A.X : I.Param[0] < 1.5f ? A.Y : A.Z);
+      break;
+    case PROC_MIX:
+      R[i] = A + (R[I.In[1]] - A) * R[I.In[2]];
+      continue;
+    case PROC_MUL:
+      R[i] = A * R[I.In[1]];
+      continue;
+    }
+    R[i] = mth::vec3x8(s, s, s);
+  }
+  *Color = R[Code.size() - 1];
+} /* End of 'ivrt::proc_texture::Eval8' function */
+
+/* Evaluate points batch function.
+ * ARGUMENTS:
+ *   - number of points:
+ *       INT N;
+ *   - points and their footprints widths:
+ *       const vec3 *P; const DBL *Width;
+ *   - colors (for output):
+ *       vec3 *Colors;
+ * RETURNS: None.
+ */
+VOID ivrt::proc_texture::Eval( INT N, const vec3 *P, const DBL *Width, vec3 *Colors ) const
+{
+  mth::vec3<FLT> p[8], c[8];
+  FLT w[8];
+
+  for (INT i = 0; i < N; i += 8)
+  {
+    INT n = mth::Min(N - i, 8);
+    mth::vec3x8 C;
+
+    /* Last batch is padded by its last point */
+    for (INT l = 0; l < 8; l++)
+    {
+      INT j = i + mth::Min(l, n - 1);
+
+      p[l] = mth::vec3<FLT>((FLT)P[j][0], (FLT)P[j][1], (FLT)P[j][2]);
+      w[l] = (FLT)Width[j];
+    }
+    Eval8(mth::vec3x8::Load(p), mth::flt8::Load(w), &C);
+    C.Store(c);
+    for (INT l = 0; l < n; l++)
+      Colors[i + l] = vec3(c[l][0], c[l][1], c[l][2]);
+  }
+} /* End of 'ivrt::proc_texture::Eval' function */
+
+/* Make preset graph function.
+ * ARGUMENTS:
+ *   - preset name ("checker", "noise", "marble", "wood", "gradient"):
+ *       const std::string &Name;
+ * RETURNS: (proc_ref) graph root (nullptr if name is unknown).
+ */
+ivrt::proc_ref ivrt::proc_texture::Preset( const std::string &Name )
+{
+  if (Name == "checker")
+    return proc_node::Checker(proc_node::Point(1));
+  if (Name == "noise")
+    return proc_node::Mix(proc_node::Color(vec3(0.2, 0.3, 0.15)), proc_node::Color(vec3(0.7, 0.75, 0.5)),
+                          proc_node::Fbm(proc_node::Point(2), 6));
+  if (Name == "marble")
+  {
+    proc_ref p = proc_node::Point(0.5);
+
+    return proc_node::Mix(proc_node::Color(vec3(0.25, 0.25, 0.3)), proc_node::Color(vec3(0.95, 0.93, 0.9)),
+                          proc_node::Marble(p, proc_node::Fbm(p, 5)));
+  }
+  if (Name == "wood")
+  {
+    proc_ref p = proc_node::Point(0.25);
+
+    return proc_node::Mix(proc_node::Color(vec3(0.35, 0.2, 0.08)), proc_node::Color(vec3(0.75, 0.5, 0.25)),
+                          proc_node::Wood(p, proc_node::Fbm(proc_node::Point(2), 4)));
+  }
+  if (Name == "gradient")
+    return proc_node::Mix(proc_node::Color(vec3(0.2, 0.3, 0.8)), proc_node::Color(vec3(1)),
+                          proc_node::Gradient(proc_node::Point(0.05), 0));
+  return nullptr;
+} /* End of 'ivrt::proc_texture::Preset' function */
+
+/* END OF 'procedural.cpp' FILE */
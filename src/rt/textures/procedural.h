@@ -0,0 +1,302 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : procedural.h
+ * PURPOSE     : Raytracing project.
+ *               Procedural textures node graphs declaration module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __procedural_h_
+#define __procedural_h_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../def.h"
+
+/* Project namespace */
+namespace ivrt
+{
+  /* Procedural texture node operations.
+   * Scalar results are kept in all three color channels. */
+  enum PROC_OP
+  {
+    PROC_POINT,    // shaded point scaled by Param[0]
+    PROC_COLOR,    // constant color Param
+    PROC_CHECKER,  // 0/1 unit cells checker of point
+    PROC_NOISE,    // Perlin gradient noise of point mapped to [0, 1]
+    PROC_FBM,      // fractal sum of 'Octaves' noise octaves of point mapped to [0, 1]
+    PROC_MARBLE,   // 0.5 + 0.5 sin(Param[0] x + Param[1] turbulence)
+    PROC_WOOD,     // rings: frac(Param[0] |(x, z)| + Param[1] turbulence)
+    PROC_GRADIENT, // point coordinate Param[0] clamped to [0, 1]
+    PROC_MIX,      // first input + (second - first) * third
+    PROC_MUL       // product of inputs
+  }; /* End of 'PROC_OP' enum */
+
+  class proc_node;
+
+  /* Procedural texture node reference */
+  typedef std::shared_ptr<proc_node> proc_ref;
+
+  /* Procedural texture graph node class.
+   * Graphs are built from these nodes (inputs may be shared) and compiled
+   * to 'proc_texture' instructions before rendering. */
+  class proc_node
+  {
+  public:
+    PROC_OP Op;           // operation
+    proc_ref In[3];       // inputs (by operation)
+    vec3 Param;           // operation parameters
+    INT Octaves = 0;      // noise octaves (fBm only)
+
+    /* Class constructor.
+     * ARGUMENTS:
+     *   - operation:
+     *       PROC_OP NOp;
+     *   - parameters:
+     *       const vec3 &NParam;
+     *   - inputs:
+     *       const proc_ref &A, &B, &C;
+     */
+    proc_node( PROC_OP NOp, const vec3 &NParam, const proc_ref &A = nullptr,
+               const proc_ref &B = nullptr, const proc_ref &C = nullptr ) :
+      Op(NOp), In{A, B, C}, Param(NParam)
+    {
+    } /* End of 'proc_node' function */
+
+    /* Shaded point node function.
+     * ARGUMENTS:
+     *   - point scale (features per world unit):
+     *       DBL Scale;
+     * RETURNS: (proc_ref) new node.
+     */
+    static proc_ref Point( DBL Scale = 1 )
+    {
+      return std::make_shared<proc_node>(PROC_POINT, vec3(Scale));
+    } /* End of 'Point' function */
+
+    /* Constant color node function.
+     * ARGUMENTS:
+     *   - color:
+     *       const vec3 &C;
+     * RETURNS: (proc_ref) new node.
+     */
+    static proc_ref Color( const vec3 &C )
+    {
+      return std::make_shared<proc_node>(PROC_COLOR, C);
+    } /* End of 'Color' function */
+
+    /* Checker node function.
+     * ARGUMENTS:
+     *   - point node:
+     *       const proc_ref &P;
+     * RETURNS: (proc_ref) new node.
+     */
+    static proc_ref Checker( const proc_ref &P )
+    {
+      return std::make_shared<proc_node>(PROC_CHECKER, vec3(0), P);
+    } /* End of 'Checker' function */
+
+    /* Noise node function.
+     * ARGUMENTS:
+     *   - point node:
+     *       const proc_ref &P;
+     * RETURNS: (proc_ref) new node.
+     */
+    static proc_ref Noise( const proc_ref &P )
+    {
+      return std::make_shared<proc_node>(PROC_NOISE, vec3(0), P);
+    } /* End of 'Noise' function */
+
+    /* Fractal brownian motion node function.
+     * ARGUMENTS:
+     *   - point node:
+     *       const proc_ref &P;
+     *   - octaves number:
+     *       INT Octaves;
+     * RETURNS: (proc_ref) new node.
+     */
+    static proc_ref Fbm( const proc_ref &P, INT Octaves = 5 )
+    {
+      proc_ref N = std::make_shared<proc_node>(PROC_FBM, vec3(0), P);
+
+      N->Octaves = Octaves;
+      return N;
+    } /* End of 'Fbm' function */
+
+    /* Marble node function.
+     * ARGUMENTS:
+     *   - point and turbulence nodes:
+     *       const proc_ref &P, &Turb;
+     *   - veins frequency and turbulence amount:
+     *       DBL Freq, Amount;
+     * RETURNS: (proc_ref) new node.
+     */
+    static proc_ref Marble( const proc_ref &P, const proc_ref &Turb, DBL Freq = 4, DBL Amount = 5 )
+    {
+      return std::make_shared<proc_node>(PROC_MARBLE, vec3(Freq, Amount, 0), P, Turb);
+    } /* End of 'Marble' function */
+
+    /* Wood node function.
+     * ARGUMENTS:
+     *   - point and turbulence nodes:
+     *       const proc_ref &P, &Turb;
+     *   - rings frequency and turbulence amount:
+     *       DBL Freq, Amount;
+     * RETURNS: (proc_ref) new node.
+     */
+    static proc_ref Wood( const proc_ref &P, const proc_ref &Turb, DBL Freq = 8, DBL Amount = 0.5 )
+    {
+      return std::make_shared<proc_node>(PROC_WOOD, vec3(Freq, Amount, 0), P, Turb);
+    } /* End of 'Wood' function */
+
+    /* Gradient node function.
+     * ARGUMENTS:
+     *   - point node:
+     *       const proc_ref &P;
+     *   - coordinate axis (0 - X, 1 - Y, 2 - Z):
+     *       INT Axis;
+     * RETURNS: (proc_ref) new node.
+     */
+    static proc_ref Gradient( const proc_ref &P, INT Axis = 1 )
+    {
+      return std::make_shared<proc_node>(PROC_GRADIENT, vec3(Axis), P);
+    } /* End of 'Gradient' function */
+
+    /* Mix node function.
+     * ARGUMENTS:
+     *   - mixed nodes and mix factor node:
+     *       const proc_ref &A, &B, &T;
+     * RETURNS: (proc_ref) new node.
+     */
+    static proc_ref Mix( const proc_ref &A, const proc_ref &B, const proc_ref &T )
+    {
+      return std::make_shared<proc_node>(PROC_MIX, vec3(0), A, B, T);
+    } /* End of 'Mix' function */
+
+    /* Product node function.
+     * ARGUMENTS:
+     *   - multiplied nodes:
+     *       const proc_ref &A, &B;
+     * RETURNS: (proc_ref) new node.
+     */
+    static proc_ref Mul( const proc_ref &A, const proc_ref &B )
+    {
+      return std::make_shared<proc_node>(PROC_MUL, vec3(0), A, B);
+    } /* End of 'Mul' function */
+  }; /* End of 'proc_node' class */
+
+  /* Compiled procedural texture class.
+   * Graph is flattened to instructions in inputs first order, instruction
+   * index is its result register. Evaluation runs the whole program over
+   * eight points at once, every register keeps eight colors, so graph
+   * walking and virtual calls are paid once per batch. Footprint width
+   * turns off checker and noise detail finer than it. */
+  class proc_texture
+  {
+  private:
+    /* Program instruction */
+    struct instr
+    {
+      PROC_OP Op;       // operation
+      INT In[3];        // input registers
+      FLT Param[3];     // operation parameters
+      FLT Freq;         // input point scale (for footprint of its features)
+      INT Octaves;      // noise octaves (fBm only)
+    }; /* End of 'instr' structure */
+
+    std::vector<instr> Code; // program (empty if graph is broken)
+
+    /* Emit node and its inputs instructions function.
+     * ARGUMENTS:
+     *   - node:
+     *       const proc_ref &N;
+     *   - already emitted nodes registers:
+     *       std::map<const proc_node *, INT> &Regs;
+     * RETURNS: (INT) node result register (-1 if graph is broken).
+     */
+    INT Emit( const proc_ref &N, std::map<const proc_node *, INT> &Regs );
+
+  public:
+    static const INT MaxRegs = 32; // maximal program length
+
+    /* Class constructor.
+     * ARGUMENTS:
+     *   - graph root node:
+     *       const proc_ref &Root;
+     */
+    proc_texture( const proc_ref &Root )
+    {
+      Compile(Root);
+    } /* End of 'proc_texture' function */
+
+    /* Compile graph function.
+     * ARGUMENTS:
+     *   - graph root node:
+     *       const proc_ref &Root;
+     * RETURNS: (BOOL) TRUE if success, FALSE if graph lacks inputs or is too long.
+     */
+    BOOL Compile( const proc_ref &Root );
+
+    /* Evaluate eight points function.
+     * ARGUMENTS:
+     *   - points:
+     *       const mth::vec3x8 &P;
+     *   - points footprints widths:
+     *       const mth::flt8 &Width;
+     *   - colors (for output):
+     *       mth::vec3x8 *Color;
+     * RETURNS: None.
+     */
+    VOID Eval8( const mth::vec3x8 &P, const mth::flt8 &Width, mth::vec3x8 *Color ) const;
+
+    /* Evaluate points batch function.
+     * ARGUMENTS:
+     *   - number of points:
+     *       INT N;
+     *   - points and their footprints widths:
+     *       const vec3 *P; const DBL *Width;
+     *   - colors (for output):
+     *       vec3 *Colors;
+     * RETURNS: None.
+     */
+    VOID Eval( INT N, const vec3 *P, const DBL *Width, vec3 *Colors ) const;
+
+    /* Evaluate one point function.
+     * ARGUMENTS:
+     *   - point and its footprint width:
+     *       const vec3 &P; DBL Width;
+     * RETURNS: (vec3) color.
+     */
+    vec3 Eval( const vec3 &P, DBL Width = 0 ) const
+    {
+      vec3 C;
+
+      Eval(1, &P, &Width, &C);
+      return C;
+    } /* End of 'Eval' function */
+
+    /* Make preset graph function.
+     * ARGUMENTS:
+     *   - preset name ("checker", "noise", "marble", "wood", "gradient"):
+     *       const std::string &Name;
+     * RETURNS: (proc_ref) graph root (nullptr if name is unknown).
+     */
+    static proc_ref Preset( const std::string &Name );
+  }; /* End of 'proc_texture' class */
+} /* end of 'ivrt' namespace */
+
+#endif /* __procedural_h_ */
+
+/* END OF 'procedural.h' FILE */
@@ -0,0 +1,411 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : texture.cpp
+ * PURPOSE     : Raytracing project.
+ *               Mip-mapped image textures and texture cache implementation module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#include <cctype>
+#include <cstdio>
+
+#include "texture.h"
+
+#pragma pack(push, 1)
+#include <TGAHEAD.H>
+#pragma pack(pop)
+
+/* Convert packed texel to color function.
+ * ARGUMENTS:
+ *   - packed 0xAARRGGBB texel:
+ *       DWORD C;
+ * RETURNS: (ivrt::vec3) color in [0, 1] range.
+ */
+static ivrt::vec3 TexelColor( DWORD C )
+{
+  return ivrt::vec3((C >> 16) & 0xFF, (C >> 8) & 0xFF, C & 0xFF) * (1.0 / 255);
+} /* End of 'TexelColor' function */
+
+/* Bilinear lookup with repeat wrapping function.
+ * ARGUMENTS:
+ *   - texture coordinates:
+ *       DBL U, V;
+ * RETURNS: (vec3) color in [0, 1] range.
+ */
+ivrt::vec3 ivrt::texture_level::Bilinear( DBL U, DBL V ) const
+{
+  DBL
+    x = U * W - 0.5, y = V * H - 0.5,
+    fx = floor(x), fy = floor(y),
+    tx = x - fx, ty = y - fy;
+  INT
+    x0 = (INT)(fx - floor(fx / W) * W), y0 = (INT)(fy - floor(fy / H) * H),
+    x1 = x0 + 1 == W ? 0 : x0 + 1, y1 = y0 + 1 == H ? 0 : y0 + 1;
+
+  return (TexelColor((*this)(x0, y0)) * (1 - tx) + TexelColor((*this)(x1, y0)) * tx) * (1 - ty) +
+         (TexelColor((*this)(x0, y1)) * (1 - tx) + TexelColor((*this)(x1, y1)) * tx) * ty;
+} /* End of 'ivrt::texture_level::Bilinear' function */
+
+/* Filtered lookup function.
+ * ARGUMENTS:
+ *   - texture coordinates:
+ *       const vec2 &UV;
+ *   - texture coordinates derivatives along screen X and Y:
+ *       const vec2 &DUVdx, &DUVdy;
+ * RETURNS: (vec3) color in [0, 1] range (white if image is broken).
+ */
+ivrt::vec3 ivrt::texture::Sample( const vec2 &UV, const vec2 &DUVdx, const vec2 &DUVdy )
+{
+  const texture_mips *M = Cache->Acquire(this);
+
+  if (M == nullptr)
+    return vec3(1);
+
+  const texture_level &Top = (*M)[0];
+  DBL
+    dx = DUVdx[0] * Top.W, dy = DUVdx[1] * Top.H,
+    ex = DUVdy[0] * Top.W, ey = DUVdy[1] * Top.H,
+    texels = sqrt(mth::Max(dx * dx + dy * dy, ex * ex + ey * ey)),
+    lod = texels > 1 ? mth::Min(log2(texels), (DBL)M->size() - 1) : 0;
+  INT l = (INT)lod;
+  DBL t = lod - l;
+
+  if (t == 0)
+    return (*M)[l].Bilinear(UV[0], UV[1]);
+  return (*M)[l].Bilinear(UV[0], UV[1]) * (1 - t) + (*M)[l + 1].Bilinear(UV[0], UV[1]) * t;
+} /* End of 'ivrt::texture::Sample' function */
+
+/* Get texture pyramid, loading it if evicted function.
+ * Resident pyramids are read lock free; only loading takes lock. Nothing
+ * is evicted here, so pyramids used in current frame stay resident even if
+ * budget is exceeded until 'Frame' call.
+ * ARGUMENTS:
+ *   - texture:
+ *       texture *Tex;
+ * RETURNS: (const texture_mips *) pyramid valid until next 'Frame' call (nullptr if image is broken).
+ */
+const ivrt::texture_mips * ivrt::texture_cache::Acquire( texture *Tex )
+{
+  UINT64 t = Tick.load(std::memory_order_relaxed);
+
+  /* Only changed tick is written, so samplers of one texture don't fight for its cache line */
+  if (Tex->LastUse.load(std::memory_order_relaxed) != t)
+    Tex->LastUse.store(t, std::memory_order_relaxed);
+
+  const texture_mips *M = Tex->Mips.load(std::memory_order_acquire);
+
+  if (M != nullptr || Tex->IsBroken.load(std::memory_order_relaxed))
+    return M;
+
+  std::lock_guard<std::mutex> Lock(Mutex);
+
+  if ((M = Tex->Mips.load(std::memory_order_acquire)) != nullptr || Tex->IsBroken)
+    return M;
+
+  std::unique_ptr<texture_mips> New = std::make_unique<texture_mips>(1);
+
+  if (!Load(Tex->FileName, &(*New)[0]))
+  {
+    Tex->IsBroken = TRUE;
+    return nullptr;
+  }
+  BuildMips(New.get());
+  Tex->W = (*New)[0].W;
+  Tex->H = (*New)[0].H;
+  Tex->Bytes = 0;
+  for (auto &L : *New)
+    Tex->Bytes += L.Texels.size() * sizeof(DWORD);
+  Resident += Tex->Bytes;
+  Loads++;
+  M = New.get();
+  Tex->Pyramid = std::move(New);
+  Tex->Mips.store(M, std::memory_order_release);
+  return M;
+} /* End of 'ivrt::texture_cache::Acquire' function */
+
+/* Start new frame function.
+ * Called between frames (no lookups run), so least recently used pyramids
+ * are evicted here until budget is met; pyramids of last frame go last.
+ * ARGUMENTS: None.
+ * RETURNS: None.
+ */
+VOID ivrt::texture_cache::Frame( VOID )
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+
+  while (Resident > Budget)
+  {
+    texture *Lru = nullptr;
+
+    for (auto &T : Textures)
+      if (T.second->Pyramid != nullptr &&
+          (Lru == nullptr || T.second->LastUse < Lru->LastUse))
+        Lru = T.second.get();
+    if (Lru == nullptr)
+      break;
+    Lru->Mips.store(nullptr, std::memory_order_relaxed);
+    Lru->Pyramid.reset();
+    Resident -= Lru->Bytes;
+    Evictions++;
+  }
+  Tick++;
+} /* End of 'ivrt::texture_cache::Frame' function */
+
+/* Get texture by file name function.
+ * ARGUMENTS:
+ *   - image file name (*.tga, *.ppm):
+ *       const std::string &FileName;
+ * RETURNS: (texture *) shared texture (owned by cache).
+ */
+ivrt::texture * ivrt::texture_cache::Get( const std::string &FileName )
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+  std::unique_ptr<texture> &T = Textures[FileName];
+
+  if (T == nullptr)
+    T = std::make_unique<texture>(this, FileName);
+  return T.get();
+} /* End of 'ivrt::texture_cache::Get' function */
+
+/* Build mip pyramid from top level function.
+ * Every level is 2x2 box filtered previous one (edge texels repeat for odd sizes).
+ * ARGUMENTS:
+ *   - pyramid with top level filled:
+ *       texture_mips *Mips;
+ * RETURNS: None.
+ */
+VOID ivrt::texture_cache::BuildMips( texture_mips *Mips )
+{
+  Mips->resize(1);
+  while (Mips->back().W > 1 || Mips->back().H > 1)
+  {
+    Mips->emplace_back();
+
+    const texture_level &S = (*Mips)[Mips->size() - 2];
+    texture_level &D = Mips->back();
+
+    D.Resize(mth::Max(S.W / 2, 1), mth::Max(S.H / 2, 1));
+    for (INT y = 0; y < D.H; y++)
+      for (INT x = 0; x < D.W; x++)
+      {
+        INT
+          x0 = mth::Min(2 * x, S.W - 1), x1 = mth::Min(2 * x + 1, S.W - 1),
+          y0 = mth::Min(2 * y, S.H - 1), y1 = mth::Min(2 * y + 1, S.H - 1);
+        DWORD
+          c[4] = {S(x0, y0), S(x1, y0), S(x0, y1), S(x1, y1)},
+          r = 0;
+
+        for (INT s = 0; s < 32; s += 8)
+          r |= ((((c[0] >> s) & 0xFF) + ((c[1] >> s) & 0xFF) + ((c[2] >> s) & 0xFF) + ((c[3] >> s) & 0xFF) + 2) >> 2) << s;
+        D(x, y) = r;
+      }
+  }
+} /* End of 'ivrt::texture_cache::BuildMips' function */
+
+/* Load TGA image function.
+ * Color mapped, true color and grayscale images, raw or RLE packed,
+ * 8/15/16/24/32 bits per pixel are supported.
+ * ARGUMENTS:
+ *   - opened file:
+ *       FILE *F;
+ *   - result level:
+ *       ivrt::texture_level *L;
+ * RETURNS: (BOOL) TRUE if success, FALSE otherwise.
+ */
+static BOOL LoadTGA( FILE *F, ivrt::texture_level *L )
+{
+  tgaFILEHEADER fh;
+  std::vector<DWORD> Palette;
+  INT type, bpp, n, i = 0;
+
+  if (fread(&fh, sizeof(fh), 1, F) != 1 || fh.Width == 0 || fh.Height == 0)
+    return FALSE;
+  type = fh.ImageType & ~8;
+  bpp = (fh.BitsPerPixel + 7) / 8;
+  if ((type != 1 && type != 2 && type != 3) || bpp < 1 || bpp > 4 || (type == 1 && fh.ColorMapType != 1))
+    return FALSE;
+  fseek(F, fh.IDLength, SEEK_CUR);
+
+  /* Convert file pixel to texel */
+  auto texel =
+    []( const BYTE *P, INT Bytes ) -> DWORD
+    {
+      switch (Bytes)
+      {
+      case 1:
+        return 0xFF000000 | P[0] * 0x010101;
+      case 2:
+        {
+          INT c = P[0] | P[1] << 8, r = (c >> 10) & 31, g = (c >> 5) & 31, b = c & 31;
+
+          return 0xFF000000 | (r * 255 / 31) << 16 | (g * 255 / 31) << 8 | b * 255 / 31;
+        }
+      case 3:
+        return 0xFF000000 | P[2] << 16 | P[1] << 8 | P[0];
+      default:
+        return (DWORD)P[3] << 24 | P[2] << 16 | P[1] << 8 | P[0];
+      }
+    };
+
+  if (fh.ColorMapType == 1)
+  {
+    INT eb = (fh.PaletteEntryDepth + 7) / 8;
+    BYTE e[4];
+
+    if (eb < 2 || eb > 4)
+      return FALSE;
+    Palette.resize(fh.PaletteStart + fh.PaletteSize);
+    for (INT k = 0; k < fh.PaletteSize; k++)
+    {
+      if (fread(e, eb, 1, F) != 1)
+        return FALSE;
+      Palette[fh.PaletteStart + k] = texel(e, eb);
+    }
+  }
+
+  L->Resize(fh.Width, fh.Height);
+  n = fh.Width * fh.Height;
+  while (i < n)
+  {
+    BYTE p[4];
+    INT count = 1, c;
+    BOOL IsRepeat = FALSE;
+
+    if (fh.ImageType & 8)
+    {
+      if ((c = fgetc(F)) == EOF)
+        return FALSE;
+      count = (c & 0x7F) + 1;
+      IsRepeat = (c & 0x80) != 0;
+    }
+    for (INT k = 0; k < count && i < n; k++, i++)
+    {
+      if ((k == 0 || !IsRepeat) && fread(p, bpp, 1, F) != 1)
+        return FALSE;
+
+      DWORD t;
+      INT x = i % fh.Width, y = i / fh.Width;
+
+      if (type == 1)
+      {
+        UINT idx = bpp == 1 ? p[0] : p[0] | p[1] << 8;
+
+        t = idx < Palette.size() ? Palette[idx] : 0xFF000000;
+      }
+      else
+        t = texel(p, bpp);
+      /* Bottom-up rows unless top-left origin bit is set */
+      (*L)(x, fh.ImageDescr & 0x20 ? y : fh.Height - 1 - y) = t;
+    }
+  }
+  return TRUE;
+} /* End of 'LoadTGA' function */
+
+/* Read PPM header number function (comments are skipped).
+ * ARGUMENTS:
+ *   - opened file:
+ *       FILE *F;
+ * RETURNS: (INT) number (-1 if failed).
+ */
+static INT ReadPNMNumber( FILE *F )
+{
+  INT c, n = 0;
+
+  while ((c = fgetc(F)) != EOF && (isspace(c) || c == '#'))
+    if (c == '#')
+      while ((c = fgetc(F)) != EOF && c != '\n')
+        ;
+  if (c == EOF || !isdigit(c))
+    return -1;
+  for (; c != EOF && isdigit(c); c = fgetc(F))
+    n = n * 10 + c - '0';
+  return n;
+} /* End of 'ReadPNMNumber' function */
+
+/* Load PPM/PGM image function.
+ * Binary (P6, P5) and text (P3, P2) images with up to 16 bit samples are supported.
+ * ARGUMENTS:
+ *   - opened file:
+ *       FILE *F;
+ *   - result level:
+ *       ivrt::texture_level *L;
+ * RETURNS: (BOOL) TRUE if success, FALSE otherwise.
+ */
+static BOOL LoadPPM( FILE *F, ivrt::texture_level *L )
+{
+  INT magic[2] = {fgetc(F), fgetc(F)}, w, h, maxv, comps;
+  BOOL IsBinary;
+
+  if (magic[0] != 'P' || (magic[1] != '2' && magic[1] != '3' && magic[1] != '5' && magic[1] != '6'))
+    return FALSE;
+  IsBinary = magic[1] >= '5';
+  comps = magic[1] == '3' || magic[1] == '6' ? 3 : 1;
+  if ((w = ReadPNMNumber(F)) <= 0 || (h = ReadPNMNumber(F)) <= 0 || (maxv = ReadPNMNumber(F)) <= 0 || maxv > 65535)
+    return FALSE;
+
+  L->Resize(w, h);
+  for (INT y = 0; y < h; y++)
+    for (INT x = 0; x < w; x++)
+    {
+      INT v[3];
+
+      for (INT k = 0; k < comps; k++)
+      {
+        if (!IsBinary)
+          v[k] = ReadPNMNumber(F);
+        else if (maxv < 256)
+          v[k] = fgetc(F);
+        else
+        {
+          INT hi = fgetc(F), lo = fgetc(F);
+
+          v[k] = hi == EOF || lo == EOF ? -1 : hi << 8 | lo;
+        }
+        if (v[k] < 0)
+          return FALSE;
+        v[k] = mth::Min(v[k], maxv) * 255 / maxv;
+      }
+      if (comps == 1)
+        v[1] = v[2] = v[0];
+      (*L)(x, y) = 0xFF000000 | v[0] << 16 | v[1] << 8 | v[2];
+    }
+  return TRUE;
+} /* End of 'LoadPPM' function */
+
+/* Load image to top pyramid level function.
+ * Format is chosen by file extension. PNG files need zlib inflate which
+ * the project does not link, so they are refused (convert them to TGA).
+ * ARGUMENTS:
+ *   - image file name (*.tga, *.ppm):
+ *       const std::string &FileName;
+ *   - result level:
+ *       texture_level *L;
+ * RETURNS: (BOOL) TRUE if success, FALSE otherwise.
+ */
+BOOL ivrt::texture_cache::Load( const std::string &FileName, texture_level *L )
+{
+  std::string ext = FileName.substr(FileName.find_last_of('.') + 1);
+  BOOL IsOk = FALSE;
+  FILE *F;
+
+  for (auto &c : ext)
+    c = (CHAR)tolower(c);
+  if (ext != "tga" && ext != "ppm" && ext != "pgm" && ext != "pnm")
+    return FALSE;
+  if ((F = fopen(FileName.c_str(), "rb")) == nullptr)
+    return FALSE;
+  IsOk = ext == "tga" ? LoadTGA(F, L) : LoadPPM(F, L);
+  fclose(F);
+  return IsOk;
+} /* End of 'ivrt::texture_cache::Load' function */
+
+/* END OF 'texture.cpp' FILE */
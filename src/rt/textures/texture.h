@@ -0,0 +1,232 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : texture.h
+ * PURPOSE     : Raytracing project.
+ *               Mip-mapped image textures and texture cache declaration module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __texture_h_
+#define __texture_h_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../../def.h"
+
+/* Project namespace */
+namespace ivrt
+{
+  class texture_cache;
+
+  /* Texture mip level class.
+   * Texels are packed 0xAARRGGBB words stored in 4x4 tiles, one tile is
+   * exactly one 64 byte cache line, so bilinear footprints touch one or
+   * two lines instead of two scanlines far apart. */
+  class texture_level
+  {
+  public:
+    static const INT TileBits = 2;              // log2 of tile side
+    static const INT TileSide = 1 << TileBits;  // tile side in texels
+    static const INT TileMask = TileSide - 1;   // texel in tile coordinate mask
+
+    INT W = 0, H = 0;          // level size in texels
+    INT TilesW = 0;            // tiles in row
+    std::vector<DWORD> Texels; // tiled texels
+
+    /* Resize level function.
+     * ARGUMENTS:
+     *   - level size in texels:
+     *       INT NewW, NewH;
+     * RETURNS: None.
+     */
+    VOID Resize( INT NewW, INT NewH )
+    {
+      W = NewW;
+      H = NewH;
+      TilesW = (W + TileMask) >> TileBits;
+      Texels.assign((size_t)TilesW * ((H + TileMask) >> TileBits) << (2 * TileBits), 0);
+    } /* End of 'Resize' function */
+
+    /* Get texel reference function.
+     * ARGUMENTS:
+     *   - texel coordinates (inside level):
+     *       INT X, INT Y;
+     * RETURNS: (DWORD &) texel reference.
+     */
+    DWORD & operator()( INT X, INT Y )
+    {
+      return Texels[((((size_t)(Y >> TileBits) * TilesW + (X >> TileBits)) << TileBits | (Y & TileMask)) << TileBits) | (X & TileMask)];
+    } /* End of 'operator()' function */
+
+    /* Get texel function.
+     * ARGUMENTS:
+     *   - texel coordinates (inside level):
+     *       INT X, INT Y;
+     * RETURNS: (DWORD) texel.
+     */
+    DWORD operator()( INT X, INT Y ) const
+    {
+      return Texels[((((size_t)(Y >> TileBits) * TilesW + (X >> TileBits)) << TileBits | (Y & TileMask)) << TileBits) | (X & TileMask)];
+    } /* End of 'operator()' function */
+
+    /* Bilinear lookup with repeat wrapping function.
+     * ARGUMENTS:
+     *   - texture coordinates:
+     *       DBL U, V;
+     * RETURNS: (vec3) color in [0, 1] range.
+     */
+    vec3 Bilinear( DBL U, DBL V ) const;
+  }; /* End of 'texture_level' class */
+
+  /* Texture mip pyramid (loaded image data) */
+  typedef std::vector<texture_level> texture_mips;
+
+  /* Image texture class.
+   * Texture keeps only file name and size; its mip pyramid is loaded and
+   * evicted by owning cache. Pyramids are freed only between frames, so
+   * samplers use plain pointer without reference counting (no shared
+   * counter writes on every lookup). */
+  class texture
+  {
+    friend class texture_cache;
+  private:
+    texture_cache *Cache;                       // owning cache
+    std::string FileName;                       // image file name
+    std::unique_ptr<const texture_mips> Pyramid; // resident pyramid (nullptr if evicted)
+    std::atomic<const texture_mips *> Mips;     // published resident pyramid (for lock free lookups)
+    std::atomic<UINT64> LastUse;                // last use tick (for eviction order)
+    std::atomic<BOOL> IsBroken;                 // image can't be loaded flag
+    size_t Bytes = 0;                           // pyramid size in bytes
+
+  public:
+    INT W = 0, H = 0;                           // top level size (0 if image is broken)
+
+    /* Class constructor.
+     * ARGUMENTS:
+     *   - owning cache:
+     *       texture_cache *NCache;
+     *   - image file name:
+     *       const std::string &NFileName;
+     */
+    texture( texture_cache *NCache, const std::string &NFileName ) :
+      Cache(NCache), FileName(NFileName), Mips(nullptr), LastUse(0), IsBroken(FALSE)
+    {
+    } /* End of 'texture' function */
+
+    /* Filtered lookup function.
+     * Mip level is chosen by larger of texture coordinates footprints
+     * along screen axes (ray differentials); zero footprint gives bilinear
+     * lookup of top level, others are trilinear.
+     * ARGUMENTS:
+     *   - texture coordinates:
+     *       const vec2 &UV;
+     *   - texture coordinates derivatives along screen X and Y:
+     *       const vec2 &DUVdx, &DUVdy;
+     * RETURNS: (vec3) color in [0, 1] range (white if image is broken).
+     */
+    vec3 Sample( const vec2 &UV, const vec2 &DUVdx, const vec2 &DUVdy );
+  }; /* End of 'texture' class */
+
+  /* Texture cache class.
+   * Textures are shared by file name. Pyramids are loaded on first lookup;
+   * when resident pyramids outgrow memory budget, least recently used ones
+   * are evicted at next frame start and loaded back from file when needed
+   * again. Budget counts whole pyramids and is enforced only between
+   * frames, so it may be exceeded during frame by its working set. */
+  class texture_cache
+  {
+    friend class texture;
+  private:
+    std::mutex Mutex;                                          // loading and eviction lock
+    std::map<std::string, std::unique_ptr<texture>> Textures;  // all textures by file name
+    std::atomic<UINT64> Tick;                                  // use ticks counter
+    size_t Resident = 0;                                       // resident pyramids size in bytes
+
+    /* Get texture pyramid, loading it if evicted function.
+     * ARGUMENTS:
+     *   - texture:
+     *       texture *Tex;
+     * RETURNS: (const texture_mips *) pyramid valid until next 'Frame' call (nullptr if image is broken).
+     */
+    const texture_mips * Acquire( texture *Tex );
+
+  public:
+    size_t Budget;               // resident pyramids memory budget in bytes
+    std::atomic<UINT64>
+      Loads,                     // pyramids loads counter
+      Evictions;                 // pyramids evictions counter
+
+    /* Class constructor.
+     * ARGUMENTS:
+     *   - memory budget in bytes:
+     *       size_t NBudget;
+     */
+    texture_cache( size_t NBudget = (size_t)256 << 20 ) : Tick(0), Budget(NBudget), Loads(0), Evictions(0)
+    {
+    } /* End of 'texture_cache' function */
+
+    /* Get texture by file name function.
+     * ARGUMENTS:
+     *   - image file name (*.tga, *.ppm):
+     *       const std::string &FileName;
+     * RETURNS: (texture *) shared texture (owned by cache).
+     */
+    texture * Get( const std::string &FileName );
+
+    /* Start new frame function.
+     * Pyramids over budget are evicted here, between frames, so lookups
+     * never reload texture evicted in the same frame. Use ticks advance
+     * once per frame, so samplers never write shared counter.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    VOID Frame( VOID );
+
+    /* Get resident pyramids size function.
+     * ARGUMENTS: None.
+     * RETURNS: (size_t) size in bytes.
+     */
+    size_t Size( VOID )
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+
+      return Resident;
+    } /* End of 'Size' function */
+
+    /* Load image to top pyramid level function.
+     * ARGUMENTS:
+     *   - image file name (*.tga, *.ppm):
+     *       const std::string &FileName;
+     *   - result level:
+     *       texture_level *L;
+     * RETURNS: (BOOL) TRUE if success, FALSE otherwise.
+     */
+    static BOOL Load( const std::string &FileName, texture_level *L );
+
+    /* Build mip pyramid from top level function.
+     * ARGUMENTS:
+     *   - pyramid with top level filled:
+     *       texture_mips *Mips;
+     * RETURNS: None.
+     */
+    static VOID BuildMips( texture_mips *Mips );
+  }; /* End of 'texture_cache' class */
+} /* end of 'ivrt' namespace */
+
+#endif /* __texture_h_ */
+
+/* END OF 'texture.h' FILE */
@@ -0,0 +1,275 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : wavefront.cpp
+ * PURPOSE     : Raytracing project.
+ *               Wavefront (breadth-first) renderer implementation module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 06.08.2021
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#include <algorithm>
+
+#include "wavefront.h"
+
+/* Intersect current bounce rays function.
+ * ARGUMENTS:
+ *   - scene to intersect:
+ *       scene &Scene;
+ * RETURNS: None.
+ */
+VOID ivrt::wavefront::Intersect( scene &Scene )
+{
+  INT n = Rays.Size();
+
+  Hits.resize(n);
+  IVRT_STAT_ADD(Bounces, n);
+  for (INT i = 0; i < n; i++)
+    if (!Scene.Intersection(Rays.Get(i), &Hits[i], Rays.RecLevel[i] == 0))
+      Hits[i].Shp = nullptr;
+} /* End of 'ivrt::wavefront::Intersect' function */
+
+/* Add shadow rays of light group function.
+ * ARGUMENTS:
+ *   - scene:
+ *       scene &Scene;
+ *   - shadow group index:
+ *       INT G;
+ *   - number of samples to be added:
+ *       INT N;
+ * RETURNS: None.
+ */
+VOID ivrt::wavefront::PushShadows( scene &Scene, INT G, INT N )
+{
+  shadow_group &Grp = Groups[G];
+  light_info li;
+
+  for (INT i = Grp.Count; i < Grp.Count + N; i++)
+  {
+    if (Grp.Lgt->Samples <= 1)
+      Grp.Lgt->Shadow(Grp.P, &li);
+    else
+      Grp.Lgt->Sample(Grp.P, mth::VanDerCorput(i, Grp.ScrambleU), mth::Sobol2(i, Grp.ScrambleV), &li);
+    Shadows.Push(ray(Grp.P, li.L), G, 1, li.Dist, 0, &Air);
+  }
+  Grp.Count += N;
+} /* End of 'ivrt::wavefront::PushShadows' function */
+
+/* Shade current bounce hits function.
+ * ARGUMENTS:
+ *   - scene to shade:
+ *       scene &Scene;
+ * RETURNS: None.
+ */
+VOID ivrt::wavefront::ShadeHits( scene &Scene )
+{
+  INT n = Rays.Size();
+  trace_task Tasks[2];
+
+  /* Misses go straight to pixels, hits are sorted by shape */
+  Order.clear();
+  for (INT i = 0; i < n; i++)
+    if (Hits[i].Shp != nullptr)
+      Order.push_back(i);
+    else
+      Accum[Rays.Owner[i]] += Scene.Background * Rays.Weight[i];
+  std::sort(Order.begin(), Order.end(),
+    [this]( INT A, INT B )
+    {
+      return Hits[A].Shp < Hits[B].Shp;
+    });
+
+  /* Hits geometry and image textures go first, so procedural colors of
+   * same shape hits (adjacent after sort) are evaluated in batches */
+  HitDiff.resize(n);
+  HitEnter.resize(n);
+  for (INT h : Order)
+  {
+    ray R = Rays.Get(h);
+    intr &I = Hits[h];
+
+    if (!I.IsNorm)
+      I.Shp->GetNormal(&I);
+    if (!I.IsPos)
+      I.P = R(I.T);
+    HitEnter[h] = (I.N & R.Dir) < 0;
+    if (!HitEnter[h])
+      I.N = -I.N;
+    HitDiff[h] = Rays.Diff[h].Transfer(R, I.T, I.N);
+    Scene.Albedo(&I, HitDiff[h], FALSE);
+  }
+  for (size_t b = 0, e; b < Order.size(); b = e)
+  {
+    const shape *Shp = Hits[Order[b]].Shp;
+
+    for (e = b + 1; e < Order.size() && Hits[Order[e]].Shp == Shp; e++)
+      ;
+    if (Shp->mtl.Proc == nullptr)
+      continue;
+    ProcP.clear();
+    ProcWidth.clear();
+    for (size_t i = b; i < e; i++)
+    {
+      ProcP.push_back(Hits[Order[i]].P);
+      ProcWidth.push_back(HitDiff[Order[i]].Footprint());
+    }
+    ProcColor.resize(ProcP.size());
+    Shp->mtl.Proc->Eval((INT)ProcP.size(), ProcP.data(), ProcWidth.data(), ProcColor.data());
+    for (size_t i = b; i < e; i++)
+      Hits[Order[i]].Color = Hits[Order[i]].Color * ProcColor[i - b];
+  }
+
+  Local.resize(n);
+  Groups.clear();
+  Shadows.Clear();
+  NextRays.Clear();
+  for (INT h : Order)
+  {
+    ray R = Rays.Get(h);
+    intr &I = Hits[h];
+
+    IVRT_STAT(ShadeCalls);
+    BOOL IsEnter = HitEnter[h];
+    vec3 Refl = I.N.Reflect(R.Dir);
+
+    Local[h] = I.Shp->mtl.Ka * I.Color;
+    for (auto OneLight : Scene.Lights)
+    {
+      shadow_group Grp;
+      light_info li;
+
+      if (!Scene.LightShade(&I, Refl, OneLight, &li, &Grp.Color))
+        continue;
+      Grp.Hit = h;
+      Grp.Lgt = OneLight;
+      Grp.P = I.P;
+      Grp.ScrambleU = mth::Rng().Next();
+      Grp.ScrambleV = mth::Rng().Next();
+      Grp.Lit = Grp.Count = 0;
+      Groups.push_back(Grp);
+      PushShadows(Scene, (INT)Groups.size() - 1,
+        OneLight->Samples <= 1 ? 1 : mth::Min(mth::Max(Scene.ShadowPilot, 1), OneLight->Samples));
+    }
+
+    INT ns = Scene.Scatter(R, *Rays.Media[h], &I, IsEnter, Rays.Weight[h], Rays.RecLevel[h], Tasks, HitDiff[h]);
+    for (INT i = 0; i < ns; i++)
+      NextRays.Push(Tasks[i].R, Rays.Owner[h], Tasks[i].Weight, HUGE_VAL, Tasks[i].RecLevel, Tasks[i].Media,
+                    Tasks[i].Diff);
+  }
+} /* End of 'ivrt::wavefront::ShadeHits' function */
+
+/* Trace shadow rays and resolve hits colors function.
+ * Pilot samples of every group are traced first, then only groups found
+ * in penumbra get the rest of their light samples budget.
+ * ARGUMENTS:
+ *   - scene:
+ *       scene &Scene;
+ * RETURNS: None.
+ */
+VOID ivrt::wavefront::TraceShadows( scene &Scene )
+{
+  for (INT pass = 0; pass < 2; pass++)
+  {
+    INT n = Shadows.Size();
+
+    for (INT i = 0; i < n; i++)
+    {
+      light_info li(vec3(Shadows.DirX[i], Shadows.DirY[i], Shadows.DirZ[i]), vec3(0), Shadows.Dist[i]);
+
+      if (!Scene.IsShadowed(vec3(Shadows.OrgX[i], Shadows.OrgY[i], Shadows.OrgZ[i]), li))
+        Groups[Shadows.Owner[i]].Lit++;
+    }
+    Shadows.Clear();
+    if (pass == 0)
+      for (INT g = 0; g < (INT)Groups.size(); g++)
+        if (Groups[g].Lit != 0 && Groups[g].Lit != Groups[g].Count && Groups[g].Count < Groups[g].Lgt->Samples)
+          PushShadows(Scene, g, Groups[g].Lgt->Samples - Groups[g].Count);
+  }
+  for (auto &Grp : Groups)
+    Local[Grp.Hit] += Grp.Color * (ShadowCoef + (1 - ShadowCoef) * Grp.Lit / Grp.Count);
+} /* End of 'ivrt::wavefront::TraceShadows' function */
+
+/* Render one tile function.
+ * ARGUMENTS:
+ *   - scene to render:
+ *       scene &Scene;
+ *   - camera:
+ *       camera &Cam;
+ *   - frame to draw to:
+ *       frame &Frame;
+ *   - tile pixels rectangle:
+ *       INT X0, Y0, X1, Y1;
+ * RETURNS: None.
+ */
+VOID ivrt::wavefront::RenderTile( scene &Scene, camera &Cam, frame &Frame, INT X0, INT Y0, INT X1, INT Y1 )
+{
+  IVRT_PROFILE("Tile");
+  INT W = X1 - X0, H = Y1 - Y0;
+
+  /* Random numbers depend on tile position only, not on thread */
+  mth::Rng().Set(mth::Hash(X0, Y0));
+  Accum.assign(W * H, vec3(0));
+  IVRT_STAT_ADD(TraceCalls, W * H);
+  Rays.Clear();
+  ray_gen Gen(Cam);
+
+  /* Differentials are differences with right and lower neighbour rays */
+  Primary.resize(W + 1);
+  PrimaryNext.resize(W + 1);
+  Gen.Row(Y0, X0, X1 + 1, Primary.data());
+  for (INT y = Y0; y < Y1; y++)
+  {
+    Gen.Row(y + 1, X0, X1 + 1, PrimaryNext.data());
+    for (INT x = X0; x < X1; x++)
+    {
+      const ray &R = Primary[x - X0], &Rx = Primary[x - X0 + 1], &Ry = PrimaryNext[x - X0];
+
+      Rays.Push(R, (y - Y0) * W + x - X0, 1, HUGE_VAL, 0, &Air,
+                ray_diff(Rx.Org - R.Org, Ry.Org - R.Org, Rx.Dir - R.Dir, Ry.Dir - R.Dir));
+    }
+    std::swap(Primary, PrimaryNext);
+  }
+
+  while (Rays.Size() > 0)
+  {
+    Intersect(Scene);
+    ShadeHits(Scene);
+    TraceShadows(Scene);
+    for (INT h : Order)
+      Accum[Rays.Owner[h]] += mth::vec3<DBL>::ClampV(Local[h] * Rays.Weight[h]);
+    std::swap(Rays, NextRays);
+  }
+
+  IVRT_PROFILE("Tone map");
+  for (INT y = Y0; y < Y1; y++)
+    for (INT x = X0; x < X1; x++)
+      Frame.PutPixel(x, y, frame::ToRGB(Accum[(y - Y0) * W + x - X0]));
+} /* End of 'ivrt::wavefront::RenderTile' function */
+
+/* Render frame part function.
+ * ARGUMENTS:
+ *   - scene to render:
+ *       scene &Scene;
+ *   - camera:
+ *       camera &Cam;
+ *   - frame to draw to:
+ *       frame &Frame;
+ *   - pixels rectangle:
+ *       INT X0, Y0, X1, Y1;
+ * RETURNS: None.
+ */
+VOID ivrt::wavefront::Render( scene &Scene, camera &Cam, frame &Frame, INT X0, INT Y0, INT X1, INT Y1 )
+{
+  for (INT y = Y0; y < Y1; y += TileSize)
+    for (INT x = X0; x < X1; x += TileSize)
+      RenderTile(Scene, Cam, Frame, x, y, mth::Min(x + TileSize, X1), mth::Min(y + TileSize, Y1));
+} /* End of 'ivrt::wavefront::Render' function */
+
+/* END OF 'wavefront.cpp' FILE */
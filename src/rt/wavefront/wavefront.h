@@ -0,0 +1,215 @@
+/*************************************************************
+ * Copyright (C) 2021
+ *    Computer Graphics Support Group of 30 Phys-Math Lyceum
+ *************************************************************/
+
+/* FILE NAME   : wavefront.h
+ * PURPOSE     : Raytracing project.
+ *               Wavefront (breadth-first) renderer declaration module.
+ * PROGRAMMER  : CGSG-SummerCamp'2021.
+ *               Ivan Dmitriev
+ * LAST UPDATE : 06.08.2021
+ * NOTE        : Module namespace 'ivrt'.
+ *
+ * No part of this file may be changed without agreement of
+ * Computer Graphics Support Group of 30 Phys-Math Lyceum
+ */
+
+#ifndef __wavefront_h_
+#define __wavefront_h_
+
+#include "../rt_def.h"
+#include "../frame/frame.h"
+
+/* Project namespace */
+namespace ivrt
+{
+  /* Structure of arrays rays queue class */
+  class ray_queue
+  {
+  public:
+    std::vector<DBL>
+      OrgX, OrgY, OrgZ, // rays origins
+      DirX, DirY, DirZ, // rays directions
+      Weight,           // rays weights
+      Dist;             // rays maximal distances
+    std::vector<INT>
+      Owner,            // tile pixel (or shadow group) index
+      RecLevel;         // rays tree depth
+    std::vector<const envi *> Media; // rays environments
+    std::vector<ray_diff> Diff;      // rays differentials
+
+    /* Obtain queue size function.
+     * ARGUMENTS: None.
+     * RETURNS: (INT) number of rays in queue.
+     */
+    INT Size( VOID ) const
+    {
+      return (INT)Owner.size();
+    } /* End of 'Size' function */
+
+    /* Clear queue function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    VOID Clear( VOID )
+    {
+      OrgX.clear(), OrgY.clear(), OrgZ.clear();
+      DirX.clear(), DirY.clear(), DirZ.clear();
+      Weight.clear(), Dist.clear(), Owner.clear(), RecLevel.clear(), Media.clear(), Diff.clear();
+    } /* End of 'Clear' function */
+
+    /* Add ray to queue function.
+     * ARGUMENTS:
+     *   - ray to be added:
+     *       const ray &R;
+     *   - owner index:
+     *       INT NOwner;
+     *   - ray weight and maximal distance:
+     *       DBL NWeight, NDist;
+     *   - ray tree depth:
+     *       INT NRecLevel;
+     *   - ray environment:
+     *       const envi *NMedia;
+     *   - ray differentials:
+     *       const ray_diff &NDiff;
+     * RETURNS: None.
+     */
+    VOID Push( const ray &R, INT NOwner, DBL NWeight, DBL NDist, INT NRecLevel, const envi *NMedia,
+               const ray_diff &NDiff = ray_diff() )
+    {
+      OrgX.push_back(R.Org[0]), OrgY.push_back(R.Org[1]), OrgZ.push_back(R.Org[2]);
+      DirX.push_back(R.Dir[0]), DirY.push_back(R.Dir[1]), DirZ.push_back(R.Dir[2]);
+      Weight.push_back(NWeight);
+      Dist.push_back(NDist);
+      Owner.push_back(NOwner);
+      RecLevel.push_back(NRecLevel);
+      Media.push_back(NMedia);
+      Diff.push_back(NDiff);
+    } /* End of 'Push' function */
+
+    /* Obtain ray from queue function.
+     * ARGUMENTS:
+     *   - ray index:
+     *       INT i;
+     * RETURNS: (ray) result ray.
+     */
+    ray Get( INT i ) const
+    {
+      ray R;
+
+      R.Org = vec3(OrgX[i], OrgY[i], OrgZ[i]);
+      R.Dir = vec3(DirX[i], DirY[i], DirZ[i]);
+      return R;
+    } /* End of 'Get' function */
+  }; /* End of 'ray_queue' class */
+
+  /* Wavefront renderer class.
+   * All rays of one tile bounce are intersected in bulk, hits are sorted by
+   * shape (so by material), shaded in batches and produce next bounce and
+   * shadow rays queues. Result is the same as depth-first 'scene::Trace'. */
+  class wavefront
+  {
+  private:
+    /* Shadow rays group (all samples of one light for one hit) */
+    struct shadow_group
+    {
+      INT Hit;                     // hit index in current queue
+      light *Lgt;                  // light source
+      vec3 P, Color;               // shaded point and unoccluded light color
+      UINT ScrambleU, ScrambleV;   // light samples scramble bits
+      INT Lit, Count;              // unoccluded and traced samples number
+    }; /* End of 'shadow_group' structure */
+
+    ray_queue
+      Rays,                        // current bounce rays
+      NextRays,                    // next bounce rays
+      Shadows;                     // shadow rays
+    std::vector<intr> Hits;        // current bounce intersections
+    std::vector<INT> Order;        // hits order sorted by shape
+    std::vector<ray_diff> HitDiff; // hits differentials
+    std::vector<BOOL> HitEnter;    // hits rays enter their shapes flags
+    std::vector<vec3>
+      ProcP,                       // procedural texture batch points
+      ProcColor;                   // procedural texture batch colors
+    std::vector<DBL> ProcWidth;    // procedural texture batch footprints
+    std::vector<vec3>
+      Local,                       // hits colors (not weighted)
+      Accum;                       // tile pixels colors
+    std::vector<shadow_group> Groups; // current bounce shadow groups
+    std::vector<ray>
+      Primary,                     // tile row primary rays (one past row end too)
+      PrimaryNext;                 // next tile row primary rays (for differentials)
+
+    /* Intersect current bounce rays function.
+     * ARGUMENTS:
+     *   - scene to intersect:
+     *       scene &Scene;
+     * RETURNS: None.
+     */
+    VOID Intersect( scene &Scene );
+
+    /* Shade current bounce hits function.
+     * ARGUMENTS:
+     *   - scene to shade:
+     *       scene &Scene;
+     * RETURNS: None.
+     */
+    VOID ShadeHits( scene &Scene );
+
+    /* Add shadow rays of light group function.
+     * ARGUMENTS:
+     *   - scene:
+     *       scene &Scene;
+     *   - shadow group index:
+     *       INT G;
+     *   - number of samples to be added:
+     *       INT N;
+     * RETURNS: None.
+     */
+    VOID PushShadows( scene &Scene, INT G, INT N );
+
+    /* Trace shadow rays and resolve hits colors function.
+     * ARGUMENTS:
+     *   - scene:
+     *       scene &Scene;
+     * RETURNS: None.
+     */
+    VOID TraceShadows( scene &Scene );
+
+    /* Render one tile function.
+     * ARGUMENTS:
+     *   - scene to render:
+     *       scene &Scene;
+     *   - camera:
+     *       camera &Cam;
+     *   - frame to draw to:
+     *       frame &Frame;
+     *   - tile pixels rectangle:
+     *       INT X0, Y0, X1, Y1;
+     * RETURNS: None.
+     */
+    VOID RenderTile( scene &Scene, camera &Cam, frame &Frame, INT X0, INT Y0, INT X1, INT Y1 );
+
+  public:
+    INT TileSize = 64; // tile side size in pixels
+
+    /* Render frame part function.
+     * ARGUMENTS:
+     *   - scene to render:
+     *       scene &Scene;
+     *   - camera:
+     *       camera &Cam;
+     *   - frame to draw to:
+     *       frame &Frame;
+     *   - pixels rectangle:
+     *       INT X0, Y0, X1, Y1;
+     * RETURNS: None.
+     */
+    VOID Render( scene &Scene, camera &Cam, frame &Frame, INT X0, INT Y0, INT X1, INT Y1 );
+  }; /* End of 'wavefront' class */
+} /* end of 'ivrt' namespace */
+
+#endif /* __wavefront_h_ */
+
+/* END OF 'wavefront.h' FILE */
@@ -8,7 +8,9 @@
  *               Timer handle module.
  * PROGRAMMER  : CGSG-SummerCamp'2021.
  *               ID3
- * LAST UPDATE : 04.08.2021
+ * LAST UPDATE : 08.08.2021
+ * NOTE        : Module namespace 'ivrt'.
+ *
  * No part of this file may be changed without agreement of
  * Computer Graphics Support Group of 30 Phys-Math Lyceum
  */
@@ -16,34 +18,140 @@
 #ifndef __timer_h_
 #define __timer_h_
 
-#include <commondf.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
 
-#include "def.h"
+/* Timer needs only standard headers: project base types are declared
+ * here the same way as in Windows headers instead of including 'def.h' */
+#ifndef VOID
+#  define VOID void
+#endif /* VOID */
+#ifndef FALSE
+#  define FALSE 0
+#endif /* FALSE */
+typedef int INT;
+typedef int BOOL;
+typedef char CHAR;
+typedef double DBL;
+typedef std::uint64_t UINT64;
 
-namespace ivrt 
+namespace ivrt
 {
+  /* Rolling window of time samples class */
+  class time_samples
+  {
+  private:
+    std::vector<DBL> Samples; // ring buffer of samples
+    INT Next = 0;             // next sample position
+    DBL Sum = 0;              // samples sum
+
+  public:
+    static const INT Window = 256; // number of kept samples
+
+    /* Add sample function.
+     * ARGUMENTS:
+     *   - time in seconds:
+     *       DBL T;
+     * RETURNS: None.
+     */
+    VOID Add( DBL T )
+    {
+      if (Samples.size() < Window)
+        Samples.push_back(T);
+      else
+      {
+        Sum -= Samples[Next];
+        Samples[Next] = T;
+      }
+      Sum += T;
+      Next = (Next + 1) % Window;
+    } /* End of 'Add' function */
+
+    /* Get number of samples function.
+     * ARGUMENTS: None.
+     * RETURNS: (INT) number of kept samples.
+     */
+    INT Count( VOID ) const
+    {
+      return (INT)Samples.size();
+    } /* End of 'Count' function */
+
+    /* Get average function.
+     * ARGUMENTS: None.
+     * RETURNS: (DBL) average of kept samples (0 if none).
+     */
+    DBL Average( VOID ) const
+    {
+      return Samples.empty() ? 0 : Sum / Samples.size();
+    } /* End of 'Average' function */
+
+    /* Get percentile function.
+     * ARGUMENTS:
+     *   - percentile in [0, 100]:
+     *       DBL P;
+     * RETURNS: (DBL) nearest rank percentile of kept samples (0 if none).
+     */
+    DBL Percentile( DBL P ) const
+    {
+      if (Samples.empty())
+        return 0;
+
+      std::vector<DBL> s = Samples;
+      INT k = std::min((INT)s.size() - 1, std::max(0, (INT)std::ceil(P / 100 * s.size()) - 1));
+
+      std::nth_element(s.begin(), s.begin() + k, s.end());
+      return s[k];
+    } /* End of 'Percentile' function */
+  }; /* End of 'time_samples' class */
+
+  /* Portable timer class.
+   * Based on 'std::chrono::steady_clock' (monotonic, QueryPerformanceCounter
+   * or clock_gettime(CLOCK_MONOTONIC) underneath). Besides global and frame
+   * times it keeps rolling frame and named phases durations windows. */
   class timer
   {
   private:
-    UINT64 StartTime,           /* Start program time */
-                  OldTime,      /* Previous frame time */
-                  OldTimeFPS,   /* Old time FPS measurement */
-                  PauseTime,    /* Time during pause period */
-                  TimePerSec,   /* Timer resolution */
-                  FrameCounter; /* Frames counter */
+    typedef std::chrono::steady_clock clock;
+
+    clock::time_point
+      StartTime,                   /* Start program time */
+      OldTime,                     /* Previous frame time */
+      OldTimeFPS;                  /* Old time FPS measurement */
+    clock::duration PauseTime;     /* Time during pause period */
+    UINT64 FrameCounter;           /* Frames counter */
+
+    /* Convert duration to seconds function.
+     * ARGUMENTS:
+     *   - duration:
+     *       clock::duration D;
+     * RETURNS: (DBL) seconds.
+     */
+    static DBL Seconds( clock::duration D )
+    {
+      return std::chrono::duration<DBL>(D).count();
+    } /* End of 'Seconds' function */
+
   public:
     DBL
       GlobalTime, GlobalDeltaTime, /* Global time and interframe interval */
       Time, DeltaTime,             /* Time with pause and interframe interval */
       FPS;                         /* Frame per second */
     BOOL IsPause;                  /* Pause flag */
+    time_samples Frames;           /* Interframe intervals window */
+    std::map<std::string, time_samples> Phases; /* Named phases durations windows */
+
   public:
     timer( VOID )
     {
       TimerInit();
     }
-    //VOID Timer( VOID );
-   
+
     /* Get FPS function.
      * ARGUMENTS: None.
      * RETURNS: (DBL) Result number.
@@ -53,60 +161,100 @@ namespace ivrt
       return FPS;
     } /* End of 'GetFPS' function */
 
+    /* Get time from timer start function.
+     * ARGUMENTS: None.
+     * RETURNS: (DBL) current time in seconds.
+     */
+    DBL Now( VOID ) const
+    {
+      return Seconds(clock::now() - StartTime);
+    } /* End of 'Now' function */
+
     /* Initialization timer function.
      * ARGUMENTS: None.
      * RETURNS: None.
      */
     VOID TimerInit( VOID )
     {
-      LARGE_INTEGER t;
-
-      QueryPerformanceFrequency(&t);
-      TimePerSec = t.QuadPart;
-      QueryPerformanceCounter(&t);
-      StartTime = OldTime = OldTimeFPS = t.QuadPart;
+      StartTime = OldTime = OldTimeFPS = clock::now();
       FrameCounter = 0;
       IsPause = FALSE;
       FPS = 30.0;
-      PauseTime = 0;
+      PauseTime = clock::duration::zero();
+      GlobalTime = GlobalDeltaTime = Time = DeltaTime = 0;
     } /* End of 'Init' function */
 
-    /* Timer response function.
+    /* Timer response function (called once per frame).
      * ARGUMENTS: None.
      * RETURNS: None.
      */
     VOID Response( VOID )
     {
-      LARGE_INTEGER t;
+      clock::time_point t = clock::now();
 
-      QueryPerformanceCounter(&t);
       /* Global time */
-      GlobalTime = (DBL)(t.QuadPart - StartTime) / TimePerSec;
-      GlobalDeltaTime = (DBL)(t.QuadPart - OldTime) / TimePerSec;
+      GlobalTime = Seconds(t - StartTime);
+      GlobalDeltaTime = Seconds(t - OldTime);
+      Frames.Add(GlobalDeltaTime);
       /* Time with pause */
       if (IsPause)
       {
         DeltaTime = 0;
-        PauseTime += t.QuadPart - OldTime;
+        PauseTime += t - OldTime;
       }
       else
       {
         DeltaTime = GlobalDeltaTime;
-        Time = (DBL)(t.QuadPart - PauseTime - StartTime) / TimePerSec;
+        Time = Seconds(t - PauseTime - StartTime);
       }
       /* FPS */
       FrameCounter++;
-      if (t.QuadPart - OldTimeFPS > TimePerSec)
+      if (t - OldTimeFPS > std::chrono::seconds(1))
       {
-        FPS = FrameCounter * TimePerSec / (DBL)(t.QuadPart - OldTimeFPS);
-        OldTimeFPS = t.QuadPart;
+        FPS = FrameCounter / Seconds(t - OldTimeFPS);
+        OldTimeFPS = t;
         FrameCounter = 0;
       }
-      OldTime = t.QuadPart;
+      OldTime = t;
     } /* End of 'Response' function */
+
+    /* Add phase duration function.
+     * ARGUMENTS:
+     *   - phase name:
+     *       const std::string &Name;
+     *   - duration in seconds:
+     *       DBL T;
+     * RETURNS: None.
+     */
+    VOID Phase( const std::string &Name, DBL T )
+    {
+      Phases[Name].Add(T);
+    } /* End of 'Phase' function */
+
+    /* Write frame time distribution function.
+     * ARGUMENTS:
+     *   - output stream:
+     *       FILE *F;
+     * RETURNS: None.
+     */
+    VOID Report( FILE *F ) const
+    {
+      auto line =
+        [F]( const CHAR *Name, const time_samples &S )
+        {
+          fprintf(F, "%-16s %6d %10.3f %10.3f %10.3f %10.3f\n", Name, S.Count(),
+                  S.Average() * 1000, S.Percentile(50) * 1000, S.Percentile(95) * 1000, S.Percentile(99) * 1000);
+        };
+
+      fprintf(F, "# FPS %.2f, times in ms over last %d samples\n", FPS, time_samples::Window);
+      fprintf(F, "%-16s %6s %10s %10s %10s %10s\n", "phase", "count", "avg", "p50", "p95", "p99");
+      line("frame", Frames);
+      for (auto &P : Phases)
+        line(P.first.c_str(), P.second);
+    } /* End of 'Report' function */
   }; /* End of 'timer' class */
 } /* end of 'ivrt' namespace */
 
 #endif /* __timer_h_ */
 
-/* END OF 'timer.h' FILE */
\ No newline at end of file
+/* END OF 'timer.h' FILE */